@@ -0,0 +1,158 @@
+#pragma once
+
+//  The geometry as it was before Vector3, Box and Ray moved onto float4
+//  lanes (from the first commit of the game), for the "before" side of
+//  the primitive benchmarks: three packed floats, Box::overlap copying
+//  its argument and corners, the scalar Williams et al. ray-box test and
+//  subDivideBox8 stepping each octant off the one before
+//
+#include <math.h>
+#include <vector>
+
+namespace before {
+
+class Vector3 {
+  public:
+    Vector3() { };
+    Vector3(float x, float y, float z) { d[0] = x; d[1] = y; d[2] = z; }
+    Vector3(const Vector3 &v)
+      { d[0] = v.d[0]; d[1] = v.d[1]; d[2] = v.d[2]; }
+    Vector3 & operator=(const Vector3 &v) = default;
+
+    float x() const { return d[0]; }
+    float y() const { return d[1]; }
+    float z() const { return d[2]; }
+
+    Vector3 operator+(const Vector3 &op2) const {
+      return Vector3(d[0] + op2.d[0], d[1] + op2.d[1], d[2] + op2.d[2]);
+    }
+    Vector3 operator-(const Vector3 &op2) const {
+      return Vector3(d[0] - op2.d[0], d[1] - op2.d[1], d[2] - op2.d[2]);
+    }
+    Vector3 operator/(float s) const {
+      return Vector3(d[0] / s, d[1] / s, d[2] / s);
+    }
+
+  private:
+    float d[3];
+};
+
+class Ray {
+  public:
+    Ray() { }
+    Ray(Vector3 o, Vector3 d) {
+      origin = o;
+      direction = d;
+      inv_direction = Vector3(1/d.x(), 1/d.y(), 1/d.z());
+      sign[0] = (inv_direction.x() < 0);
+      sign[1] = (inv_direction.y() < 0);
+      sign[2] = (inv_direction.z() < 0);
+    }
+
+    Vector3 origin;
+    Vector3 direction;
+    Vector3 inv_direction;
+    int sign[3];
+};
+
+class Box {
+public:
+	Box() { }
+	Box(const Vector3 &min, const Vector3 &max) {
+		parameters[0] = min;
+		parameters[1] = max;
+	}
+
+	Vector3 parameters[2];
+
+	Vector3 min() { return parameters[0]; }
+	Vector3 max() { return parameters[1]; }
+	const bool inside(const Vector3 &p) {
+		return ((p.x() >= parameters[0].x() && p.x() <= parameters[1].x()) &&
+			(p.y() >= parameters[0].y() && p.y() <= parameters[1].y()) &&
+			(p.z() >= parameters[0].z() && p.z() <= parameters[1].z()));
+	}
+
+	bool overlap(const Box &box) {
+		Box box2 = box;
+		Vector3 box1min = Vector3(min());
+		Vector3 box1max = Vector3(max());
+		Vector3 box2min = Vector3(box2.min());
+		Vector3 box2max = Vector3(box2.max());
+		if ((box1min.x() <= box2max.x() && box1max.x() >= box2min.x()) &&
+			(box1min.y() <= box2max.y() && box1max.y() >= box2min.y()) &&
+			(box1min.z() <= box2max.z() && box1max.z() >= box2min.z()))
+			return true;
+		return false;
+	}
+
+	bool intersect(const Ray &r, float t0, float t1) const {
+		float tmin, tmax, tymin, tymax, tzmin, tzmax;
+
+		tmin = (parameters[r.sign[0]].x() - r.origin.x()) * r.inv_direction.x();
+		tmax = (parameters[1 - r.sign[0]].x() - r.origin.x()) * r.inv_direction.x();
+		tymin = (parameters[r.sign[1]].y() - r.origin.y()) * r.inv_direction.y();
+		tymax = (parameters[1 - r.sign[1]].y() - r.origin.y()) * r.inv_direction.y();
+		if ((tmin > tymax) || (tymin > tmax))
+			return false;
+		if (tymin > tmin)
+			tmin = tymin;
+		if (tymax < tmax)
+			tmax = tymax;
+		tzmin = (parameters[r.sign[2]].z() - r.origin.z()) * r.inv_direction.z();
+		tzmax = (parameters[1 - r.sign[2]].z() - r.origin.z()) * r.inv_direction.z();
+		if ((tmin > tzmax) || (tzmin > tmax))
+			return false;
+		if (tzmin > tmin)
+			tmin = tzmin;
+		if (tzmax < tmax)
+			tmax = tzmax;
+		return ((tmin < t1) && (tmax > t0));
+	}
+};
+
+// Octree::meshBounds as it was, a vertex at a time through a copy
+//
+inline Box meshBounds(const float *verts, int n) {
+	Vector3 v(verts[0], verts[1], verts[2]);
+	float min[3] = { v.x(), v.y(), v.z() }, max[3] = { v.x(), v.y(), v.z() };
+	for (int i = 1; i < n; i++) {
+		Vector3 v(verts[3 * i], verts[3 * i + 1], verts[3 * i + 2]);
+		if (v.x() > max[0]) max[0] = v.x();
+		else if (v.x() < min[0]) min[0] = v.x();
+		if (v.y() > max[1]) max[1] = v.y();
+		else if (v.y() < min[1]) min[1] = v.y();
+		if (v.z() > max[2]) max[2] = v.z();
+		else if (v.z() < min[2]) min[2] = v.z();
+	}
+	return Box(Vector3(min[0], min[1], min[2]), Vector3(max[0], max[1], max[2]));
+}
+
+// Octree::subDivideBox8 as it was
+//
+inline void subDivideBox8(const Box &box, std::vector<Box> & boxList) {
+	Vector3 min = box.parameters[0];
+	Vector3 max = box.parameters[1];
+	Vector3 size = max - min;
+	Vector3 center = size / 2 + min;
+	float xdist = (max.x() - min.x()) / 2;
+	float ydist = (max.y() - min.y()) / 2;
+	float zdist = (max.z() - min.z()) / 2;
+	Vector3 h = Vector3(0, ydist, 0);
+
+	Box b[8];
+	b[0] = Box(min, center);
+	b[1] = Box(b[0].min() + Vector3(xdist, 0, 0), b[0].max() + Vector3(xdist, 0, 0));
+	b[2] = Box(b[1].min() + Vector3(0, 0, zdist), b[1].max() + Vector3(0, 0, zdist));
+	b[3] = Box(b[2].min() + Vector3(-xdist, 0, 0), b[2].max() + Vector3(-xdist, 0, 0));
+
+	boxList.clear();
+	for (int i = 0; i < 4; i++)
+		boxList.push_back(b[i]);
+	for (int i = 4; i < 8; i++) {
+		b[i] = Box(b[i - 4].min() + h, b[i - 4].max() + h);
+		boxList.push_back(b[i]);
+	}
+}
+
+}
@@ -0,0 +1,427 @@
+
+#include "CoreBenchmarks.h"
+#include "Before.h"
+#include "box.h"
+#include "HeightField.h"
+#include "LandingMap.h"
+#include "Octree.h"
+#include "ParticleSystem.h"
+#include "SyntheticTerrain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <thread>
+#include <random>
+
+// keeps results the compiler could otherwise prove unused
+//
+static volatile int sink;
+
+// a synthetic terrain 500 units on a side, quads x quads squares
+//
+static ofMesh terrainMesh(int quads) {
+	SyntheticTerrain terrain;
+	terrain.res = quads + 1;
+	terrain.size = 500;
+	terrain.height = 20;
+	ofMesh mesh;
+	terrain.create(mesh);
+	return mesh;
+}
+
+static std::string meshName(int quads) {
+	return "synthetic_" + std::to_string(quads);
+}
+
+void CoreBenchmarks::run() {
+	results.clear();
+	runPrimitives();
+	runOctants();
+	for (int quads : gridSizes)
+		runVertexArrays(quads);
+	for (int quads : terrainSizes)
+		runOctree(quads);
+	runLayouts(terrainSizes.back());
+	runBuilds(buildQuads);
+	runLandingMaps(terrainSizes.back());
+	for (int count : particleCounts)
+		runParticles(count);
+}
+
+// Box overlap and ray-box against random lander sized boxes and
+// downward rays over a 500 unit terrain, as the octree queries see them
+//
+void CoreBenchmarks::runPrimitives() {
+	const int numQueries = 1024;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> pos(0, 500), size(1, 10), tilt(-.5, .5);
+	std::vector<Box> boxes(numQueries);
+	std::vector<Ray> rays(numQueries);
+	std::vector<before::Box> oldBoxes(numQueries);
+	std::vector<before::Ray> oldRays(numQueries);
+	for (int i = 0; i < numQueries; i++) {
+		float x = pos(rng), y = pos(rng) / 10, z = pos(rng);
+		float w = size(rng), h = size(rng), d = size(rng);
+		float dx = tilt(rng), dz = tilt(rng);
+		boxes[i] = Box(Vector3(x, y, z), Vector3(x + w, y + h, z + d));
+		rays[i] = Ray(Vector3(x, 51, z), Vector3(dx, -1, dz));
+		oldBoxes[i] = before::Box(before::Vector3(x, y, z), before::Vector3(x + w, y + h, z + d));
+		oldRays[i] = before::Ray(before::Vector3(x, 51, z), before::Vector3(dx, -1, dz));
+	}
+
+	const int mask = numQueries - 1;
+	time("Box::overlap/before", 1, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += oldBoxes[i & mask].overlap(oldBoxes[(i * 7) & mask]);
+		sink = hits;
+	});
+	time("Box::overlap/after", 1, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += boxes[i & mask].overlap(boxes[(i * 7) & mask]);
+		sink = hits;
+	});
+	time("Box::intersect/before", 1, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += oldBoxes[i & mask].intersect(oldRays[(i * 7) & mask], 0, 1000);
+		sink = hits;
+	});
+	time("Box::intersect/after", 1, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += boxes[i & mask].intersect(rays[(i * 7) & mask], 0, 1000);
+		sink = hits;
+	});
+}
+
+// Splitting a node's box into its eight octants, as the octree builders
+// do at every node, over boxes of a few sizes and offsets
+//
+void CoreBenchmarks::runOctants() {
+	const int numBoxes = 64;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> pos(-500, 500), size(1, 500);
+	std::vector<Box> boxes(numBoxes);
+	std::vector<before::Box> oldBoxes(numBoxes);
+	for (int i = 0; i < numBoxes; i++) {
+		float x = pos(rng), y = pos(rng), z = pos(rng);
+		float w = size(rng), h = size(rng), d = size(rng);
+		boxes[i] = Box(Vector3(x, y, z), Vector3(x + w, y + h, z + d));
+		oldBoxes[i] = before::Box(before::Vector3(x, y, z), before::Vector3(x + w, y + h, z + d));
+	}
+
+	std::vector<before::Box> oldList;
+	time("Octree::subDivideBox8/before", 8, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++)
+			before::subDivideBox8(oldBoxes[i & (numBoxes - 1)], oldList);
+		sink = oldList.size();
+	});
+	std::vector<Box> boxList;
+	time("Octree::subDivideBox8/after", 8, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++) {
+			const Box & box = boxes[i & (numBoxes - 1)];
+			boxList.clear();
+			for (int o = 0; o < 8; o++)
+				boxList.push_back(box.octant(o));
+		}
+		sink = boxList.size();
+	});
+}
+
+// Point in box and bounds over the packed vertex array of a synthetic
+// terrain grid, quads on a side, as getMeshPointsInBox and meshBounds
+// read a mesh
+//
+void CoreBenchmarks::runVertexArrays(int quads) {
+	int side = quads + 1;
+	int n = side * side;
+	std::vector<float> verts(3 * n);
+	for (int k = 0; k < side; k++) {
+		for (int i = 0; i < side; i++) {
+			float *v = &verts[3 * (k * side + i)];
+			v[0] = i * 500.0f / quads;
+			v[2] = k * 500.0f / quads;
+			v[1] = 10 * sinf(v[0] * .05f) * cosf(v[2] * .03f);
+		}
+	}
+	std::string suffix = "/" + std::to_string(n);
+
+	// the first octant of the terrain, as the first level of create()
+	//
+	before::Box oldBox(before::Vector3(0, -10, 0), before::Vector3(250, 0, 250));
+	Box box(Vector3(0, -10, 0), Vector3(250, 0, 250));
+	time("Box::inside/before" + suffix, n, [&](int64_t iters) {
+		int count = 0;
+		for (int64_t it = 0; it < iters; it++)
+			for (int i = 0; i < n; i++)
+				count += oldBox.inside(before::Vector3(verts[3 * i], verts[3 * i + 1], verts[3 * i + 2]));
+		sink = count;
+	});
+	Vector3View view(verts.data(), n);
+	time("Box::inside/after" + suffix, n, [&](int64_t iters) {
+		int count = 0;
+		for (int64_t it = 0; it < iters; it++)
+			for (int i = 0; i < n; i++)
+				count += box.inside(view.point(i));
+		sink = count;
+	});
+
+	time("meshBounds/before" + suffix, n, [&](int64_t iters) {
+		for (int64_t it = 0; it < iters; it++)
+			sink = before::meshBounds(verts.data(), n).parameters[1].y() > 0;
+	});
+	time("meshBounds/after" + suffix, n, [&](int64_t iters) {
+		for (int64_t it = 0; it < iters; it++)
+			sink = Box::bounds(view).max().y() > 0;
+	});
+}
+
+// random lander sized boxes and downward rays over the given bounds
+//
+static void randomQueries(std::mt19937 & rng, const Box & bounds, std::vector<Box> & boxes, std::vector<Ray> & rays) {
+	std::uniform_real_distribution<float> unit(0, 1), size(1, 10), tilt(-.5, .5);
+	Vector3 extent = bounds.max() - bounds.min();
+	for (int i = 0; i < boxes.size(); i++) {
+		Vector3 p = bounds.min() + Vector3(unit(rng) * extent.x(), unit(rng) * extent.y(), unit(rng) * extent.z());
+		boxes[i] = Box(p, p + Vector3(size(rng), size(rng), size(rng)));
+		rays[i] = Ray(Vector3(p.x(), bounds.max().y() + 1, p.z()), Vector3(tilt(rng), -1, tilt(rng)));
+	}
+}
+
+// Bounds of the terrain mesh, building the octree over it and the ray
+// and box queries the lander's collisions make against it
+//
+void CoreBenchmarks::runOctree(int quads) {
+	ofMesh mesh = terrainMesh(quads);
+	int numVertices = mesh.getNumVertices();
+	std::string suffix = "/" + meshName(quads);
+
+	time("meshBounds" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++)
+			sink = Octree::meshBounds(mesh).max().y() > 0;
+	});
+
+	// includes copying the mesh into the tree, as create() does
+	//
+	Octree octree;
+	time("Octree::create" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++) {
+			octree = Octree();
+			octree.create(mesh, octreeLevels);
+		}
+	});
+	int lost, duplicated;
+	if (!octree.checkPoints(lost, duplicated))
+		printf("Octree::create%s: %d vertices lost, %d duplicated\n", suffix.c_str(), lost, duplicated);
+
+	const int numQueries = 1024;
+	std::mt19937 rng(42);
+	std::vector<Box> boxes(numQueries), boxList;
+	std::vector<Ray> rays(numQueries);
+	randomQueries(rng, octree.root.box, boxes, rays);
+
+	time("Octree::intersect(Ray)" + suffix, numVertices, [&](int64_t n) {
+		TreeNode node;
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += octree.intersect(rays[i & (numQueries - 1)], octree.root, node);
+		sink = hits;
+	});
+	time("Octree::intersect(Box)" + suffix, numVertices, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++) {
+			boxList.clear();
+			hits += octree.intersect(boxes[i & (numQueries - 1)], octree.root, boxList);
+		}
+		sink = hits;
+	});
+}
+
+// Node memory and query speed of the TreeNode tree against the
+// compacted nodes, for trees of each of layoutLevels levels
+//
+void CoreBenchmarks::runLayouts(int quads) {
+	ofMesh mesh = terrainMesh(quads);
+	int numVertices = mesh.getNumVertices();
+	for (int levels : layoutLevels) {
+		Octree octree;
+		octree.create(mesh, levels);
+
+		const int numQueries = 1024;
+		std::mt19937 rng(42);
+		std::vector<Box> boxes(numQueries), boxList;
+		std::vector<Ray> rays(numQueries);
+		randomQueries(rng, octree.root.box, boxes, rays);
+
+		for (std::string layout : { "tree", "compact" }) {
+			if (layout == "compact") octree.compact();
+			std::string suffix = "/" + layout + "_" + std::to_string(levels) + "/" + meshName(quads);
+			size_t bytes = octree.nodeBytes();
+			time("Octree::intersect(Ray)" + suffix, numVertices, [&](int64_t n) {
+				int point, hits = 0;
+				for (int64_t i = 0; i < n; i++)
+					hits += octree.intersect(rays[i & (numQueries - 1)], point);
+				sink = hits;
+			});
+			results.back().bytes = bytes;
+			time("Octree::intersect(Box)" + suffix, numVertices, [&](int64_t n) {
+				int hits = 0;
+				for (int64_t i = 0; i < n; i++) {
+					boxList.clear();
+					hits += octree.intersect(boxes[i & (numQueries - 1)], boxList);
+				}
+				sink = hits;
+			});
+			results.back().bytes = bytes;
+		}
+	}
+}
+
+// Top down build against the Z-order build, and a scan of one node's
+// points in the resulting vertex order: the Z-order build sorts the
+// vertices so the scan reads them in sequence
+//
+void CoreBenchmarks::runBuilds(int quads) {
+	ofMesh mesh = terrainMesh(quads);
+	int numVertices = mesh.getNumVertices();
+	std::string suffix = "/" + meshName(quads);
+	for (std::string build : { "create", "createMorton" }) {
+		Octree octree;
+		time("Octree::" + build + suffix, numVertices, [&](int64_t n) {
+			for (int64_t i = 0; i < n; i++) {
+				octree = Octree();
+				if (build == "create") octree.create(mesh, buildLevels);
+				else octree.createMorton(mesh, buildLevels);
+			}
+		});
+		int lost, duplicated;
+		if (!octree.checkPoints(lost, duplicated))
+			printf("Octree::%s%s: %d vertices lost, %d duplicated\n", build.c_str(), suffix.c_str(), lost, duplicated);
+
+		// a node a few levels down, about 1/64 of the terrain
+		//
+		const TreeNode *node = &octree.root;
+		for (int level = 0; level < 3 && !node->children.empty(); level++)
+			node = &node->children[0];
+		Box octant = Octree::octantBox(node->box, 0);
+		std::vector<int> pointsRtn;
+		time("Octree::getMeshPointsInBox/" + build + suffix, node->points.size(), [&](int64_t n) {
+			for (int64_t i = 0; i < n; i++) {
+				pointsRtn.clear();
+				octree.getMeshPointsInBox(octree.mesh, node->points, octant, pointsRtn);
+			}
+			sink = pointsRtn.size();
+		});
+	}
+}
+
+// LandingMap::create at each grid size, on one thread and on every
+// core.  Cells per map go up with the square of the size while the
+// points per cell go down, so the time is mostly the octree searches
+//
+void CoreBenchmarks::runLandingMaps(int quads) {
+	ofMesh mesh = terrainMesh(quads);
+	int numVertices = mesh.getNumVertices();
+	Octree octree;
+	octree.create(mesh, buildLevels);
+	int cores = std::max((int)std::thread::hardware_concurrency(), 1);
+	for (int size : landingMapSizes) {
+		for (int threads : { 1, cores }) {
+			LandingMap map;
+			std::string name = "LandingMap::create/res" + std::to_string(size) + "/threads" +
+				std::to_string(threads) + "/" + meshName(quads);
+			time(name, numVertices, [&](int64_t n) {
+				for (int64_t i = 0; i < n; i++)
+					map.create(octree, size, threads);
+				sink = map.cells.size();
+			});
+			results.back().bytes = map.cells.size() * sizeof(LandingCell);
+			if (cores == 1) break;
+		}
+	}
+}
+
+// ParticleSystem::update (forces, integration, terrain collision and
+// the neighbor grid) with numParticles particles bouncing on a
+// synthetic height field
+//
+void CoreBenchmarks::runParticles(int numParticles) {
+	SyntheticTerrain terrain;
+	terrain.res = 65;
+	terrain.size = 100;
+	ofMesh mesh;
+	terrain.create(mesh);
+	Octree octree;
+	octree.create(mesh, 6);
+	HeightField field;
+	field.create(octree, 64);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> xz(-50, 50), up(0, 20), speed(-5, 5);
+	ParticleSystem sys;
+	GravityForce gravity(ofVec3f(0, -10, 0));
+	sys.addForce(&gravity);
+	sys.terrain = &field;
+	for (int i = 0; i < numParticles; i++) {
+		Particle p;
+		p.position = ofVec3f(xz(rng), 50 + up(rng), xz(rng));
+		p.velocity = ofVec3f(speed(rng), speed(rng), speed(rng));
+		p.lifespan = -1;
+		sys.add(p);
+	}
+
+	time("ParticleSystem::update/" + std::to_string(numParticles), numParticles, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++)
+			sys.update();
+		sink = sys.numCollisions;
+	});
+}
+
+void CoreBenchmarks::print() const {
+	for (auto & r : results) {
+		printf("%-56s %14.2f ns %12lld iterations", r.name.c_str(), r.ns, (long long)r.iterations);
+		if (r.items > 1)
+			printf(" %8.3f ns/item", r.ns / r.items);
+		if (r.bytes > 0)
+			printf(" %10.1f KB", r.bytes / 1024.0);
+		printf("\n");
+	}
+}
+
+// JSON in Google Benchmark's layout, as Benchmarks::save writes it
+//
+bool CoreBenchmarks::save(const std::string & path) const {
+	std::ofstream out(path);
+	if (!out) {
+		printf("can't write %s\n", path.c_str());
+		return false;
+	}
+	char date[64];
+	time_t now = ::time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+	out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n";
+#ifdef NDEBUG
+	out << "    \"build\": \"release\",\n";
+#else
+	out << "    \"build\": \"debug\",\n";
+#endif
+#ifdef VECTOR3_SSE
+	out << "    \"simd\": \"sse2\",\n";
+#else
+	out << "    \"simd\": \"none\",\n";
+#endif
+	out << "    \"min_time\": " << minTime << "\n  },\n  \"benchmarks\": [";
+	for (int i = 0; i < results.size(); i++) {
+		const CoreResult & r = results[i];
+		out << (i ? ",\n" : "\n") << "    { \"name\": \"" << r.name << "\", \"iterations\": " << r.iterations <<
+			", \"real_time\": " << r.ns << ", \"time_unit\": \"ns\", \"items\": " << r.items;
+		if (r.bytes > 0) out << ", \"bytes\": " << r.bytes;
+		out << " }";
+	}
+	out << "\n  ]\n}\n";
+	return out.good();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//  Benchmarks of the core library (lander_core), without openFrameworks,
+//  so they run headless on any machine CMake builds for, and in CI.
+//
+//  Cases are timed the way the in-game Benchmarks are (and Google
+//  Benchmark does): repeated with doubling iteration counts until a
+//  batch takes at least minTime.  save() writes the same JSON layout as
+//  Benchmarks::save, so both can be compared with Google Benchmark's
+//  tools.  Primitive cases come in pairs, "before" timing the geometry
+//  as it was before the float4 port (Before.h) and "after" the current
+//  classes, on the same inputs.
+//
+//  The octree builds and queries, particle updates and landing maps run
+//  against SyntheticTerrain meshes, named synthetic_<quads on a side>,
+//  with the same case names the in-game suite used for them.
+//
+class CoreResult {
+public:
+	std::string name;			// case/variant/size
+	int64_t iterations = 0;
+	double ns = 0;				// per iteration
+	int items = 0;				// vertices or boxes per iteration, 1 for single tests
+	size_t bytes = 0;			// memory built, for the layout and landing map cases
+};
+
+class CoreBenchmarks {
+public:
+	void run();
+	void runPrimitives();
+	void runOctants();
+	void runVertexArrays(int quads);
+	void runOctree(int quads);
+	void runLayouts(int quads);
+	void runBuilds(int quads);
+	void runLandingMaps(int quads);
+	void runParticles(int numParticles);
+	void print() const;
+	bool save(const std::string & path) const;
+
+	std::vector<CoreResult> results;
+	double minTime = 0.2;		// seconds a batch has to run
+	std::vector<int> gridSizes = { 64, 256, 1024 };		// quads on a side of the synthetic terrain
+	std::vector<int> terrainSizes = { 64, 128, 256 };	// for runOctree()
+	int octreeLevels = 10;
+	std::vector<int> layoutLevels = { 10, 15, 20 };	// octree levels for runLayouts()
+	int buildQuads = 1024;		// synthetic grid for runBuilds(), over a million vertices
+	int buildLevels = 20;		// as the terrain's octree
+	std::vector<int> landingMapSizes = { 32, 64, 128, 256 };	// cells along x and z
+	std::vector<int> particleCounts = { 1000, 10000 };
+
+	template<typename F>
+	void time(const std::string & name, int items, F f);
+};
+
+// Call f(n) with n = 1, 2, 4 ... until one call takes at least minTime
+// and record the time per iteration of that call
+//
+template<typename F>
+void CoreBenchmarks::time(const std::string & name, int items, F f) {
+	int64_t n = 1;
+	double elapsed;
+	for (;;) {
+		auto start = std::chrono::steady_clock::now();
+		f(n);
+		elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= minTime || n >= (1 << 30)) break;
+		n *= 2;
+	}
+	CoreResult r;
+	r.name = name;
+	r.iterations = n;
+	r.ns = elapsed * 1.0e9 / n;
+	r.items = items;
+	results.push_back(r);
+}
@@ -0,0 +1,24 @@
+
+#include "CoreBenchmarks.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//  lander_bench [--out results.json] [--min-time seconds]
+//
+int main(int argc, char *argv[]) {
+	CoreBenchmarks bench;
+	const char *out = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out = argv[++i];
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) bench.minTime = atof(argv[++i]);
+		else {
+			printf("usage: %s [--out results.json] [--min-time seconds]\n", argv[0]);
+			return 1;
+		}
+	}
+	bench.run();
+	bench.print();
+	if (out && !bench.save(out)) return 1;
+	return 0;
+}
@@ -0,0 +1,215 @@
+
+#include "ofMain.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <random>
+
+const ofColor ofColor::white(255, 255, 255);
+const ofColor ofColor::black(0, 0, 0);
+const ofColor ofColor::red(255, 0, 0);
+const ofColor ofColor::green(0, 255, 0);
+const ofColor ofColor::blue(0, 0, 255);
+const ofColor ofColor::yellow(255, 255, 0);
+const ofColor ofColor::orange(255, 165, 0);
+const ofColor ofColor::aquamarine(127, 255, 212);
+const ofColor ofColor::lightGreen(144, 238, 144);
+const ofColor ofColor::gray(128, 128, 128);
+
+const ofFloatColor ofFloatColor::white(ofColor::white);
+const ofFloatColor ofFloatColor::black(ofColor::black);
+const ofFloatColor ofFloatColor::red(ofColor::red);
+const ofFloatColor ofFloatColor::green(ofColor::green);
+const ofFloatColor ofFloatColor::blue(ofColor::blue);
+const ofFloatColor ofFloatColor::yellow(ofColor::yellow);
+const ofFloatColor ofFloatColor::orange(ofColor::orange);
+const ofFloatColor ofFloatColor::aquamarine(ofColor::aquamarine);
+const ofFloatColor ofFloatColor::lightGreen(ofColor::lightGreen);
+const ofFloatColor ofFloatColor::gray(ofColor::gray);
+
+namespace glm {
+
+// by cofactors, as glm does
+//
+mat4 inverse(const mat4 & m) {
+	const float *a = &m[0][0];
+	float inv[16];
+	inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+	inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+	inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+	inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+	inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+	inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+	inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+	inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+	inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+	inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+	inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+	inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+	inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+	inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+	inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+	inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+	float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+	mat4 r;
+	for (int i = 0; i < 16; i++) (&r[0][0])[i] = inv[i] / det;
+	return r;
+}
+
+mat4 translate(const mat4 & m, const vec3 & v) {
+	mat4 r = m;
+	r[3] = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3];
+	return r;
+}
+
+mat4 rotate(const mat4 & m, float angle, const vec3 & axis) {
+	float c = cosf(angle), s = sinf(angle);
+	vec3 a = normalize(axis);
+	vec3 t = a * (1 - c);
+	mat4 rot;
+	rot[0] = vec4(c + t.x * a.x, t.x * a.y + s * a.z, t.x * a.z - s * a.y, 0);
+	rot[1] = vec4(t.y * a.x - s * a.z, c + t.y * a.y, t.y * a.z + s * a.x, 0);
+	rot[2] = vec4(t.z * a.x + s * a.y, t.z * a.y - s * a.x, c + t.z * a.z, 0);
+	rot[3] = vec4(0, 0, 0, 1);
+	return m * rot;
+}
+
+mat4 scale(const mat4 & m, const vec3 & v) {
+	mat4 r = m;
+	r[0] = m[0] * v.x;
+	r[1] = m[1] * v.y;
+	r[2] = m[2] * v.z;
+	return r;
+}
+
+// right handed, clip z from -1 to 1, as glm's defaults
+//
+mat4 perspective(float fovy, float aspect, float zNear, float zFar) {
+	float f = 1 / tanf(fovy / 2);
+	mat4 r(0);
+	r[0][0] = f / aspect;
+	r[1][1] = f;
+	r[2][2] = -(zFar + zNear) / (zFar - zNear);
+	r[2][3] = -1;
+	r[3][2] = -(2 * zFar * zNear) / (zFar - zNear);
+	return r;
+}
+
+mat4 ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+	mat4 r(1);
+	r[0][0] = 2 / (right - left);
+	r[1][1] = 2 / (top - bottom);
+	r[2][2] = -2 / (zFar - zNear);
+	r[3][0] = -(right + left) / (right - left);
+	r[3][1] = -(top + bottom) / (top - bottom);
+	r[3][2] = -(zFar + zNear) / (zFar - zNear);
+	return r;
+}
+
+mat4 lookAt(const vec3 & eye, const vec3 & center, const vec3 & up) {
+	vec3 f = normalize(center - eye);
+	vec3 s = normalize(cross(f, up));
+	vec3 u = cross(s, f);
+	mat4 r(1);
+	r[0][0] = s.x; r[1][0] = s.y; r[2][0] = s.z;
+	r[0][1] = u.x; r[1][1] = u.y; r[2][1] = u.z;
+	r[0][2] = -f.x; r[1][2] = -f.y; r[2][2] = -f.z;
+	r[3][0] = -dot(s, eye);
+	r[3][1] = -dot(u, eye);
+	r[3][2] = dot(f, eye);
+	return r;
+}
+
+}	// namespace glm
+
+static std::mt19937 & randomEngine() {
+	static std::mt19937 engine(std::random_device{}());
+	return engine;
+}
+
+float ofRandom(float max) {
+	return ofRandom(0, max);
+}
+
+float ofRandom(float min, float max) {
+	if (min > max) std::swap(min, max);
+	if (min == max) return min;
+	return std::uniform_real_distribution<float>(min, max)(randomEngine());
+}
+
+void ofSeedRandom(unsigned long seed) {
+	randomEngine().seed(seed);
+}
+
+// the clock
+//
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static uint64_t fixedNanosPerFrame = 0;		// 0 for real time
+static uint64_t fixedElapsedNanos = 0;
+static uint64_t frameNum = 0;
+static float frameRate = 60;
+
+uint64_t ofGetElapsedTimeMicros() {
+	if (fixedNanosPerFrame > 0) return fixedElapsedNanos / 1000;
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint64_t ofGetElapsedTimeMillis() {
+	return ofGetElapsedTimeMicros() / 1000;
+}
+
+float ofGetElapsedTimef() {
+	return ofGetElapsedTimeMicros() / 1000000.0f;
+}
+
+uint64_t ofGetFrameNum() {
+	return frameNum;
+}
+
+float ofGetFrameRate() {
+	return frameRate;
+}
+
+float ofGetLastFrameTime() {
+	return 1 / frameRate;
+}
+
+void ofSetFrameRate(int rate) {
+	frameRate = rate;
+}
+
+void ofSetTimeModeSystem() {
+	fixedNanosPerFrame = 0;
+}
+
+void ofSetTimeModeFixedRate(uint64_t nanosPerFrame) {
+	fixedNanosPerFrame = nanosPerFrame;
+	frameRate = 1e9f / nanosPerFrame;
+}
+
+void ofHeadlessNextFrame() {
+	frameNum++;
+	fixedElapsedNanos += fixedNanosPerFrame;
+}
+
+// files
+//
+static string dataPathRoot = "data/";
+
+void ofSetDataPathRoot(const string & root) {
+	dataPathRoot = root;
+	if (!dataPathRoot.empty() && dataPathRoot.back() != '/') dataPathRoot += '/';
+}
+
+string ofToDataPath(const string & path, bool absolute) {
+	if (!path.empty() && path[0] == '/') return path;
+	return dataPathRoot + path;
+}
+
+string ofGetTimestampString() {
+	time_t now = time(NULL);
+	ostringstream out;
+	out << std::put_time(localtime(&now), "%Y-%m-%d-%H-%M-%S");
+	return out.str();
+}
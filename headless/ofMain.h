@@ -0,0 +1,527 @@
+#pragma once
+
+//  The part of openFrameworks the simulation modules use, for building
+//  them without it (lander_core, the headless simulator, the tests and
+//  benchmarks).  Only lander_core's include path has this directory, so
+//  the game still builds the same sources against the real ofMain.h.
+//
+//  Math (a glm subset, ofVec3f, ofMesh), the clock, random numbers,
+//  threads and file paths behave like openFrameworks'.  Drawing and GL
+//  buffers are accepted and do nothing, since nothing is on screen.
+//  The clock can be stepped a frame at a time (ofSetTimeModeFixedRate
+//  and ofHeadlessNextFrame) so a simulation runs faster than real time
+//  and the same every run.
+//
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+#ifndef TWO_PI
+#define TWO_PI 6.28318530717958647693
+#endif
+#ifndef DEG_TO_RAD
+#define DEG_TO_RAD (PI / 180.0)
+#endif
+#ifndef RAD_TO_DEG
+#define RAD_TO_DEG (180.0 / PI)
+#endif
+#ifndef MIN
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+#ifndef MAX
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+#endif
+
+#define GL_POINTS 0x0000
+#define GL_TRIANGLES 0x0004
+#define GL_STATIC_DRAW 0x88E4
+#define GL_STREAM_DRAW 0x88E0
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_FALSE 0
+#define GL_TRUE 1
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+
+//  glm: vectors and column major matrices, and the functions on them
+//  the modules and tests call
+//
+namespace glm {
+
+struct vec2 {
+	float x, y;
+	vec2() : x(0), y(0) { }
+	explicit vec2(float s) : x(s), y(s) { }
+	vec2(float x, float y) : x(x), y(y) { }
+	float & operator[](int i) { return (&x)[i]; }
+	const float & operator[](int i) const { return (&x)[i]; }
+	vec2 operator+(const vec2 & v) const { return vec2(x + v.x, y + v.y); }
+	vec2 operator-(const vec2 & v) const { return vec2(x - v.x, y - v.y); }
+	vec2 operator*(float s) const { return vec2(x * s, y * s); }
+	bool operator==(const vec2 & v) const { return x == v.x && y == v.y; }
+};
+
+struct vec4;
+
+struct vec3 {
+	float x, y, z;
+	vec3() : x(0), y(0), z(0) { }
+	explicit vec3(float s) : x(s), y(s), z(s) { }
+	vec3(float x, float y, float z) : x(x), y(y), z(z) { }
+	explicit vec3(const vec4 & v);
+	float & operator[](int i) { return (&x)[i]; }
+	const float & operator[](int i) const { return (&x)[i]; }
+	vec3 operator-() const { return vec3(-x, -y, -z); }
+	vec3 operator+(const vec3 & v) const { return vec3(x + v.x, y + v.y, z + v.z); }
+	vec3 operator-(const vec3 & v) const { return vec3(x - v.x, y - v.y, z - v.z); }
+	vec3 operator*(const vec3 & v) const { return vec3(x * v.x, y * v.y, z * v.z); }
+	vec3 operator/(const vec3 & v) const { return vec3(x / v.x, y / v.y, z / v.z); }
+	vec3 operator*(float s) const { return vec3(x * s, y * s, z * s); }
+	vec3 operator/(float s) const { return vec3(x / s, y / s, z / s); }
+	vec3 & operator+=(const vec3 & v) { x += v.x; y += v.y; z += v.z; return *this; }
+	vec3 & operator-=(const vec3 & v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	vec3 & operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+	vec3 & operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+	bool operator==(const vec3 & v) const { return x == v.x && y == v.y && z == v.z; }
+	bool operator!=(const vec3 & v) const { return !(*this == v); }
+};
+inline vec3 operator*(float s, const vec3 & v) { return v * s; }
+
+struct vec4 {
+	float x, y, z, w;
+	vec4() : x(0), y(0), z(0), w(0) { }
+	explicit vec4(float s) : x(s), y(s), z(s), w(s) { }
+	vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) { }
+	vec4(const vec3 & v, float w) : x(v.x), y(v.y), z(v.z), w(w) { }
+	float & operator[](int i) { return (&x)[i]; }
+	const float & operator[](int i) const { return (&x)[i]; }
+	vec4 operator+(const vec4 & v) const { return vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+	vec4 operator-(const vec4 & v) const { return vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
+	vec4 operator*(float s) const { return vec4(x * s, y * s, z * s, w * s); }
+	vec4 operator/(float s) const { return vec4(x / s, y / s, z / s, w / s); }
+};
+inline vec3::vec3(const vec4 & v) : x(v.x), y(v.y), z(v.z) { }
+
+// columns c[0..3]; m[c][r] as in glm
+//
+struct mat4 {
+	vec4 c[4];
+	mat4() : mat4(1) { }
+	explicit mat4(float s) {
+		for (int i = 0; i < 4; i++) {
+			c[i] = vec4(0);
+			c[i][i] = s;
+		}
+	}
+	vec4 & operator[](int i) { return c[i]; }
+	const vec4 & operator[](int i) const { return c[i]; }
+};
+
+inline vec4 operator*(const mat4 & m, const vec4 & v) {
+	return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+}
+
+inline mat4 operator*(const mat4 & a, const mat4 & b) {
+	mat4 r;
+	for (int i = 0; i < 4; i++) r[i] = a * b[i];
+	return r;
+}
+
+inline float dot(const vec2 & a, const vec2 & b) { return a.x * b.x + a.y * b.y; }
+inline float dot(const vec3 & a, const vec3 & b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float dot(const vec4 & a, const vec4 & b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline vec3 cross(const vec3 & a, const vec3 & b) {
+	return vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline float length(const vec2 & v) { return sqrtf(dot(v, v)); }
+inline float length(const vec3 & v) { return sqrtf(dot(v, v)); }
+inline float distance(const vec2 & a, const vec2 & b) { return length(a - b); }
+inline float distance(const vec3 & a, const vec3 & b) { return length(a - b); }
+inline vec3 normalize(const vec3 & v) { return v / length(v); }
+inline vec3 min(const vec3 & a, const vec3 & b) { return vec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)); }
+inline vec3 max(const vec3 & a, const vec3 & b) { return vec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)); }
+inline float radians(float degrees) { return degrees * (float)DEG_TO_RAD; }
+inline float degrees(float radians) { return radians * (float)RAD_TO_DEG; }
+
+inline mat4 transpose(const mat4 & m) {
+	mat4 r;
+	for (int i = 0; i < 4; i++)
+		for (int k = 0; k < 4; k++) r[i][k] = m[k][i];
+	return r;
+}
+
+mat4 inverse(const mat4 & m);
+mat4 translate(const mat4 & m, const vec3 & v);
+mat4 rotate(const mat4 & m, float angle, const vec3 & axis);
+mat4 scale(const mat4 & m, const vec3 & v);
+mat4 perspective(float fovy, float aspect, float zNear, float zFar);
+mat4 ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+mat4 lookAt(const vec3 & eye, const vec3 & center, const vec3 & up);
+
+}	// namespace glm
+
+//  ofVec3f, ofVec2f and colors
+//
+class ofVec2f {
+public:
+	ofVec2f() : x(0), y(0) { }
+	ofVec2f(float x, float y) : x(x), y(y) { }
+	ofVec2f(const glm::vec2 & v) : x(v.x), y(v.y) { }
+	operator glm::vec2() const { return glm::vec2(x, y); }
+	float & operator[](int i) { return (&x)[i]; }
+	const float & operator[](int i) const { return (&x)[i]; }
+	void set(float x_, float y_) { x = x_; y = y_; }
+
+	float x, y;
+};
+
+class ofVec3f {
+public:
+	ofVec3f() : x(0), y(0), z(0) { }
+	ofVec3f(float x, float y, float z = 0) : x(x), y(y), z(z) { }
+	ofVec3f(const glm::vec3 & v) : x(v.x), y(v.y), z(v.z) { }
+	ofVec3f(const ofVec2f & v) : x(v.x), y(v.y), z(0) { }
+	operator glm::vec3() const { return glm::vec3(x, y, z); }
+	operator ofVec2f() const { return ofVec2f(x, y); }
+
+	float & operator[](int i) { return (&x)[i]; }
+	const float & operator[](int i) const { return (&x)[i]; }
+	void set(float x_, float y_, float z_ = 0) { x = x_; y = y_; z = z_; }
+	void set(const ofVec3f & v) { *this = v; }
+
+	ofVec3f operator-() const { return ofVec3f(-x, -y, -z); }
+	ofVec3f operator+(const ofVec3f & v) const { return ofVec3f(x + v.x, y + v.y, z + v.z); }
+	ofVec3f operator-(const ofVec3f & v) const { return ofVec3f(x - v.x, y - v.y, z - v.z); }
+	ofVec3f operator*(const ofVec3f & v) const { return ofVec3f(x * v.x, y * v.y, z * v.z); }
+	ofVec3f operator*(float s) const { return ofVec3f(x * s, y * s, z * s); }
+	ofVec3f operator/(float s) const { return ofVec3f(x / s, y / s, z / s); }
+	ofVec3f & operator+=(const ofVec3f & v) { x += v.x; y += v.y; z += v.z; return *this; }
+	ofVec3f & operator-=(const ofVec3f & v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	ofVec3f & operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+	ofVec3f & operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+	bool operator==(const ofVec3f & v) const { return x == v.x && y == v.y && z == v.z; }
+	bool operator!=(const ofVec3f & v) const { return !(*this == v); }
+
+	float dot(const ofVec3f & v) const { return x * v.x + y * v.y + z * v.z; }
+	ofVec3f getCrossed(const ofVec3f & v) const { return ofVec3f(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x); }
+	ofVec3f & cross(const ofVec3f & v) { return *this = getCrossed(v); }
+	float lengthSquared() const { return x * x + y * y + z * z; }
+	float length() const { return sqrtf(lengthSquared()); }
+	float squareDistance(const ofVec3f & v) const { return (*this - v).lengthSquared(); }
+	float distance(const ofVec3f & v) const { return (*this - v).length(); }
+	ofVec3f getNormalized() const {
+		float len = length();
+		return len > 0 ? *this / len : *this;
+	}
+	ofVec3f & normalize() { return *this = getNormalized(); }
+	ofVec3f normalized() const { return getNormalized(); }
+
+	float x, y, z;
+};
+inline ofVec3f operator*(float s, const ofVec3f & v) { return v * s; }
+typedef ofVec3f ofPoint;
+
+class ofColor {
+public:
+	ofColor() : r(255), g(255), b(255), a(255) { }
+	ofColor(float gray, float a = 255) : r(gray), g(gray), b(gray), a(a) { }
+	ofColor(float r, float g, float b, float a = 255) : r(r), g(g), b(b), a(a) { }
+	void set(float r_, float g_, float b_, float a_ = 255) { r = r_; g = g_; b = b_; a = a_; }
+
+	unsigned char r, g, b, a;
+	static const ofColor white, black, red, green, blue, yellow, orange, aquamarine, lightGreen, gray;
+};
+
+class ofFloatColor {
+public:
+	ofFloatColor() : r(1), g(1), b(1), a(1) { }
+	ofFloatColor(float r, float g, float b, float a = 1) : r(r), g(g), b(b), a(a) { }
+	ofFloatColor(const ofColor & c) : r(c.r / 255.f), g(c.g / 255.f), b(c.b / 255.f), a(c.a / 255.f) { }
+	void set(float r_, float g_, float b_, float a_ = 1) { r = r_; g = g_; b = b_; a = a_; }
+	ofFloatColor getLerped(const ofFloatColor & c, float t) const {
+		return ofFloatColor(r + (c.r - r) * t, g + (c.g - g) * t, b + (c.b - b) * t, a + (c.a - a) * t);
+	}
+
+	float r, g, b, a;
+	static const ofFloatColor white, black, red, green, blue, yellow, orange, aquamarine, lightGreen, gray;
+};
+
+//  ofMesh: vertex, normal, texture coordinate, color and index arrays.
+//  draw() and the other draw calls do nothing
+//
+typedef unsigned int ofIndexType;
+
+enum ofPrimitiveMode {
+	OF_PRIMITIVE_TRIANGLES, OF_PRIMITIVE_TRIANGLE_STRIP, OF_PRIMITIVE_TRIANGLE_FAN,
+	OF_PRIMITIVE_LINES, OF_PRIMITIVE_LINE_STRIP, OF_PRIMITIVE_LINE_LOOP, OF_PRIMITIVE_POINTS
+};
+
+class ofMesh {
+public:
+	void setMode(ofPrimitiveMode m) { mode = m; }
+	ofPrimitiveMode getMode() const { return mode; }
+	void clear() {
+		vertices.clear(); normals.clear(); texCoords.clear(); colors.clear(); indices.clear();
+	}
+
+	void addVertex(const glm::vec3 & v) { vertices.push_back(v); }
+	void addVertices(const vector<glm::vec3> & v) { vertices.insert(vertices.end(), v.begin(), v.end()); }
+	void addVertices(const glm::vec3 *v, size_t n) { vertices.insert(vertices.end(), v, v + n); }
+	void addNormal(const glm::vec3 & n) { normals.push_back(n); }
+	void addNormals(const vector<glm::vec3> & n) { normals.insert(normals.end(), n.begin(), n.end()); }
+	void addNormals(const glm::vec3 *n, size_t count) { normals.insert(normals.end(), n, n + count); }
+	void addTexCoord(const glm::vec2 & t) { texCoords.push_back(t); }
+	void addColor(const ofFloatColor & c) { colors.push_back(c); }
+	void addIndex(ofIndexType i) { indices.push_back(i); }
+	void addIndices(const vector<ofIndexType> & i) { indices.insert(indices.end(), i.begin(), i.end()); }
+	void addIndices(const ofIndexType *i, size_t n) { indices.insert(indices.end(), i, i + n); }
+	void addTriangle(ofIndexType a, ofIndexType b, ofIndexType c) { addIndex(a); addIndex(b); addIndex(c); }
+	void clearNormals() { normals.clear(); }
+	void clearColors() { colors.clear(); }
+	void clearIndices() { indices.clear(); }
+
+	size_t getNumVertices() const { return vertices.size(); }
+	size_t getNumNormals() const { return normals.size(); }
+	size_t getNumTexCoords() const { return texCoords.size(); }
+	size_t getNumColors() const { return colors.size(); }
+	size_t getNumIndices() const { return indices.size(); }
+	bool hasNormals() const { return !normals.empty(); }
+
+	glm::vec3 getVertex(ofIndexType i) const { return vertices[i]; }
+	glm::vec3 getNormal(ofIndexType i) const { return normals[i]; }
+	ofFloatColor getColor(ofIndexType i) const { return colors[i]; }
+	ofIndexType getIndex(ofIndexType i) const { return indices[i]; }
+	void setVertex(ofIndexType i, const glm::vec3 & v) { vertices[i] = v; }
+	void setNormal(ofIndexType i, const glm::vec3 & n) { normals[i] = n; }
+	void setColor(ofIndexType i, const ofFloatColor & c) { colors[i] = c; }
+	void setIndex(ofIndexType i, ofIndexType v) { indices[i] = v; }
+
+	vector<glm::vec3> & getVertices() { return vertices; }
+	const vector<glm::vec3> & getVertices() const { return vertices; }
+	vector<glm::vec3> & getNormals() { return normals; }
+	const vector<glm::vec3> & getNormals() const { return normals; }
+	vector<glm::vec2> & getTexCoords() { return texCoords; }
+	const vector<glm::vec2> & getTexCoords() const { return texCoords; }
+	vector<ofFloatColor> & getColors() { return colors; }
+	const vector<ofFloatColor> & getColors() const { return colors; }
+	vector<ofIndexType> & getIndices() { return indices; }
+	const vector<ofIndexType> & getIndices() const { return indices; }
+
+	void draw() const { }
+	void drawFaces() const { }
+	void drawWireframe() const { }
+	void drawVertices() const { }
+
+private:
+	ofPrimitiveMode mode = OF_PRIMITIVE_TRIANGLES;
+	vector<glm::vec3> vertices;
+	vector<glm::vec3> normals;
+	vector<glm::vec2> texCoords;
+	vector<ofFloatColor> colors;
+	vector<ofIndexType> indices;
+};
+
+class ofVboMesh : public ofMesh {
+public:
+	ofVboMesh() { }
+	ofVboMesh(const ofMesh & m) : ofMesh(m) { }
+};
+
+// GL buffers remember whether they were allocated and nothing else
+//
+class ofBufferObject {
+public:
+	void allocate(size_t bytes, GLenum usage) { size = bytes; }
+	void updateData(ptrdiff_t offset, size_t bytes, const void *data) { }
+	bool isAllocated() const { return size > 0; }
+	size_t size = 0;
+};
+
+class ofVbo {
+public:
+	void setMesh(const ofMesh & mesh, int usage) { allocated = true; }
+	void setVertexData(const glm::vec3 *v, int total, int usage) { allocated = true; }
+	void setNormalData(const glm::vec3 *n, int total, int usage) { }
+	void setColorData(const ofFloatColor *c, int total, int usage) { }
+	void setIndexData(const ofIndexType *i, int total, int usage) { }
+	void setVertexBuffer(ofBufferObject & b, int components, int stride, int offset = 0) { allocated = true; }
+	void setNormalBuffer(ofBufferObject & b, int stride, int offset = 0) { }
+	void setColorBuffer(ofBufferObject & b, int stride, int offset = 0) { }
+	ofBufferObject & getVertexBuffer() { return vertexBuffer; }
+	ofBufferObject & getNormalBuffer() { return normalBuffer; }
+	ofBufferObject & getColorBuffer() { return colorBuffer; }
+	bool getIsAllocated() const { return allocated; }
+	void draw(int mode, int first, int total) const { }
+	void drawElements(int mode, int amt, int offset = 0) const { }
+	void clear() { allocated = false; }
+
+private:
+	bool allocated = false;
+	ofBufferObject vertexBuffer, normalBuffer, colorBuffer;
+};
+
+//  drawing does nothing
+//
+inline void ofSetColor(const ofColor & c) { }
+inline void ofSetColor(float gray) { }
+inline void ofSetColor(float r, float g, float b, float a = 255) { }
+inline void ofDrawBox(const glm::vec3 & p, float w, float h, float d) { }
+inline void ofDrawSphere(const glm::vec3 & p, float radius) { }
+inline void ofDrawLine(const glm::vec3 & a, const glm::vec3 & b) { }
+inline void ofDrawBitmapString(const string & s, float x, float y) { }
+inline void ofDrawBitmapStringHighlight(const string & s, float x, float y,
+	const ofColor & background = ofColor::black, const ofColor & foreground = ofColor::white) { }
+inline void ofPushMatrix() { }
+inline void ofPopMatrix() { }
+inline void ofNoFill() { }
+inline void ofFill() { }
+
+//  math utilities
+//
+inline float ofClamp(float v, float min, float max) { return v < min ? min : (v > max ? max : v); }
+inline float ofMap(float v, float inMin, float inMax, float outMin, float outMax, bool clamp = false) {
+	if (fabs(inMin - inMax) < FLT_EPSILON) return outMin;
+	float out = (v - inMin) / (inMax - inMin) * (outMax - outMin) + outMin;
+	if (clamp) out = outMax < outMin ? ofClamp(out, outMax, outMin) : ofClamp(out, outMin, outMax);
+	return out;
+}
+inline float ofLerp(float a, float b, float t) { return a + (b - a) * t; }
+inline float ofDegToRad(float degrees) { return degrees * (float)DEG_TO_RAD; }
+inline float ofRadToDeg(float radians) { return radians * (float)RAD_TO_DEG; }
+
+// random numbers from one generator, seeded like openFrameworks'
+//
+float ofRandom(float max);
+float ofRandom(float min, float max);
+void ofSeedRandom(unsigned long seed);
+
+//  the clock.  Real time by default; after ofSetTimeModeFixedRate
+//  time moves only by a fixed step at each ofHeadlessNextFrame()
+//
+uint64_t ofGetElapsedTimeMicros();
+uint64_t ofGetElapsedTimeMillis();
+float ofGetElapsedTimef();
+uint64_t ofGetFrameNum();
+float ofGetFrameRate();
+float ofGetLastFrameTime();
+void ofSetFrameRate(int rate);
+void ofSetTimeModeSystem();
+void ofSetTimeModeFixedRate(uint64_t nanosPerFrame);
+void ofHeadlessNextFrame();
+
+//  files; data paths are relative to ofSetDataPathRoot(), "data/" by
+//  default
+//
+void ofSetDataPathRoot(const string & root);
+string ofToDataPath(const string & path, bool absolute = false);
+string ofGetTimestampString();
+
+template<typename T>
+string ofToString(const T & value) {
+	ostringstream out;
+	out << value;
+	return out.str();
+}
+
+inline void ofExit(int status = 0) { exit(status); }
+
+//  threads
+//
+class ofThread {
+public:
+	virtual ~ofThread() { waitForThread(true); }
+	void startThread() {
+		if (thread.joinable()) return;
+		running = true;
+		thread = std::thread([this]() { threadedFunction(); running = false; });
+	}
+	void stopThread() { running = false; }
+	void waitForThread(bool stop = true, long milliseconds = -1) {
+		if (stop) stopThread();
+		if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) thread.join();
+	}
+	bool isThreadRunning() const { return running; }
+	void lock() { mutex.lock(); }
+	void unlock() { mutex.unlock(); }
+	void sleep(long milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+
+protected:
+	virtual void threadedFunction() = 0;
+	std::mutex mutex;
+
+private:
+	std::thread thread;
+	std::atomic<bool> running { false };
+};
+
+// a blocking queue between threads; receive() returns false once the
+// channel is closed
+//
+template<typename T>
+class ofThreadChannel {
+public:
+	bool send(const T & value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (closed) return false;
+		queue.push_back(value);
+		condition.notify_one();
+		return true;
+	}
+	bool send(T && value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (closed) return false;
+		queue.push_back(std::move(value));
+		condition.notify_one();
+		return true;
+	}
+	bool receive(T & value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this]() { return closed || !queue.empty(); });
+		if (queue.empty()) return false;
+		value = std::move(queue.front());
+		queue.pop_front();
+		return true;
+	}
+	bool tryReceive(T & value) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (queue.empty()) return false;
+		value = std::move(queue.front());
+		queue.pop_front();
+		return true;
+	}
+	void close() {
+		std::unique_lock<std::mutex> lock(mutex);
+		closed = true;
+		condition.notify_all();
+	}
+	bool empty() const {
+		std::unique_lock<std::mutex> lock(mutex);
+		return queue.empty();
+	}
+
+private:
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<T> queue;
+	bool closed = false;
+};
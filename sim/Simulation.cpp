@@ -0,0 +1,197 @@
+
+#include "Simulation.h"
+#include <chrono>
+#include <thread>
+
+static double msSince(std::chrono::steady_clock::time_point t) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+// Builds the terrain and everything the game builds from it, then puts
+// the lander at its start with the game's settings (ofApp::setupLander)
+//
+void Simulation::setup() {
+	ofSetTimeModeFixedRate(1000000000 / 60);
+	ofSeedRandom(seed);
+	terrainGen.seed = seed;
+
+	auto startTime = std::chrono::steady_clock::now();
+	ofMesh mesh;
+	terrainGen.create(mesh);
+	octree.createMorton(std::move(mesh), octreeLevels);
+	heightField.create(octree, heightFieldRes);
+	landingMap.create(octree, landingMapRes, MAX(1, (int)std::thread::hardware_concurrency()));
+	if (compact) octree.compact();
+	setupTime = msSince(startTime);
+
+	// aim for the best scored cell, the nearest to the start of equals
+	//
+	Box bounds = octree.root.box;
+	const Vector3 & min = bounds.min();
+	const Vector3 & max = bounds.max();
+	float step = (max.x() - min.x()) / landingMapRes;
+	float best = -1, bestDist = FLT_MAX;
+	for (int k = 0; k < landingMapRes; k++) {
+		for (int i = 0; i < landingMapRes; i++) {
+			float x = min.x() + (i + 0.5) * step;
+			float z = min.z() + (k + 0.5) * step;
+			float score = landingMap.getScore(x, z);
+			float dist = glm::distance(glm::vec2(x, z), glm::vec2(start.x, start.z));
+			if (score > best || (score == best && dist < bestDist)) {
+				best = score;
+				bestDist = dist;
+				target = glm::vec3(x, heightField.getHeight(x, z), z);
+			}
+		}
+	}
+
+	lander.thrust = 25.0;
+	lander.gravity = ofVec3f(0, -8.0, 0);
+	lander.damping = 0.99;
+	lander.fuel = fuel;
+	lander.boundsMin = glm::vec3(-1.5, 0, -1.5);		// about the size of geo/lander.obj
+	lander.boundsMax = glm::vec3(1.5, 3, 1.5);
+	lander.setPosition(start);
+	lander.updateBoundingBox();
+
+	// the exhaust as effects.json sets it up
+	//
+	exhaust.setEmitterType(DiscEmitter);
+	exhaust.setRate(2.5);
+	exhaust.setGroupSize(250);
+	exhaust.setLifespan(0.25);
+	exhaust.setParticleRadius(0.05);
+	exhaust.setVelocity(ofVec3f(0, -25, 0));
+	exhaust.setOneShot(true);
+	exhaust.maxParticles = 4096;
+	exhaust.sys->restitution = 0.3;
+	exhaust.sys->terrain = &heightField;
+}
+
+// One frame of ofApp::update: steer, collide, integrate, sense and
+// update the exhaust
+//
+bool Simulation::step() {
+	if (outcome != Flying || frame >= maxFrames) return false;
+	auto startTime = std::chrono::steady_clock::now();
+
+	autopilot();
+	checkCollisions();
+	lander.integrate();
+	lander.updateBoundingBox();
+	probeLegs();
+
+	glm::vec3 p = lander.getPosition();
+	exhaust.setPosition(ofVec3f(p.x, p.y + 2.5, p.z));
+	exhaust.update();
+	maxParticles = MAX(maxParticles, (int)exhaust.sys->particles.size());
+	particleCollisions += exhaust.sys->numCollisions;
+
+	frame++;
+	ofHeadlessNextFrame();
+	stepTime += msSince(startTime);
+	return outcome == Flying && frame < maxFrames;
+}
+
+void Simulation::run() {
+	setup();
+	while (step());
+}
+
+// Flies over the target at a safe height, then lets down onto it slower
+// the lower it gets.  Thrust is held to what the game's keys give on each
+// axis, and every frame with thrust burns one unit of fuel
+//
+void Simulation::autopilot() {
+	glm::vec3 p = lander.getPosition();
+	glm::vec3 v = lander.velocity;
+	glm::vec2 offset = glm::vec2(target.x - p.x, target.z - p.z);
+	float dist = glm::length(offset);
+	float altitude = p.y - target.y;
+
+	glm::vec2 wantVel = offset * 0.5f;
+	if (dist > 0 && glm::length(wantVel) > 8) wantVel = wantVel * (8 / glm::length(wantVel));
+	float wantVy;
+	if (dist > 2) wantVy = (15 - altitude) * 0.5f;			// hold height until it's over the target
+	else wantVy = -ofClamp(altitude * 0.4, 1.0, 4.0);
+
+	glm::vec3 thrust;
+	thrust.x = ofClamp((wantVel.x - v.x) * 4, -lander.thrust, lander.thrust);
+	thrust.z = ofClamp((wantVel.y - v.z) * 4, -lander.thrust, lander.thrust);
+	thrust.y = ofClamp((wantVy - v.y) * 4 - lander.gravity.y, -lander.thrust, lander.thrust);
+	if (lander.fuel <= 0) thrust = glm::vec3(0, 0, 0);
+	lander.appliedThrust = thrust;
+
+	if (glm::length(thrust) > 0) lander.fuel--;
+
+	// fire the exhaust now and then while the main engine is on, as
+	// holding the key does in the game
+	//
+	exhaustFrames++;
+	if (thrust.y > 0 && exhaustFrames >= 6 && !exhaust.started) {
+		exhaust.start();
+		exhaustFrames = 0;
+	}
+}
+
+// As ofApp::checkCollisions: the height field rules contact out, the
+// octree confirms it, and the impulse off the ground lands the lander,
+// bounces it or blows it up
+//
+void Simulation::checkCollisions() {
+	colBoxList.clear();
+	bool contact;
+	float groundTop;
+	if (heightField.maxHeightIn(lander.shipBBox, groundTop) &&
+		lander.shipBBox.parameters[0].y() > groundTop)
+		contact = false;
+	else
+		contact = octree.intersect(lander.shipBBox, colBoxList);
+	if (contact && lander.velocity.y < 0) {
+		ofVec3f norm = ofVec3f(0, 1, 0);
+		ofVec3f vel = lander.velocity;
+		if (touchdownSpeed == 0) {
+			touchdownSpeed = -vel.y;
+			glm::vec3 p = lander.getPosition();
+			targetMiss = glm::distance(glm::vec2(p.x, p.z), glm::vec2(target.x, target.z));
+		}
+		lander.impulseForce = 60 * (1.85)*((-vel.dot(norm))*norm);
+		if (lander.impulseForce.y < 500 && lander.impulseForce.y > 0) {
+			lander.thrust = 0;
+			lander.landed = true;
+			touchdownScore = landingMap.scoreArea(lander.shipBBox);
+			outcome = Landed;
+		}
+		else if (lander.impulseForce.y > 800)
+			outcome = Crashed;
+	}
+}
+
+// Nearest terrain to each corner of the bottom of the lander, as
+// ofApp::probeProximity measures the leg clearance
+//
+void Simulation::probeLegs() {
+	Vector3View verts = octree.vertices();
+	const Vector3 & min = lander.shipBBox.min();
+	const Vector3 & max = lander.shipBBox.max();
+	for (int i = 0; i < 4; i++) {
+		Vector3 foot((i & 1) ? max.x() : min.x(), min.y(), (i & 2) ? max.z() : min.z());
+		int n = octree.nearest(foot, 50);
+		if (n < 0) continue;
+		float d = (verts[n] - foot).length();
+		if (minLegClearance < 0 || d < minLegClearance) minLegClearance = d;
+	}
+}
+
+void Simulation::print() const {
+	const char *outcomes[] = { "still flying", "landed", "crashed" };
+	printf("%-24s %s after %d frames (%.2f s)\n", "outcome", outcomes[outcome], frame, frame / 60.0);
+	printf("%-24s %.2f\n", "touchdown speed", touchdownSpeed);
+	printf("%-24s %.2f\n", "touchdown score", touchdownScore);
+	printf("%-24s %.2f from (%.1f, %.1f, %.1f)\n", "target miss", targetMiss, target.x, target.y, target.z);
+	printf("%-24s %.2f\n", "fuel left", lander.fuel);
+	printf("%-24s %.2f\n", "min leg clearance", minLegClearance);
+	printf("%-24s %d most, %d collisions\n", "exhaust particles", maxParticles, particleCollisions);
+	printf("%-24s %.2f ms\n", "setup", setupTime);
+	printf("%-24s %.2f ms, %.3f ms/frame\n", "flight", stepTime, frame > 0 ? stepTime / frame : 0.0);
+}
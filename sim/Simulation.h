@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+#include "HeightField.h"
+#include "LandingMap.h"
+#include "ParticleEmitter.h"
+#include "ShipBody.h"
+#include "SyntheticTerrain.h"
+
+//  One landing flown with no window.
+//
+//  The terrain is generated (SyntheticTerrain) and goes through the same
+//  octree, height field and landing map as the game's.  An autopilot
+//  picks the best scored cell and flies a ShipBody down onto it with the
+//  game's thrust, gravity and damping, firing the exhaust emitter while
+//  it thrusts; the exhaust bounces off the height field.  Ground contact
+//  is checked as ofApp::checkCollisions does it and lands or crashes the
+//  lander by the same impulse limits.
+//
+//  The clock is stepped a fixed 1/60 s per frame, and random numbers are
+//  seeded, so a run is the same every time and as fast as the machine.
+//
+class Simulation {
+public:
+	enum Outcome { Flying = 0, Landed, Crashed };
+
+	void setup();
+	bool step();			// one frame; false once the flight is over
+	void run();
+	void print() const;
+
+	// settings, before setup()
+	//
+	SyntheticTerrain terrainGen;
+	unsigned seed = 1;
+	int maxFrames = 3600;
+	int octreeLevels = 12;
+	int heightFieldRes = 256;
+	int landingMapRes = 64;
+	bool compact = true;			// compact the octree, as the game does by default
+	glm::vec3 start = glm::vec3(-50, 30, -50);
+	float fuel = 2000;				// frames of thrust
+
+	// the world
+	//
+	Octree octree;
+	HeightField heightField;
+	LandingMap landingMap;
+	ShipBody lander;
+	ParticleEmitter exhaust;
+	glm::vec3 target;				// center of the cell the autopilot aims for
+
+	// results
+	//
+	Outcome outcome = Flying;
+	int frame = 0;
+	float touchdownSpeed = 0;		// downward, at first contact
+	float touchdownScore = 0;		// landing map score under the lander
+	float targetMiss = 0;			// x/z distance from the target at touchdown
+	float minLegClearance = -1;		// nearest terrain to any landing leg over the flight
+	int maxParticles = 0;
+	int particleCollisions = 0;
+	float setupTime = 0;			// ms to build the terrain, octree, height field and map
+	float stepTime = 0;				// ms in step(), all frames
+
+private:
+	void autopilot();
+	void checkCollisions();
+	void probeLegs();
+
+	vector<Box> colBoxList;
+	int exhaustFrames = 0;			// frames since the exhaust last fired
+};
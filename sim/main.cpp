@@ -0,0 +1,27 @@
+
+#include "Simulation.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//  lander_sim [--frames N] [--seed S] [--tree]
+//
+//  Flies one landing with no window and prints how it went.  Exits 0 if
+//  the lander landed.  --tree keeps the octree uncompacted.
+//
+int main(int argc, char *argv[]) {
+	Simulation sim;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) sim.maxFrames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) sim.seed = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--tree") == 0) sim.compact = false;
+		else {
+			printf("usage: %s [--frames N] [--seed S] [--tree]\n", argv[0]);
+			return 1;
+		}
+	}
+	sim.terrainGen.padCenter = glm::vec3(40, 0, 30);
+	sim.run();
+	sim.print();
+	return sim.outcome == Simulation::Landed ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+
+#include "AssetLoader.h"
+#include "Profiler.h"
+
+void AssetWorker::threadedFunction() {
+	Profiler::get().setThreadName("asset loader");
+	int job;
+	while (loader->pending.receive(job)) {
+		loader->runLoad(loader->jobs[job]);
+		loader->loaded.send(job);
+	}
+}
+
+// add a job; either function can be empty.  Jobs can't be added after
+// start()
+//
+void AssetLoader::add(const string & name, function<void()> load, function<void()> finish) {
+	AssetJob job;
+	job.name = name;
+	job.load = load;
+	job.finish = finish;
+	jobs.push_back(job);
+}
+
+// Start loading on numThreads worker threads, or serially on the main
+// thread from update() if numThreads is 0
+//
+void AssetLoader::start(int numThreads) {
+	startTime = ofGetElapsedTimeMicros();
+	if (numThreads <= 0) return;
+	for (int i = 0; i < numThreads; i++) {
+		workers.push_back(make_shared<AssetWorker>(this));
+		workers.back()->startThread();
+	}
+	for (int i = 0; i < jobs.size(); i++) {
+		if (jobs[i].load) pending.send(i);
+		else loaded.send(i);		// nothing to load, just finish it
+	}
+}
+
+void AssetLoader::runLoad(AssetJob & job) {
+	if (!job.load) return;
+	PROFILE_SCOPE("assets/load");
+	uint64_t t = ofGetElapsedTimeMicros();
+	job.load();
+	job.loadTime = (ofGetElapsedTimeMicros() - t) / 1000.0;
+}
+
+// Finish one job whose load is done, on the main thread.  Returns true
+// once every job has finished
+//
+bool AssetLoader::update() {
+	if (isDone()) return true;
+
+	int job = -1;
+	if (workers.empty()) {
+		job = nextSerial++;
+		runLoad(jobs[job]);
+	}
+	else if (!loaded.tryReceive(job))
+		return false;
+
+	AssetJob & j = jobs[job];
+	uint64_t t = ofGetElapsedTimeMicros();
+	if (j.finish) j.finish();
+	j.finishTime = (ofGetElapsedTimeMicros() - t) / 1000.0;
+	serialTime += j.loadTime + j.finishTime;
+	lastFinished = j.name;
+	numFinished++;
+
+	if (isDone()) {
+		totalTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+		stop();
+	}
+	return isDone();
+}
+
+// stop the worker threads
+//
+void AssetLoader::stop() {
+	if (workers.empty()) return;
+	pending.close();
+	for (int i = 0; i < workers.size(); i++)
+		workers[i]->waitForThread(true);
+	workers.clear();
+}
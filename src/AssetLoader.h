@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ofMain.h"
+
+//  Loads assets in the background while the app keeps drawing.
+//
+//  Each job has an optional load function, run on a worker thread (file
+//  I/O, decoding, building data structures -- nothing that touches GL),
+//  and an optional finish function, run on the main thread from update()
+//  once the load is done (GL uploads and anything else that isn't thread
+//  safe).  Jobs are independent and finish in whatever order their loads
+//  complete.  update() runs at most one finish per call so a loading
+//  screen keeps drawing between the slow ones.
+//
+//  With no worker threads the loads run one per update() on the main
+//  thread instead, which is the serial load order for comparison.
+//
+class AssetJob {
+public:
+	string name;
+	function<void()> load;			// worker thread
+	function<void()> finish;		// main thread
+	float loadTime = 0;				// ms
+	float finishTime = 0;			// ms
+};
+
+class AssetLoader;
+
+class AssetWorker : public ofThread {
+public:
+	AssetWorker(AssetLoader *loader) : loader(loader) { }
+	void threadedFunction();
+	AssetLoader *loader;
+};
+
+class AssetLoader {
+public:
+	~AssetLoader() { stop(); }
+	void add(const string & name, function<void()> load, function<void()> finish);
+	void start(int numThreads);
+	bool update();
+	void stop();
+	void runLoad(AssetJob & job);
+	bool isDone() const { return numFinished == jobs.size(); }
+	float getProgress() const { return jobs.empty() ? 1 : (float)numFinished / jobs.size(); }
+
+	vector<AssetJob> jobs;
+	ofThreadChannel<int> pending;		// jobs waiting for a worker
+	ofThreadChannel<int> loaded;		// jobs whose load is done
+	vector<shared_ptr<AssetWorker>> workers;
+	int numFinished = 0;
+	string lastFinished;				// name of the job finished last
+
+	// stats
+	//
+	uint64_t startTime = 0;			// us
+	float totalTime = 0;			// ms from start() to the last finish
+	float serialTime = 0;			// ms, sum of every load and finish
+
+private:
+	int nextSerial = 0;
+};
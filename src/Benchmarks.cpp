@@ -0,0 +1,317 @@
+
+#include "Benchmarks.h"
+#include "HeightField.h"
+#include "ParticleSystem.h"
+#include "TerrainTiles.h"
+
+// keeps results the compiler could otherwise prove unused
+//
+static volatile int sink;
+
+// Call f(n) with n = 1, 2, 4 ... until one call takes at least minTime
+// and record the time per iteration of that call
+//
+template<typename F>
+void Benchmarks::time(const string & name, int vertices, F f) {
+	int64_t n = 1;
+	double elapsed;
+	for (;;) {
+		uint64_t start = ofGetElapsedTimeMicros();
+		f(n);
+		elapsed = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+		if (elapsed >= minTime || n >= (1 << 30)) break;
+		n *= 2;
+	}
+	BenchmarkResult r;
+	r.name = name;
+	r.iterations = n;
+	r.ns = elapsed * 1.0e9 / n;
+	r.vertices = vertices;
+	results.push_back(r);
+}
+
+float Benchmarks::random(float min, float max) {
+	return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+// Time every case against the given terrain and each synthetic size
+//
+void Benchmarks::run(const ofMesh & terrain) {
+	results.clear();
+	if (terrain.getNumVertices() > 0)
+		runMesh("terrain", terrain);
+	for (int quads : syntheticSizes)
+		runMesh("synthetic_" + ofToString(quads), TerrainTiles::syntheticMesh(0, 0, 500, quads));
+	int quads = syntheticSizes.back();
+	runCraters("synthetic_" + ofToString(quads), TerrainTiles::syntheticMesh(0, 0, 500, quads));
+	runNearest("synthetic_" + ofToString(quads), TerrainTiles::syntheticMesh(0, 0, 500, quads));
+	for (int count : gridCounts)
+		runGrid(count);
+}
+
+void Benchmarks::runMesh(const string & meshName, const ofMesh & mesh) {
+	int numVertices = mesh.getNumVertices();
+	string suffix = "/" + meshName;
+
+	Octree octree;
+	octree.create(mesh, octreeLevels);
+
+	const Box & bounds = octree.root.box;
+	vector<Box> boxList;
+	time("Octree::subDivideBox8" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++)
+			octree.subDivideBox8(bounds, boxList);
+		sink = boxList.size();
+	});
+
+	// random lander sized boxes and downward rays over the terrain
+	//
+	const int numQueries = 1024;
+	Vector3 size = bounds.max() - bounds.min();
+	vector<Box> boxes(numQueries);
+	vector<Ray> rays(numQueries);
+	for (int i = 0; i < numQueries; i++) {
+		Vector3 p = bounds.min() + Vector3(random(0, size.x()), random(0, size.y()), random(0, size.z()));
+		boxes[i] = Box(p, p + Vector3(random(1, 10), random(1, 10), random(1, 10)));
+		rays[i] = Ray(Vector3(p.x(), bounds.max().y() + 1, p.z()), Vector3(random(-.5, .5), -1, random(-.5, .5)));
+	}
+
+	time("Box::overlap" + suffix, numVertices, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += boxes[i & (numQueries - 1)].overlap(boxes[(i * 7) & (numQueries - 1)]);
+		sink = hits;
+	});
+	time("Box::intersect" + suffix, numVertices, [&](int64_t n) {
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += boxes[i & (numQueries - 1)].intersect(rays[(i * 7) & (numQueries - 1)], 0, 1000);
+		sink = hits;
+	});
+
+	// every vertex against one octant, as the first level of create()
+	//
+	vector<Box> octants;
+	octree.subDivideBox8(bounds, octants);
+	vector<int> pointsRtn;
+	time("Octree::getMeshPointsInBox" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++) {
+			pointsRtn.clear();
+			octree.getMeshPointsInBox(octree.mesh, octree.root.points, octants[0], pointsRtn);
+		}
+		sink = pointsRtn.size();
+	});
+}
+
+// One crater carved at a random spot (the octree subtree and height
+// field cells under it), against rebuilding the octree and height
+// field from scratch as the terrain would without incremental updates
+//
+void Benchmarks::runCraters(const string & meshName, const ofMesh & mesh) {
+	int numVertices = mesh.getNumVertices();
+	string suffix = "/" + meshName;
+	Octree octree;
+	octree.create(mesh, buildLevels);
+	HeightField field;
+	field.create(octree, 256);
+	const Vector3 & min = octree.root.box.min();
+	const Vector3 & max = octree.root.box.max();
+
+	rng.seed(42);
+	vector<int> moved;
+	Box region;
+	time("Octree::carve" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++) {
+			float x = random(min.x(), max.x());
+			float z = random(min.z(), max.z());
+			float y;
+			ofVec3f normal;
+			if (!field.getGround(x, z, y, normal)) y = max.y();
+			if (octree.carve(Vector3(x, y, z), craterRadius, craterRadius / 4, moved, region) > 0)
+				field.update(octree.mesh, region.min().x(), region.min().z(), region.max().x(), region.max().z());
+		}
+		sink = moved.size();
+	});
+
+	time("Octree::create+HeightField::create" + suffix, numVertices, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++) {
+			Octree rebuilt;
+			rebuilt.create(octree.mesh, buildLevels);
+			field.create(rebuilt, 256);
+		}
+	});
+}
+
+// k nearest point queries from random spots at each altitude, on both
+// node layouts.  The higher the query point, the more of the tree has to
+// be opened before the k nearest are settled
+//
+void Benchmarks::runNearest(const string & meshName, const ofMesh & mesh) {
+	int numVertices = mesh.getNumVertices();
+	Octree octree;
+	octree.create(mesh, buildLevels);
+	const Vector3 & min = octree.root.box.min();
+	const Vector3 & max = octree.root.box.max();
+
+	rng.seed(42);
+	const int numQueries = 256;
+	vector<vector<Vector3>> queries;
+	for (float altitude : nearestAltitudes) {
+		vector<Vector3> q(numQueries);
+		for (int i = 0; i < numQueries; i++)
+			q[i] = Vector3(random(min.x(), max.x()), max.y() + altitude, random(min.z(), max.z()));
+		queries.push_back(q);
+	}
+
+	for (string layout : { "tree", "compact" }) {
+		if (layout == "compact") octree.compact();
+		for (int a = 0; a < nearestAltitudes.size(); a++) {
+			const vector<Vector3> & q = queries[a];
+			string suffix = "/" + layout + "/alt" + ofToString(nearestAltitudes[a]) + "/" + meshName;
+			vector<int> pointsRtn;
+			for (int k : nearestK) {
+				time("Octree::nearest/k" + ofToString(k) + suffix, numVertices, [&](int64_t n) {
+					for (int64_t i = 0; i < n; i++)
+						octree.nearest(q[i % numQueries], k, pointsRtn);
+					sink = pointsRtn.size();
+				});
+			}
+			time("Octree::pointsInRadius" + suffix, numVertices, [&](int64_t n) {
+				for (int64_t i = 0; i < n; i++)
+					octree.pointsInRadius(q[i % numQueries], nearestAltitudes[a] * 2, pointsRtn);
+				sink = pointsRtn.size();
+			});
+		}
+	}
+}
+
+// Ground height under random spots through the height field, against
+// a ray straight down through the octree as the altitude was found
+// before the field
+//
+void Benchmarks::runGroundQueries(const string & meshName, const ofMesh & mesh) {
+	int numVertices = mesh.getNumVertices();
+	string suffix = "/" + meshName;
+	Octree octree;
+	octree.create(mesh, buildLevels);
+	HeightField field;
+	field.create(octree, 256);
+	const Vector3 & min = octree.root.box.min();
+	const Vector3 & max = octree.root.box.max();
+
+	const int numQueries = 1024;
+	vector<Vector3> q(numQueries);
+	for (int i = 0; i < numQueries; i++)
+		q[i] = Vector3(random(min.x(), max.x()), max.y() + 1, random(min.z(), max.z()));
+
+	time("HeightField::getGround" + suffix, numVertices, [&](int64_t n) {
+		float h;
+		ofVec3f normal;
+		int hits = 0;
+		for (int64_t i = 0; i < n; i++) {
+			const Vector3 & p = q[i & (numQueries - 1)];
+			hits += field.getGround(p.x(), p.z(), h, normal);
+		}
+		sink = hits;
+	});
+	time("Octree::intersect(Ray)/down" + suffix, numVertices, [&](int64_t n) {
+		int point, hits = 0;
+		for (int64_t i = 0; i < n; i++)
+			hits += octree.intersect(Ray(q[i & (numQueries - 1)], Vector3(0, -1, 0)), point);
+		sink = hits;
+	});
+}
+
+// Rebuilding the particle spatial hash, as the first query after an
+// update() does, and radius queries against it, with the particles
+// spread about one to a cell
+//
+void Benchmarks::runGrid(int numParticles) {
+	float side = cbrt((float)numParticles);
+	vector<Particle> particles(numParticles);
+	for (int i = 0; i < numParticles; i++)
+		particles[i].position = ofVec3f(random(0, side), random(0, side), random(0, side));
+
+	ParticleGrid grid;
+	string suffix = "/" + ofToString(numParticles);
+	time("ParticleGrid::build" + suffix, numParticles, [&](int64_t n) {
+		for (int64_t i = 0; i < n; i++)
+			grid.build(particles);
+		sink = grid.tableSize;
+	});
+
+	const int numQueries = 1024;
+	vector<ofVec3f> q(numQueries);
+	for (int i = 0; i < numQueries; i++)
+		q[i] = ofVec3f(random(0, side), random(0, side), random(0, side));
+	vector<int> indicesRtn;
+	time("ParticleGrid::query" + suffix, numParticles, [&](int64_t n) {
+		int found = 0;
+		for (int64_t i = 0; i < n; i++) {
+			indicesRtn.clear();
+			found += grid.query(particles, q[i & (numQueries - 1)], gridQueryRadius * grid.cellSize, indicesRtn);
+		}
+		sink = found;
+	});
+}
+
+void Benchmarks::print() {
+	char line[256];
+	for (auto & r : results) {
+		snprintf(line, sizeof(line), "%-56s %14.1f ns %12lld iterations", r.name.c_str(), r.ns, (long long)r.iterations);
+		cout << line << endl;
+	}
+}
+
+bool Benchmarks::save(const string & path) {
+	ofJson j;
+	j["context"]["date"] = ofGetTimestampString("%Y-%m-%dT%H:%M:%S");
+#ifdef NDEBUG
+	j["context"]["build"] = "release";
+#else
+	j["context"]["build"] = "debug";
+#endif
+	j["context"]["min_time"] = minTime;
+	j["benchmarks"] = ofJson::array();
+	for (auto & r : results) {
+		ofJson b;
+		b["name"] = r.name;
+		b["iterations"] = r.iterations;
+		b["real_time"] = r.ns;
+		b["time_unit"] = "ns";
+		b["vertices"] = r.vertices;
+		j["benchmarks"].push_back(b);
+	}
+	return ofSavePrettyJson(path, j);
+}
+
+bool BenchmarkThread::start(const ofMesh & mesh, Suite s) {
+	if (isThreadRunning() || !bCollected) return false;
+	terrain = mesh;
+	suite = s;
+	bCollected = false;
+	startThread();
+	return true;
+}
+
+bool BenchmarkThread::finished() {
+	if (bCollected || isThreadRunning()) return false;
+	waitForThread(false);
+	bCollected = true;
+	return true;
+}
+
+void BenchmarkThread::threadedFunction() {
+	switch (suite) {
+	case Primitives:
+		bench.results.clear();
+		bench.runMesh("terrain", terrain);
+		break;
+	case GroundQueries:
+		bench.results.clear();
+		bench.runGroundQueries("terrain", terrain);
+		break;
+	default:
+		bench.run(terrain);
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+#include <random>
+
+//  Microbenchmarks of the geometry and spatial queries, in the game.
+//
+//  run() times the box primitives, craters, nearest point queries and
+//  the particle grid against the real terrain and against synthetic
+//  terrain grids of a few sizes.  The octree builds and ray and box
+//  queries, meshBounds, particle updates and landing maps don't need the
+//  game's terrain and are in lander_bench (bench/), which runs headless
+//  and in CI.  Like Google Benchmark, every case is repeated with doubling
+//  iteration counts until a batch takes at least minTime, and the time
+//  per iteration of that batch is reported.  save() writes the results
+//  as JSON, in Google Benchmark's layout, so runs from different commits
+//  (or machines) can be compared with its tools:
+//
+//    { "context": { "date": ..., "build": ... },
+//      "benchmarks": [ { "name": "Box::overlap/synthetic_128",
+//                        "iterations": 8388608, "real_time": 3.1,
+//                        "time_unit": "ns", "vertices": 16641 }, ... ] }
+//
+//  Random inputs come from the suite's own generator, not ofRandom, so
+//  a run on BenchmarkThread neither races with nor reseeds the game's.
+//
+class BenchmarkResult {
+public:
+	string name;				// case/mesh
+	int64_t iterations = 0;
+	double ns = 0;				// per iteration
+	int vertices = 0;			// in the mesh, or particles
+};
+
+class Benchmarks {
+public:
+	void run(const ofMesh & terrain);
+	void runMesh(const string & meshName, const ofMesh & mesh);
+	void runCraters(const string & meshName, const ofMesh & mesh);
+	void runNearest(const string & meshName, const ofMesh & mesh);
+	void runGroundQueries(const string & meshName, const ofMesh & mesh);
+	void runGrid(int numParticles);
+	void print();
+	bool save(const string & path);
+
+	vector<BenchmarkResult> results;
+	float minTime = 0.2;		// seconds a batch has to run
+	int octreeLevels = 10;
+	vector<int> syntheticSizes = { 64, 128, 256 };		// quads on a side
+	float craterRadius = 8;		// for runCraters(), in the synthetic terrain's units
+	vector<int> nearestK = { 1, 8, 64 };				// for runNearest()
+	vector<float> nearestAltitudes = { 1, 10, 50, 200 };	// above the highest terrain
+	int buildLevels = 20;		// as the terrain's octree
+	vector<int> gridCounts = { 10000, 100000, 1000000 };	// particles for runGrid()
+	float gridQueryRadius = 2;	// in cells, for runGrid()
+
+private:
+	template<typename F>
+	void time(const string & name, int vertices, F f);
+	float random(float min, float max);
+
+	std::mt19937 rng;
+};
+
+//  Runs the suite, or one of its quick checks, on its own thread so the
+//  game keeps drawing while it takes its minutes.  start() copies the
+//  terrain, as craters keep changing the octree's mesh during the run;
+//  finished() turns true once, on the first call after the run is over,
+//  for the main thread to print and save the results.
+//
+class BenchmarkThread : public ofThread {
+public:
+	enum Suite { All, Primitives, GroundQueries };
+
+	~BenchmarkThread() { waitForThread(false); }
+	bool start(const ofMesh & terrain, Suite suite = All);
+	bool finished();
+	void threadedFunction();
+
+	Benchmarks bench;
+	ofMesh terrain;
+	Suite suite = All;			// what the last start() ran
+	bool bCollected = true;		// results of the last run taken by finished()
+};
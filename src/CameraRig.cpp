@@ -0,0 +1,55 @@
+
+#include "CameraRig.h"
+
+CameraRig::CameraRig() {
+	for (int i = 0; i < NumViews; i++) {
+		cams[i] = NULL;
+		dirty[i] = false;
+	}
+	target = glm::vec3(0, 0, 0);
+	cameraTime = 0;
+}
+
+// record where the lander is; cameras catch up lazily in get()
+//
+void CameraRig::setTarget(const glm::vec3 & p) {
+	if (p == target) return;
+	target = p;
+	for (int i = 0; i < NumViews; i++)
+		dirty[i] = true;
+}
+
+// return the camera for "view", placing it first if the target moved
+//
+ofCamera * CameraRig::get(View view) {
+	if (dirty[view]) place(view);
+	return cams[view];
+}
+
+// position a camera relative to the target
+//
+void CameraRig::place(View view) {
+	dirty[view] = false;
+	ofCamera *camera = cams[view];
+	if (camera == NULL) return;
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	switch (view) {
+	case Top:		// looking straight down from the lander
+		camera->setPosition(target);
+		break;
+	case Front:		// in front of and above the lander
+		camera->setPosition(target.x, target.y + 5, target.z - 5);
+		break;
+	case Follow:	// side view following the lander
+		camera->setPosition(target.x, target.y, target.z + 40);
+		camera->lookAt(target);
+		break;
+	case Ground:	// fixed on the ground, watching the lander
+		camera->lookAt(target);
+		break;
+	default:		// free camera, not attached to the lander
+		break;
+	}
+	cameraTime += (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+}
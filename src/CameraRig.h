@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ofMain.h"
+
+//  The set of game cameras that track the lander.
+//
+//  Moving the lander only records the new target; a camera is placed
+//  relative to it when it is asked for with get(), so the views that
+//  aren't on screen cost nothing each frame.
+//
+class CameraRig {
+public:
+	enum View { Default = 0, Top, Follow, Front, Ground, NumViews };
+
+	CameraRig();
+	void add(View view, ofCamera *camera) { cams[view] = camera; }
+	void setTarget(const glm::vec3 & p);
+	ofCamera * get(View view);
+	void place(View view);
+	void resetStats() { cameraTime = 0; }
+
+	ofCamera *cams[NumViews];
+	bool dirty[NumViews];		// target moved since the camera was placed
+	glm::vec3 target;
+	float cameraTime;			// ms spent placing cameras since resetStats()
+};
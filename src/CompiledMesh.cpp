@@ -0,0 +1,350 @@
+
+#include "CompiledMesh.h"
+#include "MeshMerge.h"
+#include "ofxAssimpModelLoader.h"
+
+#ifndef TARGET_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// read only memory mapping of a whole file
+//
+class MappedFile {
+public:
+	~MappedFile() { close(); }
+	bool open(const string & path);
+	void close();
+
+	const char *data = NULL;
+	size_t size = 0;
+
+private:
+#ifdef TARGET_WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+#else
+	int fd = -1;
+#endif
+};
+
+#ifdef TARGET_WIN32
+bool MappedFile::open(const string & path) {
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+	size = fileSize.QuadPart;
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL)
+		data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (data != NULL) UnmapViewOfFile(data);
+	if (mapping != NULL) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	data = NULL;
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+	size = 0;
+}
+#else
+bool MappedFile::open(const string & path) {
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close();
+		return false;
+	}
+	size = st.st_size;
+	void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		close();
+		return false;
+	}
+	data = (const char *)p;
+	return true;
+}
+
+void MappedFile::close() {
+	if (data != NULL) munmap((void *)data, size);
+	if (fd >= 0) ::close(fd);
+	data = NULL;
+	fd = -1;
+	size = 0;
+}
+#endif
+
+static uint32_t align16(uint32_t offset) {
+	return (offset + 15) & ~15u;
+}
+
+// true if the mapped file's header is a compiled mesh of this version
+// whose blocks are all inside the file, with normals one per vertex.
+// Reports what's wrong with it if not
+//
+static bool isValidHeader(const MappedFile & file, const string & path) {
+	if (file.size < sizeof(CompiledMeshHeader)) {
+		cout << path << ": truncated" << endl;
+		return false;
+	}
+	const CompiledMeshHeader & h = *(const CompiledMeshHeader *)file.data;
+	if (strncmp(h.magic, "LMSH", 4) != 0 || h.version != COMPILED_MESH_VERSION) {
+		cout << path << ": not a compiled mesh, or an old version" << endl;
+		return false;
+	}
+	if (h.positionsOffset + (size_t)h.numVertices * 12 > file.size ||
+		h.normalsOffset + (size_t)h.numNormals * 12 > file.size ||
+		h.indicesOffset + (size_t)h.numIndices * 4 > file.size ||
+		h.nodesOffset + (size_t)h.numNodes * 16 > file.size ||
+		h.leafPointsOffset + (size_t)h.numLeafPoints * 4 > file.size) {
+		cout << path << ": truncated" << endl;
+		return false;
+	}
+	if (h.numNormals != 0 && h.numNormals != h.numVertices) {
+		cout << path << ": " << h.numNormals << " normals for " << h.numVertices << " vertices" << endl;
+		return false;
+	}
+	return true;
+}
+
+// isValidHeader(), and every index a vertex and every octree node's
+// points and children in range
+//
+static bool isValid(const MappedFile & file, const string & path) {
+	if (!isValidHeader(file, path)) return false;
+	const CompiledMeshHeader & h = *(const CompiledMeshHeader *)file.data;
+	const uint32_t *indices = (const uint32_t *)(file.data + h.indicesOffset);
+	for (uint32_t i = 0; i < h.numIndices; i++) {
+		if (indices[i] >= h.numVertices) {
+			cout << path << ": index " << i << " is " << indices[i] << ", past " << h.numVertices << " vertices" << endl;
+			return false;
+		}
+	}
+	const uint32_t *n = (const uint32_t *)(file.data + h.nodesOffset);
+	for (uint32_t i = 0; i < h.numNodes; i++, n += 4) {
+		int children = 0;
+		for (int o = 0; o < 8; o++) children += (n[3] >> o) & 1;
+		if ((size_t)n[1] + n[2] > h.numLeafPoints || n[3] > 0xff ||
+			(children > 0 && (size_t)n[0] + children > h.numNodes)) {
+			cout << path << ": octree node " << i << " out of range" << endl;
+			return false;
+		}
+	}
+	const uint32_t *points = (const uint32_t *)(file.data + h.leafPointsOffset);
+	for (uint32_t i = 0; i < h.numLeafPoints; i++) {
+		if (points[i] >= h.numVertices) {
+			cout << path << ": octree point " << i << " is " << points[i] << ", past " << h.numVertices << " vertices" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Map a compiled mesh and copy it into meshRtn.  Returns false if the
+// file is missing or fails isValid()
+//
+bool CompiledMesh::load(const string & path, ofMesh & meshRtn) {
+	return read(path, meshRtn, NULL);
+}
+
+// Same, into octreeRtn's mesh.  If the file holds octree nodes the tree
+// comes back compacted and ready for queries; if not it's left for the
+// caller to build
+//
+bool CompiledMesh::load(const string & path, Octree & octreeRtn) {
+	octreeRtn.nodes.clear();
+	octreeRtn.leafPoints.clear();
+	return read(path, octreeRtn.mesh, &octreeRtn);
+}
+
+bool CompiledMesh::read(const string & path, ofMesh & meshRtn, Octree *octreeRtn) {
+	MappedFile file;
+	if (!file.open(ofToDataPath(path, true))) return false;
+	if (!isValid(file, path)) return false;
+
+	const CompiledMeshHeader & h = *(const CompiledMeshHeader *)file.data;
+	meshRtn.clear();
+	meshRtn.setMode(OF_PRIMITIVE_TRIANGLES);
+	meshRtn.addVertices((const glm::vec3 *)(file.data + h.positionsOffset), h.numVertices);
+	if (h.numNormals > 0)
+		meshRtn.addNormals((const glm::vec3 *)(file.data + h.normalsOffset), h.numNormals);
+	const uint32_t *indices = (const uint32_t *)(file.data + h.indicesOffset);
+	if (sizeof(ofIndexType) == sizeof(uint32_t))
+		meshRtn.addIndices((const ofIndexType *)indices, h.numIndices);
+	else {
+		for (int i = 0; i < h.numIndices; i++)
+			meshRtn.addIndex(indices[i]);
+	}
+
+	if (octreeRtn != NULL && h.numNodes > 0) {
+		const uint32_t *n = (const uint32_t *)(file.data + h.nodesOffset);
+		octreeRtn->nodes.resize(h.numNodes);
+		for (int i = 0; i < h.numNodes; i++, n += 4) {
+			octreeRtn->nodes[i].firstChild = n[0];
+			octreeRtn->nodes[i].firstPoint = n[1];
+			octreeRtn->nodes[i].numPoints = n[2];
+			octreeRtn->nodes[i].childMask = n[3];
+		}
+		const uint32_t *points = (const uint32_t *)(file.data + h.leafPointsOffset);
+		octreeRtn->leafPoints.assign(points, points + h.numLeafPoints);
+		octreeRtn->root = TreeNode();
+		octreeRtn->root.box = Box(Vector3(h.rootMin[0], h.rootMin[1], h.rootMin[2]),
+			Vector3(h.rootMax[0], h.rootMax[1], h.rootMax[2]));
+		octreeRtn->levels = h.octreeLevels;
+	}
+
+	bounds = Box(Vector3(h.min[0], h.min[1], h.min[2]), Vector3(h.max[0], h.max[1], h.max[2]));
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			matrix[c][r] = h.matrix[c * 4 + r];
+	fileSize = file.size;
+	return true;
+}
+
+// Write mesh as a compiled mesh.  matrix is the model matrix the mesh is
+// drawn with, kept so the runtime doesn't need the original model.  A
+// compacted octree over the mesh is stored with it
+//
+bool CompiledMesh::save(const ofMesh & mesh, const glm::mat4 & matrix, const string & path, const Octree *octree) {
+	CompiledMeshHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "LMSH", 4);
+	h.version = COMPILED_MESH_VERSION;
+	h.numVertices = mesh.getNumVertices();
+	h.numNormals = (mesh.getNumNormals() == mesh.getNumVertices()) ? mesh.getNumNormals() : 0;
+	h.numIndices = mesh.getNumIndices();
+	h.positionsOffset = align16(sizeof(h));
+	h.normalsOffset = align16(h.positionsOffset + h.numVertices * 12);
+	h.indicesOffset = align16(h.normalsOffset + h.numNormals * 12);
+	h.numNodes = (octree != NULL && octree->isCompact()) ? octree->nodes.size() : 0;
+	h.nodesOffset = align16(h.indicesOffset + h.numIndices * 4);
+	h.numLeafPoints = h.numNodes > 0 ? octree->leafPoints.size() : 0;
+	h.leafPointsOffset = align16(h.nodesOffset + h.numNodes * 16);
+	size_t size = h.leafPointsOffset + h.numLeafPoints * 4;
+
+	for (int k = 0; k < 3; k++) {
+		h.min[k] = h.numVertices > 0 ? FLT_MAX : 0;
+		h.max[k] = h.numVertices > 0 ? -FLT_MAX : 0;
+	}
+	for (int i = 0; i < h.numVertices; i++) {
+		const glm::vec3 & v = mesh.getVertices()[i];
+		for (int k = 0; k < 3; k++) {
+			h.min[k] = MIN(h.min[k], v[k]);
+			h.max[k] = MAX(h.max[k], v[k]);
+		}
+	}
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			h.matrix[c * 4 + r] = matrix[c][r];
+	if (h.numNodes > 0) {
+		h.octreeLevels = octree->levels;
+		for (int k = 0; k < 3; k++) {
+			h.rootMin[k] = octree->root.box.min()[k];
+			h.rootMax[k] = octree->root.box.max()[k];
+		}
+	}
+
+	vector<char> buffer(size, 0);
+	memcpy(&buffer[0], &h, sizeof(h));
+	if (h.numVertices > 0)
+		memcpy(&buffer[h.positionsOffset], mesh.getVertices().data(), h.numVertices * 12);
+	if (h.numNormals > 0)
+		memcpy(&buffer[h.normalsOffset], mesh.getNormals().data(), h.numNormals * 12);
+	uint32_t *indices = (uint32_t *)&buffer[h.indicesOffset];
+	for (int i = 0; i < h.numIndices; i++)
+		indices[i] = mesh.getIndex(i);
+	uint32_t *nodes = (uint32_t *)&buffer[h.nodesOffset];
+	for (int i = 0; i < h.numNodes; i++, nodes += 4) {
+		const CompactNode & node = octree->nodes[i];
+		nodes[0] = node.firstChild;
+		nodes[1] = node.firstPoint;
+		nodes[2] = node.numPoints;
+		nodes[3] = node.childMask;
+	}
+	if (h.numLeafPoints > 0)
+		memcpy(&buffer[h.leafPointsOffset], octree->leafPoints.data(), h.numLeafPoints * 4);
+
+	ofstream out(ofToDataPath(path, true), ios::binary);
+	out.write(&buffer[0], size);
+	return out.good();
+}
+
+// Import a model through Assimp and write all of its meshes, as one
+// indexed mesh in world space, to dstPath
+//
+bool CompiledMesh::compile(const string & srcPath, const string & dstPath) {
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	ofxAssimpModelLoader model;
+	if (!model.loadModel(srcPath)) {
+		cout << "can't import " << srcPath << endl;
+		return false;
+	}
+	model.setScaleNormalization(false);
+	float importTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+
+	// each mesh's node transform and the model matrix are baked into its
+	// vertices, as MergedModel does, so the compiled mesh is in world
+	// space: what's drawn and what the octree, height field and landing
+	// map are queried with are the same points
+	//
+	int numMeshes = model.getNumMeshes();
+	vector<ofMesh> meshes(numMeshes);
+	vector<MergeMesh> inputs(numMeshes);
+	bool normals = true;
+	for (int i = 0; i < numMeshes; i++) {
+		ofMesh & mesh = meshes[i];
+		mesh = model.getMesh(i);
+		MergeMesh & input = inputs[i];
+		input.numVertices = mesh.getNumVertices();
+		if (input.numVertices > 0) input.positions = &mesh.getVertices()[0].x;
+		if (input.numVertices > 0 && mesh.getNumNormals() == input.numVertices)
+			input.normals = &mesh.getNormals()[0].x;
+		else normals = false;
+		input.numIndices = mesh.getNumIndices();
+		if (input.numIndices > 0) input.indices = &mesh.getIndices()[0];
+		glm::mat4 transform = model.getModelMatrix() * model.getMeshHelper(i).matrix;
+		memcpy(input.transform, &transform[0][0], sizeof(input.transform));
+	}
+	MergeResult merged;
+	mergeMeshes(inputs, merged);
+
+	ofMesh mesh;
+	for (const MergeVertex & v : merged.vertices) {
+		mesh.addVertex(glm::vec3(v.position[0], v.position[1], v.position[2]));
+		if (normals) mesh.addNormal(glm::vec3(v.normal[0], v.normal[1], v.normal[2]));
+	}
+	for (uint32_t index : merged.indices)
+		mesh.addIndex(index);
+
+	bool saved = save(mesh, glm::mat4(1), dstPath);
+	cout << "compiled " << srcPath << " to " << dstPath << ": " << mesh.getNumVertices() << " vertices, import " <<
+		importTime << "ms, total " << (ofGetElapsedTimeMicros() - startTime) / 1000.0 << "ms" << endl;
+	return saved;
+}
+
+// true if dstPath needs (re)compiling from srcPath: it's missing, older
+// than the source, or fails isValidHeader() (another version of the
+// format, or a truncated file).  Only the header is checked here; the
+// per-element pass is load()'s, so a file is scanned once per run
+//
+bool CompiledMesh::isStale(const string & srcPath, const string & dstPath) {
+	string src = ofToDataPath(srcPath, true);
+	string dst = ofToDataPath(dstPath, true);
+	MappedFile file;
+	if (!file.open(dst) || !isValidHeader(file, dstPath)) return true;
+	if (!std::filesystem::exists(src)) return false;
+	return std::filesystem::last_write_time(src) > std::filesystem::last_write_time(dst);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+
+//  Meshes compiled to a binary file that loads without parsing.
+//
+//  The file is a fixed header followed by the vertex positions, normals
+//  and triangle indices, and optionally the nodes of the mesh's compacted
+//  Octree, each block starting on a 16 byte boundary:
+//
+//    CompiledMeshHeader
+//    float    positions[numVertices][3]
+//    float    normals[numNormals][3]		(numNormals is 0 or numVertices)
+//    uint32_t indices[numIndices]
+//    uint32_t nodes[numNodes][4]			(firstChild, firstPoint, numPoints, childMask)
+//    uint32_t leafPoints[numLeafPoints]
+//
+//  load() maps the file into memory and copies the blocks straight into
+//  an ofMesh, with no text to parse; the only per-element pass checks
+//  that every index, octree node and leaf point is in range, so a
+//  damaged file is refused rather than indexed past the end.  isStale()
+//  checks only the header, so a file of another version or a truncated
+//  one is recompiled without being scanned twice.  Loading into an
+//  Octree also takes the stored nodes, so the tree isn't rebuilt.
+//  compile() is the asset compiler: it imports a model through Assimp
+//  once and writes all of its meshes, concatenated and with each node's
+//  transform and the model matrix baked in, as one compiled mesh in
+//  world space.
+//
+#define COMPILED_MESH_VERSION 4
+
+struct CompiledMeshHeader {
+	char magic[4];				// "LMSH"
+	uint32_t version;
+	uint32_t numVertices;
+	uint32_t numNormals;
+	uint32_t numIndices;
+	uint32_t positionsOffset;	// bytes from the start of the file
+	uint32_t normalsOffset;
+	uint32_t indicesOffset;
+	float min[3], max[3];		// bounds of the positions
+	float matrix[16];			// model matrix to draw with; identity from compile()
+	uint32_t numNodes;			// 0 if no octree is stored
+	uint32_t nodesOffset;
+	uint32_t octreeLevels;
+	float rootMin[3], rootMax[3];	// the octree's root box
+	uint32_t numLeafPoints;
+	uint32_t leafPointsOffset;
+};
+
+class CompiledMesh {
+public:
+	bool load(const string & path, ofMesh & meshRtn);
+	bool load(const string & path, Octree & octreeRtn);
+
+	static bool compile(const string & srcPath, const string & dstPath);
+	static bool save(const ofMesh & mesh, const glm::mat4 & matrix, const string & path, const Octree *octree = NULL);
+	static bool isStale(const string & srcPath, const string & dstPath);
+
+	// from the last load()
+	//
+	Box bounds;
+	glm::mat4 matrix;
+	size_t fileSize = 0;
+
+private:
+	bool read(const string & path, ofMesh & meshRtn, Octree *octreeRtn);
+};
@@ -0,0 +1,197 @@
+
+#include "EffectLibrary.h"
+
+static ofVec3f jsonVec3(const ofJson & j, const string & key, const ofVec3f & def) {
+	if (!j.count(key) || !j[key].is_array() || j[key].size() < 3) return def;
+	return ofVec3f(j[key][0].get<float>(), j[key][1].get<float>(), j[key][2].get<float>());
+}
+
+static EmitterType emitterType(const string & type) {
+	if (type == "radial") return RadialEmitter;
+	if (type == "sphere") return SphereEmitter;
+	if (type == "disc") return DiscEmitter;
+	return DirectionalEmitter;
+}
+
+static shared_ptr<ParticleForce> makeForce(const ForceConfig & def) {
+	if (def.type == "gravity")
+		return make_shared<GravityForce>(def.value);
+	if (def.type == "turbulence")
+		return make_shared<TurbulenceForce>(def.value, def.value2);
+	if (def.type == "impulse") {
+		auto f = make_shared<ImpulseRadialForce>(def.magnitude);
+		f->setHeight(def.height);
+		return f;
+	}
+	if (def.type == "cyclic")
+		return make_shared<CyclicForce>(def.magnitude);
+	cout << "effects: unknown force type \"" << def.type << "\" ignored" << endl;
+	return nullptr;
+}
+
+// compile one effect definition, clamping it to the budgets
+//
+static EffectConfig compile(const string & name, const ofJson & j, int maxParticles, int maxSpawnPerFrame) {
+	EffectConfig e;
+	e.name = name;
+	e.type = emitterType(j.value("type", string("directional")));
+	e.rate = j.value("rate", e.rate);
+	e.groupSize = j.value("groupSize", e.groupSize);
+	e.lifespan = j.value("lifespan", e.lifespan);
+	e.randomLife = j.value("randomLife", e.randomLife);
+	ofVec3f range = jsonVec3(j, "lifeRange", ofVec3f(e.lifeRange.x, e.lifeRange.y, 0));
+	e.lifeRange = ofVec2f(range.x, range.y);
+	e.velocity = jsonVec3(j, "velocity", e.velocity);
+	if (e.type == RadialEmitter || e.type == SphereEmitter) {
+		if (j.count("velocity"))
+			cout << "effects: " << name << " throws particles every way, only the length of its velocity is used" << endl;
+		e.velocity = ofVec3f(0, j.value("speed", e.velocity.length()), 0);
+	}
+	e.radius = j.value("radius", e.radius);
+	e.particleRadius = j.value("particleRadius", e.particleRadius);
+	ofVec3f c = jsonVec3(j, "color", ofVec3f(e.color.r, e.color.g, e.color.b));
+	e.color = ofColor(c.x, c.y, c.z);
+	e.mass = j.value("mass", e.mass);
+	e.damping = j.value("damping", e.damping);
+	e.oneShot = j.value("oneShot", e.oneShot);
+	e.pointSize = j.value("pointSize", e.pointSize);
+	e.restitution = j.value("restitution", e.restitution);
+	e.killOnCollide = j.value("killOnCollide", e.killOnCollide);
+
+	if (j.count("forces")) {
+		for (auto & f : j["forces"]) {
+			ForceConfig def;
+			def.type = f.value("type", string(""));
+			def.value = jsonVec3(f, "value", def.value);
+			def.value2 = jsonVec3(f, "value2", def.value2);
+			def.magnitude = f.value("magnitude", def.magnitude);
+			def.height = f.value("height", def.height);
+			shared_ptr<ParticleForce> force = makeForce(def);
+			if (force) {
+				e.forceDefs.push_back(def);
+				e.forces.push_back(force);
+			}
+		}
+	}
+
+	// budgets: a group can't be more than all effects may spawn in a
+	// frame, and the pool is the worst case number alive at once -- one-shot
+	// effects can be retriggered every frame, so assume 60 groups a
+	// second for those
+	//
+	if (e.groupSize > maxSpawnPerFrame) {
+		cout << "effects: " << name << " groupSize " << e.groupSize << " clamped to " << maxSpawnPerFrame << endl;
+		e.groupSize = maxSpawnPerFrame;
+	}
+	float maxLife = e.randomLife ? MAX(e.lifeRange.x, e.lifeRange.y) : e.lifespan;
+	float groupsPerSec = e.oneShot ? 60 : e.rate;
+	int pool = e.groupSize * ((int)ceil(maxLife * groupsPerSec) + 1);
+	int cap = MIN(j.value("maxParticles", maxParticles), maxParticles);
+	e.poolSize = MAX(1, MIN(pool, cap));
+	return e;
+}
+
+// configure an emitter (and its particle system) from a compiled effect
+//
+void EffectConfig::apply(ParticleEmitter & emitter) const {
+	emitter.setEmitterType(type);
+	emitter.setRate(rate);
+	emitter.setGroupSize(groupSize);
+	emitter.setLifespan(lifespan);
+	emitter.setRandomLife(randomLife);
+	emitter.setLifespanRange(lifeRange);
+	emitter.setVelocity(velocity);
+	emitter.radius = radius;
+	emitter.setParticleRadius(particleRadius);
+	emitter.setParticleColor(color);
+	emitter.setMass(mass);
+	emitter.setDamping(damping);
+	emitter.setOneShot(oneShot);
+	emitter.maxParticles = poolSize;
+
+	ParticleSystem *sys = emitter.sys;
+	sys->restitution = restitution;
+	sys->killOnCollide = killOnCollide;
+	sys->clearForces();
+	for (int i = 0; i < forces.size(); i++)
+		sys->addForce(forces[i]);
+	if (sys->stream.capacity != poolSize || sys->pointSize != pointSize)
+		sys->setupVbo(poolSize, pointSize);
+}
+
+// load and compile all effects in "path" (relative to the data dir).
+// On any error the previously loaded effects are kept.
+//
+bool EffectLibrary::load(const string & p) {
+	path = p;
+	lastChecked = ofGetElapsedTimeMillis();
+	std::error_code ec;
+	lastWriteTime = std::filesystem::last_write_time(ofToDataPath(path, true), ec);
+
+	ofJson json = ofLoadJson(path);
+	if (json.is_null() || !json.count("effects")) {
+		cout << "Effects File: " << path << " not found or invalid" << endl;
+		return false;
+	}
+
+	// nothing is assigned until every effect has compiled, so a bad file
+	// leaves the budgets and effects as they were
+	//
+	try {
+		int particles = maxParticles;
+		int spawnPerFrame = maxSpawnPerFrame;
+		if (json.count("budget")) {
+			particles = json["budget"].value("maxParticles", particles);
+			spawnPerFrame = json["budget"].value("maxSpawnPerFrame", spawnPerFrame);
+		}
+		map<string, EffectConfig> compiled;
+		for (auto it = json["effects"].begin(); it != json["effects"].end(); it++) {
+			compiled[it.key()] = compile(it.key(), it.value(), particles, spawnPerFrame);
+		}
+		effects.swap(compiled);
+		maxParticles = particles;
+		maxSpawnPerFrame = spawnPerFrame;
+		spawnBudget.maxPerFrame = spawnPerFrame;
+	}
+	catch (std::exception & e) {
+		cout << "Effects File: " << path << ": " << e.what() << endl;
+		return false;
+	}
+	return true;
+}
+
+// poll the effects file and reload it if it changed on disk.  Returns
+// true if new effects were loaded and should be re-applied.  Systems
+// share ownership of the forces applied to them, so dropping the old
+// definitions doesn't leave them pointing at freed forces.
+//
+bool EffectLibrary::update() {
+	if (path.empty()) return false;
+	float time = ofGetElapsedTimeMillis();
+	if (time - lastChecked < reloadInterval) return false;
+	lastChecked = time;
+
+	std::error_code ec;
+	auto writeTime = std::filesystem::last_write_time(ofToDataPath(path, true), ec);
+	if (ec || writeTime == lastWriteTime) return false;
+
+	cout << "Effects File: " << path << " changed, reloading" << endl;
+	return load(path);
+}
+
+const EffectConfig * EffectLibrary::get(const string & name) const {
+	auto it = effects.find(name);
+	if (it == effects.end()) return NULL;
+	return &it->second;
+}
+
+bool EffectLibrary::apply(const string & name, ParticleEmitter & emitter) {
+	const EffectConfig *e = get(name);
+	if (e == NULL) {
+		cout << "effects: no effect named \"" << name << "\"" << endl;
+		return false;
+	}
+	e->apply(emitter);
+	emitter.spawnBudget = &spawnBudget;
+	return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleEmitter.h"
+
+//  Data-driven particle effects.
+//
+//  Effects are defined in a json file in the data directory, e.g.
+//
+//    {
+//      "budget": { "maxParticles": 8192, "maxSpawnPerFrame": 2000 },
+//      "effects": {
+//        "exhaust": { "type": "disc", "groupSize": 250, "lifespan": 0.25,
+//                     "velocity": [0, -25, 0], "color": [255, 0, 0],
+//                     "forces": [ { "type": "gravity", "value": [0, -2, 0] } ] }
+//      }
+//    }
+//
+//  Each definition is compiled once into an EffectConfig with its pool
+//  size and force objects already worked out, so applying it to an emitter
+//  is just a handful of setters.  Pools are clamped to maxParticles at
+//  compile time.  maxSpawnPerFrame is one SpawnBudget that every emitter
+//  the library configures draws from, so all effects together spawn no
+//  more than that in a frame.
+//
+//  Radial and sphere emitters throw particles every way at "speed"; a
+//  "velocity" only has a direction for directional and disc emitters.
+//
+
+// one force in an effect's force list
+//
+class ForceConfig {
+public:
+	string type;			// gravity, turbulence, impulse, cyclic
+	ofVec3f value;			// gravity vector or turbulence min
+	ofVec3f value2;			// turbulence max
+	float magnitude = 0;	// impulse, cyclic
+	float height = .2;		// impulse
+};
+
+class EffectConfig {
+public:
+	void apply(ParticleEmitter & emitter) const;
+
+	string name;
+	EmitterType type = DirectionalEmitter;
+	float rate = 1;
+	int groupSize = 1;
+	float lifespan = 3;
+	bool randomLife = false;
+	ofVec2f lifeRange = ofVec2f(2, 4);
+	ofVec3f velocity = ofVec3f(0, 20, 0);
+	float radius = 1;
+	float particleRadius = .1;
+	ofColor color = ofColor::aquamarine;
+	float mass = 1;
+	float damping = .99;
+	bool oneShot = false;
+	float pointSize = 5;
+	float restitution = .3;
+	bool killOnCollide = false;
+	vector<ForceConfig> forceDefs;
+
+	// precomputed at compile time
+	//
+	int poolSize = 0;							// most particles ever alive at once
+	vector<shared_ptr<ParticleForce>> forces;	// built from forceDefs
+};
+
+class EffectLibrary {
+public:
+	bool load(const string & path);
+	bool update();
+	bool apply(const string & name, ParticleEmitter & emitter);
+	const EffectConfig * get(const string & name) const;
+
+	string path;
+	map<string, EffectConfig> effects;
+
+	// budgets every effect is held to
+	//
+	int maxParticles = 8192;
+	int maxSpawnPerFrame = 2000;
+	SpawnBudget spawnBudget;		// shared by every emitter apply() configures
+
+	// hot reload; the file is polled for changes every reloadInterval ms
+	//
+	float reloadInterval = 1000;
+	float lastChecked = 0;
+	std::filesystem::file_time_type lastWriteTime;
+};
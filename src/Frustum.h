@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ofMain.h"
+#include "box.h"
+
+//  View frustum as six planes, extracted from a combined
+//  projection * view (* model) matrix (Gribb & Hartmann).
+//  Plane normals point into the frustum, so a point p is inside a
+//  plane when dot(n, p) + d >= 0.
+//
+class Frustum {
+public:
+	enum { Outside = 0, Intersects, Inside };
+
+	Frustum() { }
+	Frustum(const glm::mat4 & m) { set(m); }
+
+	void set(const glm::mat4 & m) {
+		// glm is column major, so row i of m is (m[0][i], m[1][i], m[2][i], m[3][i])
+		//
+		for (int i = 0; i < 3; i++) {
+			for (int k = 0; k < 2; k++) {
+				float s = (k == 0) ? 1.0f : -1.0f;
+				glm::vec4 & p = planes[i * 2 + k];
+				p.x = m[0][3] + s * m[0][i];
+				p.y = m[1][3] + s * m[1][i];
+				p.z = m[2][3] + s * m[2][i];
+				p.w = m[3][3] + s * m[3][i];
+				float len = sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+				if (len > 0) {
+					p.x /= len; p.y /= len; p.z /= len; p.w /= len;
+				}
+			}
+		}
+	}
+
+	// classify a box against the frustum using the box corners nearest
+	// and farthest along each plane normal
+	//
+	int classify(const Box & box) const {
+		const Vector3 & min = box.parameters[0];
+		const Vector3 & max = box.parameters[1];
+		int result = Inside;
+		for (int i = 0; i < 6; i++) {
+			const glm::vec4 & p = planes[i];
+			float px = p.x >= 0 ? max.x() : min.x();
+			float py = p.y >= 0 ? max.y() : min.y();
+			float pz = p.z >= 0 ? max.z() : min.z();
+			if (p.x * px + p.y * py + p.z * pz + p.w < 0) return Outside;
+
+			float nx = p.x >= 0 ? min.x() : max.x();
+			float ny = p.y >= 0 ? min.y() : max.y();
+			float nz = p.z >= 0 ? min.z() : max.z();
+			if (p.x * nx + p.y * ny + p.z * nz + p.w < 0) result = Intersects;
+		}
+		return result;
+	}
+
+	glm::vec4 planes[6];	// left, right, bottom, top, near, far
+};
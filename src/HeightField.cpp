@@ -0,0 +1,378 @@
+
+#include "HeightField.h"
+
+HeightField::HeightField() {
+	res = 0;
+	cellWidth = 0;
+	cellDepth = 0;
+}
+
+// Bake the height map from the octree's copy of the terrain mesh.
+// "resolution" is the number of cells along each of x and z.
+//
+void HeightField::create(const Octree & octree, int resolution) {
+	const ofMesh & mesh = octree.mesh;
+	res = resolution;
+	bounds = octree.root.box;
+	cellWidth = (bounds.parameters[1].x() - bounds.parameters[0].x()) / res;
+	cellDepth = (bounds.parameters[1].z() - bounds.parameters[0].z()) / res;
+
+	float ground = bounds.parameters[0].y();
+	heights.assign(res * res, ground);
+	vector<bool> filled(res * res, false);
+
+	// every vertex in the tree lives in the root's point list, or, for
+	// a compacted tree loaded from disk, which has no point lists, in the
+	// mesh
+	//
+	const vector<int> & points = octree.root.points;
+	int numPoints = points.empty() ? mesh.getNumVertices() : points.size();
+	for (int n = 0; n < numPoints; n++) {
+		ofVec3f v = mesh.getVertex(points.empty() ? n : points[n]);
+		int i, k;
+		cellCoords(v.x, v.z, i, k);
+		int c = cellIndex(i, k);
+		if (!filled[c] || v.y > heights[c]) {
+			heights[c] = v.y;
+			filled[c] = true;
+		}
+	}
+
+	// cells finer than the mesh spacing won't have any vertex in them,
+	// so grow the filled region into the holes from its neighbors
+	//
+	bool holes = true;
+	for (int pass = 0; pass < res && holes; pass++) {
+		holes = false;
+		vector<bool> next = filled;
+		for (int k = 0; k < res; k++) {
+			for (int i = 0; i < res; i++) {
+				int c = cellIndex(i, k);
+				if (filled[c]) continue;
+				float sum = 0;
+				int count = 0;
+				if (i > 0 && filled[c - 1]) { sum += heights[c - 1]; count++; }
+				if (i < res - 1 && filled[c + 1]) { sum += heights[c + 1]; count++; }
+				if (k > 0 && filled[c - res]) { sum += heights[c - res]; count++; }
+				if (k < res - 1 && filled[c + res]) { sum += heights[c + res]; count++; }
+				if (count > 0) {
+					heights[c] = sum / count;
+					next[c] = true;
+				}
+				else holes = true;
+			}
+		}
+		filled = next;
+	}
+
+	normals.assign(res * res, ofVec3f(0, 1, 0));
+	for (int k = 0; k < res; k++)
+		for (int i = 0; i < res; i++)
+			computeNormal(i, k);
+
+	createTriangles(mesh);
+}
+
+// normal by central differences of the neighboring cell heights
+//
+void HeightField::computeNormal(int i, int k) {
+	float hl = heights[cellIndex(MAX(i - 1, 0), k)];
+	float hr = heights[cellIndex(MIN(i + 1, res - 1), k)];
+	float hb = heights[cellIndex(i, MAX(k - 1, 0))];
+	float hf = heights[cellIndex(i, MIN(k + 1, res - 1))];
+	ofVec3f n((hl - hr) / (2 * cellWidth), 1, (hb - hf) / (2 * cellDepth));
+	normals[cellIndex(i, k)] = n.getNormalized();
+}
+
+// Refresh the cells under the x/z rectangle min to max after the mesh's
+// vertices there moved up or down.  Vertices must only have moved in y,
+// so every triangle stays in the same cells and only the heights, the
+// height ranges and the overhang flags change
+//
+void HeightField::update(const ofMesh & mesh, float minX, float minZ, float maxX, float maxZ) {
+	if (res == 0) return;
+	int i0, k0, i1, k1;
+	cellCoords(minX, minZ, i0, k0);
+	cellCoords(maxX, maxZ, i1, k1);
+
+	// re-read the corners of the triangles over the rectangle; they can
+	// reach into cells outside it, which need refreshing too
+	//
+	bool indexed = mesh.getNumIndices() > 0;
+	int ei0 = i0, ek0 = k0, ei1 = i1, ek1 = k1;
+	for (int k = k0; k <= k1; k++) {
+		for (int i = i0; i <= i1; i++) {
+			int c = cellIndex(i, k);
+			for (int n = cellStart[c]; n < cellStart[c + 1]; n++) {
+				int t = cellTris[n];
+				glm::vec3 * v = &triVerts[t * 3];
+				for (int j = 0; j < 3; j++)
+					v[j] = mesh.getVertex(indexed ? mesh.getIndex(t * 3 + j) : t * 3 + j);
+				int ti0, tk0, ti1, tk1;
+				cellCoords(MIN(MIN(v[0].x, v[1].x), v[2].x), MIN(MIN(v[0].z, v[1].z), v[2].z), ti0, tk0);
+				cellCoords(MAX(MAX(v[0].x, v[1].x), v[2].x), MAX(MAX(v[0].z, v[1].z), v[2].z), ti1, tk1);
+				ei0 = MIN(ei0, ti0);
+				ek0 = MIN(ek0, tk0);
+				ei1 = MAX(ei1, ti1);
+				ek1 = MAX(ek1, tk1);
+			}
+		}
+	}
+
+	// highest vertex in each cell, or the ground at the cell's center
+	// for cells too small to hold a vertex
+	//
+	for (int k = ek0; k <= ek1; k++) {
+		for (int i = ei0; i <= ei1; i++) {
+			int c = cellIndex(i, k);
+			bool filled = false;
+			for (int n = cellStart[c]; n < cellStart[c + 1]; n++) {
+				const glm::vec3 * v = &triVerts[cellTris[n] * 3];
+				for (int j = 0; j < 3; j++) {
+					int vi, vk;
+					cellCoords(v[j].x, v[j].z, vi, vk);
+					if (vi != i || vk != k) continue;
+					if (!filled || v[j].y > heights[c]) heights[c] = v[j].y;
+					filled = true;
+				}
+			}
+			float h;
+			ofVec3f nrm;
+			if (!filled && getGround(bounds.parameters[0].x() + (i + .5) * cellWidth,
+				bounds.parameters[0].z() + (k + .5) * cellDepth, h, nrm))
+				heights[c] = h;
+		}
+	}
+
+	// height ranges and overhangs, as createTriangles() works them out
+	//
+	for (int k = ek0; k <= ek1; k++) {
+		for (int i = ei0; i <= ei1; i++) {
+			int c = cellIndex(i, k);
+			minHeights[c] = maxHeights[c] = heights[c];
+			overhang[c] = false;
+			for (int n = cellStart[c]; n < cellStart[c + 1]; n++) {
+				const glm::vec3 * v = &triVerts[cellTris[n] * 3];
+				float ymin = MIN(MIN(v[0].y, v[1].y), v[2].y);
+				float ymax = MAX(MAX(v[0].y, v[1].y), v[2].y);
+				if (n == cellStart[c]) {
+					minHeights[c] = ymin;
+					maxHeights[c] = ymax;
+				}
+				else {
+					minHeights[c] = MIN(minHeights[c], ymin);
+					maxHeights[c] = MAX(maxHeights[c], ymax);
+				}
+				glm::vec3 nrm = glm::cross(v[1] - v[0], v[2] - v[0]);
+				float len = glm::length(nrm);
+				if (len > 0 && nrm.y * up < 0.05 * len) overhang[c] = true;
+			}
+		}
+	}
+
+	for (int k = MAX(ek0 - 1, 0); k <= MIN(ek1 + 1, res - 1); k++)
+		for (int i = MAX(ei0 - 1, 0); i <= MIN(ei1 + 1, res - 1); i++)
+			computeNormal(i, k);
+}
+
+// Bin the mesh triangles into the cells their x/z bounds cover.  This
+// is a counting sort, so each cell's list is one contiguous range.
+//
+void HeightField::createTriangles(const ofMesh & mesh) {
+	bool indexed = mesh.getNumIndices() > 0;
+	int numTris = (indexed ? mesh.getNumIndices() : mesh.getNumVertices()) / 3;
+	triVerts.resize(numTris * 3);
+	for (int t = 0; t < numTris; t++) {
+		for (int k = 0; k < 3; k++) {
+			int v = indexed ? mesh.getIndex(t * 3 + k) : t * 3 + k;
+			triVerts[t * 3 + k] = mesh.getVertex(v);
+		}
+	}
+
+	// the winding of the terrain isn't known, so "up" is whichever
+	// side most of the (area weighted) face normals point to
+	//
+	up = 0;
+	for (int t = 0; t < numTris; t++) {
+		const glm::vec3 * v = &triVerts[t * 3];
+		up += glm::cross(v[1] - v[0], v[2] - v[0]).y;
+	}
+	up = (up < 0) ? -1 : 1;
+
+	int numCells = res * res;
+	cellStart.assign(numCells + 1, 0);
+	minHeights = heights;
+	maxHeights = heights;
+	overhang.assign(numCells, false);
+	vector<bool> touched(numCells, false);
+	vector<int> next;
+
+	// pass 0 counts triangles per cell, pass 1 scatters them
+	//
+	for (int pass = 0; pass < 2; pass++) {
+		for (int t = 0; t < numTris; t++) {
+			const glm::vec3 * v = &triVerts[t * 3];
+			int i0, k0, i1, k1;
+			cellCoords(MIN(MIN(v[0].x, v[1].x), v[2].x), MIN(MIN(v[0].z, v[1].z), v[2].z), i0, k0);
+			cellCoords(MAX(MAX(v[0].x, v[1].x), v[2].x), MAX(MAX(v[0].z, v[1].z), v[2].z), i1, k1);
+
+			float ymin = MIN(MIN(v[0].y, v[1].y), v[2].y);
+			float ymax = MAX(MAX(v[0].y, v[1].y), v[2].y);
+			glm::vec3 n = glm::cross(v[1] - v[0], v[2] - v[0]);
+			float len = glm::length(n);
+			bool steep = len > 0 && n.y * up < 0.05 * len;	// near vertical or facing down
+
+			for (int k = k0; k <= k1; k++) {
+				for (int i = i0; i <= i1; i++) {
+					int c = cellIndex(i, k);
+					if (pass == 1) {
+						cellTris[next[c]++] = t;
+						continue;
+					}
+					cellStart[c + 1]++;
+					if (!touched[c]) {
+						minHeights[c] = ymin;
+						maxHeights[c] = ymax;
+						touched[c] = true;
+					}
+					else {
+						minHeights[c] = MIN(minHeights[c], ymin);
+						maxHeights[c] = MAX(maxHeights[c], ymax);
+					}
+					if (steep) overhang[c] = true;
+				}
+			}
+		}
+		if (pass == 0) {
+			for (int c = 0; c < numCells; c++)
+				cellStart[c + 1] += cellStart[c];
+			cellTris.resize(cellStart[numCells]);
+			next.assign(cellStart.begin(), cellStart.end() - 1);
+		}
+	}
+}
+
+bool HeightField::inBounds(float x, float z) const {
+	return res > 0 &&
+		x >= bounds.parameters[0].x() && x <= bounds.parameters[1].x() &&
+		z >= bounds.parameters[0].z() && z <= bounds.parameters[1].z();
+}
+
+// return the (clamped) cell containing x/z
+//
+void HeightField::cellCoords(float x, float z, int & i, int & k) const {
+	i = (int)((x - bounds.parameters[0].x()) / cellWidth);
+	k = (int)((z - bounds.parameters[0].z()) / cellDepth);
+	i = ofClamp(i, 0, res - 1);
+	k = ofClamp(k, 0, res - 1);
+}
+
+// terrain height at x/z, bilinearly interpolated between cell centers
+//
+float HeightField::getHeight(float x, float z) const {
+	float fx = (x - bounds.parameters[0].x()) / cellWidth - 0.5;
+	float fz = (z - bounds.parameters[0].z()) / cellDepth - 0.5;
+	fx = ofClamp(fx, 0, res - 1);
+	fz = ofClamp(fz, 0, res - 1);
+	int i0 = (int)fx;
+	int k0 = (int)fz;
+	int i1 = MIN(i0 + 1, res - 1);
+	int k1 = MIN(k0 + 1, res - 1);
+	float tx = fx - i0;
+	float tz = fz - k0;
+	float h0 = heights[cellIndex(i0, k0)] * (1 - tx) + heights[cellIndex(i1, k0)] * tx;
+	float h1 = heights[cellIndex(i0, k1)] * (1 - tx) + heights[cellIndex(i1, k1)] * tx;
+	return h0 * (1 - tz) + h1 * tz;
+}
+
+ofVec3f HeightField::getNormal(float x, float z) const {
+	int i, k;
+	cellCoords(x, z, i, k);
+	return normals[cellIndex(i, k)];
+}
+
+// highest any triangle in x/z's cell reaches
+//
+float HeightField::maxHeight(float x, float z) const {
+	int i, k;
+	cellCoords(x, z, i, k);
+	return maxHeights[cellIndex(i, k)];
+}
+
+// Exact ground height and surface normal at x/z from the triangles in
+// its cell.  If more than one triangle covers x/z the highest wins.
+// Returns false outside the terrain or where no triangle covers x/z.
+//
+bool HeightField::getGround(float x, float z, float & heightRtn, ofVec3f & normalRtn) const {
+	if (!inBounds(x, z)) return false;
+	int i, k;
+	cellCoords(x, z, i, k);
+	int c = cellIndex(i, k);
+	bool found = false;
+	for (int n = cellStart[c]; n < cellStart[c + 1]; n++) {
+		const glm::vec3 * v = &triVerts[cellTris[n] * 3];
+
+		// barycentric coordinates of x/z in the triangle's footprint
+		//
+		float d = (v[1].z - v[2].z) * (v[0].x - v[2].x) + (v[2].x - v[1].x) * (v[0].z - v[2].z);
+		if (fabs(d) < 1.0e-12) continue;		// vertical, no footprint
+		float a = ((v[1].z - v[2].z) * (x - v[2].x) + (v[2].x - v[1].x) * (z - v[2].z)) / d;
+		float b = ((v[2].z - v[0].z) * (x - v[2].x) + (v[0].x - v[2].x) * (z - v[2].z)) / d;
+		float g = 1 - a - b;
+		const float eps = -1.0e-5;
+		if (a < eps || b < eps || g < eps) continue;
+
+		float y = a * v[0].y + b * v[1].y + g * v[2].y;
+		if (!found || y > heightRtn) {
+			glm::vec3 nrm = glm::normalize(glm::cross(v[1] - v[0], v[2] - v[0]));
+			if (nrm.y < 0) nrm = -nrm;
+			heightRtn = y;
+			normalRtn = ofVec3f(nrm.x, nrm.y, nrm.z);
+			found = true;
+		}
+	}
+	return found;
+}
+
+// angle of the ground at x/z from horizontal, in degrees
+//
+float HeightField::getSlope(float x, float z) const {
+	float h;
+	ofVec3f n;
+	if (!getGround(x, z, h, n)) n = getNormal(x, z);
+	return ofRadToDeg(acos(ofClamp(n.y, -1, 1)));
+}
+
+bool HeightField::isOverhang(float x, float z) const {
+	if (!inBounds(x, z)) return false;
+	int i, k;
+	cellCoords(x, z, i, k);
+	return overhang[cellIndex(i, k)];
+}
+
+// Highest the ground can be anywhere under the box's x/z footprint.
+// Conservative, since each cell keeps the full height range of its
+// triangles.  Returns false if the box is off the terrain or over an
+// overhang, where only the Octree can answer.
+//
+bool HeightField::maxHeightIn(const Box & box, float & maxRtn) const {
+	const Vector3 & min = box.parameters[0];
+	const Vector3 & max = box.parameters[1];
+	if (res == 0 ||
+		max.x() < bounds.parameters[0].x() || min.x() > bounds.parameters[1].x() ||
+		max.z() < bounds.parameters[0].z() || min.z() > bounds.parameters[1].z())
+		return false;
+
+	int i0, k0, i1, k1;
+	cellCoords(min.x(), min.z(), i0, k0);
+	cellCoords(max.x(), max.z(), i1, k1);
+	maxRtn = maxHeights[cellIndex(i0, k0)];
+	for (int k = k0; k <= k1; k++) {
+		for (int i = i0; i <= i1; i++) {
+			int c = cellIndex(i, k);
+			if (overhang[c]) return false;
+			maxRtn = MAX(maxRtn, maxHeights[c]);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+
+//  Coarse 2.5D height map of the terrain, baked from the Octree's mesh.
+//
+//  The x/z extent of the octree root box is split into a res x res grid
+//  and each cell keeps the highest terrain vertex that falls inside it,
+//  plus a surface normal estimated from the neighboring cells.  Lookups
+//  are constant time, which is what lets thousands of particles test
+//  against the ground every frame.
+//
+//  For exact queries each cell also keeps the list of mesh triangles
+//  whose x/z footprint touches it and the range of heights they span.
+//  getGround() only has to test the handful of triangles in one cell.
+//  Cells touched by a vertical or downward facing triangle can have more
+//  than one surface above the same x/z; those are flagged as overhangs
+//  and the caller should ask the Octree instead.
+//
+//  Pure Virtual Class - the ground the particles bounce off: one
+//  HeightField, or the resident tiles of a tiled map (TerrainTiles).
+//  maxHeight() is an upper bound that rules contact out in constant
+//  time; getGround() is the exact surface that confirms it.
+//
+class HeightSource {
+public:
+	virtual bool isCreated() const = 0;
+	virtual bool inBounds(float x, float z) const = 0;
+	virtual float getHeight(float x, float z) const = 0;
+	virtual ofVec3f getNormal(float x, float z) const = 0;
+	virtual float maxHeight(float x, float z) const = 0;		// no ground at x/z is above this
+	virtual bool getGround(float x, float z, float & heightRtn, ofVec3f & normalRtn) const = 0;
+	virtual float stepSize() const = 0;		// a long segment is tested in steps this long
+};
+
+class HeightField : public HeightSource {
+public:
+	HeightField();
+	void create(const Octree & octree, int resolution);
+	void update(const ofMesh & mesh, float minX, float minZ, float maxX, float maxZ);
+	bool inBounds(float x, float z) const;
+	float getHeight(float x, float z) const;
+	ofVec3f getNormal(float x, float z) const;
+	float maxHeight(float x, float z) const;
+	bool isCreated() const { return res > 0; }
+	float stepSize() const { return MIN(cellWidth, cellDepth); }
+
+	// exact queries against the mesh triangles
+	//
+	bool getGround(float x, float z, float & heightRtn, ofVec3f & normalRtn) const;
+	float getSlope(float x, float z) const;
+	bool isOverhang(float x, float z) const;
+
+	// upper bound on the ground under a box, for ruling contact out early
+	//
+	bool maxHeightIn(const Box & box, float & maxRtn) const;
+
+	int cellIndex(int i, int k) const { return k * res + i; }
+	void cellCoords(float x, float z, int & i, int & k) const;
+
+	Box bounds;
+	int res;
+	float cellWidth, cellDepth;
+	vector<float> heights;
+	vector<ofVec3f> normals;
+
+	// triangles of cell c are cellTris[cellStart[c]] .. cellTris[cellStart[c + 1] - 1]
+	//
+	vector<int> cellStart;
+	vector<int> cellTris;
+	vector<glm::vec3> triVerts;		// 3 corners per triangle
+	vector<float> minHeights;		// height range of the triangles in each cell
+	vector<float> maxHeights;
+	vector<bool> overhang;
+	float up = 1;					// sign of y on the terrain's upward faces
+
+private:
+	void createTriangles(const ofMesh & mesh);
+	void computeNormal(int i, int k);
+};
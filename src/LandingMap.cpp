@@ -0,0 +1,280 @@
+
+#include "LandingMap.h"
+#include "Profiler.h"
+
+void LandingWorker::threadedFunction() {
+	Profiler::get().setThreadName("landing map");
+	int job;
+	while (map->work.receive(job)) {
+		map->scoreRows(*map->jobOctree);
+		map->done.send(job);
+	}
+}
+
+// grow the pool to numThreads workers
+//
+void LandingMap::startWorkers(int numThreads) {
+	while (workers.size() < numThreads) {
+		workers.push_back(make_shared<LandingWorker>());
+		workers.back()->map = this;
+		workers.back()->startThread();
+	}
+}
+
+void LandingMap::stopWorkers() {
+	work.close();
+	for (int t = 0; t < workers.size(); t++)
+		workers[t]->waitForThread(true);
+	workers.clear();
+}
+
+// Score every cell of a resolution x resolution grid over the octree's
+// x/z extent, on numThreads threads (the calling thread if 0)
+//
+void LandingMap::create(const Octree & octree, int resolution, int numThreads) {
+	PROFILE_SCOPE("landing/create");
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	res = resolution;
+	bounds = octree.root.box;
+	numVertices = octree.mesh.getNumVertices();
+	cellWidth = (bounds.max().x() - bounds.min().x()) / res;
+	cellDepth = (bounds.max().z() - bounds.min().z()) / res;
+	cells.assign(res * res, LandingCell());
+
+	nextRow = 0;
+	if (numThreads <= 0)
+		scoreRows(octree);
+	else {
+		startWorkers(numThreads);
+		jobOctree = &octree;
+		for (int t = 0; t < numThreads; t++)
+			work.send(t);
+		for (int t = 0; t < numThreads; t++) {
+			int job;
+			done.receive(job);
+		}
+	}
+	meshDirty = true;
+	buildTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+}
+
+// rows are handed out one at a time so threads that get flat rows (few
+// points) don't sit idle while others finish
+//
+void LandingMap::scoreRows(const Octree & octree) {
+	vector<int> points;
+	for (int k = nextRow++; k < res; k = nextRow++)
+		for (int i = 0; i < res; i++)
+			scoreCell(octree, i, k, points);
+}
+
+// Fit a plane y = a x + b z + c to the vertices over cell i, k, and
+// measure the cell against it
+//
+void LandingMap::scoreCell(const Octree & octree, int i, int k, vector<int> & pointsRtn) {
+	LandingCell & cell = cells[k * res + i];
+	cell = LandingCell();
+	float x0 = bounds.min().x() + (i - 0.5f) * cellWidth;
+	float z0 = bounds.min().z() + (k - 0.5f) * cellDepth;
+	Box probe(Vector3(x0, bounds.min().y(), z0), Vector3(x0 + 2 * cellWidth, bounds.max().y(), z0 + 2 * cellDepth));
+	int n = octree.pointsInBox(probe, pointsRtn);
+	cell.numPoints = n;
+	if (n < 3) return;
+
+	// centered sums, in double since the terrain can be far from the
+	// origin
+	//
+	const glm::vec3 *verts = octree.mesh.getVertices().data();
+	double mx = 0, my = 0, mz = 0;
+	float lo = FLT_MAX, hi = -FLT_MAX;
+	for (int p = 0; p < n; p++) {
+		const glm::vec3 & v = verts[pointsRtn[p]];
+		mx += v.x;
+		my += v.y;
+		mz += v.z;
+		lo = MIN(lo, v.y);
+		hi = MAX(hi, v.y);
+	}
+	mx /= n;
+	my /= n;
+	mz /= n;
+	double sxx = 0, szz = 0, sxz = 0, sxy = 0, szy = 0;
+	for (int p = 0; p < n; p++) {
+		const glm::vec3 & v = verts[pointsRtn[p]];
+		double dx = v.x - mx, dy = v.y - my, dz = v.z - mz;
+		sxx += dx * dx;
+		szz += dz * dz;
+		sxz += dx * dz;
+		sxy += dx * dy;
+		szy += dz * dy;
+	}
+	double det = sxx * szz - sxz * sxz;
+	if (det <= 1e-12 * sxx * szz) {		// points on a line, no plane
+		cell.numPoints = 0;
+		return;
+	}
+	double a = (sxy * szz - szy * sxz) / det;
+	double b = (szy * sxx - sxy * sxz) / det;
+
+	double sumSq = 0;
+	for (int p = 0; p < n; p++) {
+		const glm::vec3 & v = verts[pointsRtn[p]];
+		double r = (v.y - my) - a * (v.x - mx) - b * (v.z - mz);
+		sumSq += r * r;
+	}
+	cell.slope = ofRadToDeg(atan(sqrt(a * a + b * b)));
+	cell.roughness = sqrt(sumSq / n);
+	cell.spread = hi - lo;
+	float cx = bounds.min().x() + (i + 0.5f) * cellWidth;
+	float cz = bounds.min().z() + (k + 0.5f) * cellDepth;
+	cell.height = my + a * (cx - mx) + b * (cz - mz);
+	cell.score = score(cell);
+}
+
+float LandingMap::score(const LandingCell & cell) const {
+	if (cell.numPoints < 3) return 0;
+	float s = ofClamp(1 - cell.slope / maxSlope, 0, 1);
+	s *= ofClamp(1 - cell.roughness / maxRoughness, 0, 1);
+	s *= ofClamp(1 - cell.spread / maxSpread, 0, 1);
+	return s;
+}
+
+void LandingMap::rescore() {
+	for (int c = 0; c < cells.size(); c++)
+		cells[c].score = score(cells[c]);
+	meshDirty = true;
+}
+
+// Re-score the cells under region, after the terrain there changed
+//
+void LandingMap::update(const Octree & octree, const Box & region) {
+	if (!isCreated()) return;
+	int i0 = ofClamp(floor((region.min().x() - bounds.min().x()) / cellWidth) - 1, 0, res - 1);
+	int i1 = ofClamp(floor((region.max().x() - bounds.min().x()) / cellWidth) + 1, 0, res - 1);
+	int k0 = ofClamp(floor((region.min().z() - bounds.min().z()) / cellDepth) - 1, 0, res - 1);
+	int k1 = ofClamp(floor((region.max().z() - bounds.min().z()) / cellDepth) + 1, 0, res - 1);
+	vector<int> points;
+	for (int k = k0; k <= k1; k++)
+		for (int i = i0; i <= i1; i++)
+			scoreCell(octree, i, k, points);
+	meshDirty = true;
+}
+
+// The cell under x, z, or NULL off the map
+//
+const LandingCell * LandingMap::cellAt(float x, float z) const {
+	if (!isCreated()) return NULL;
+	int i = floor((x - bounds.min().x()) / cellWidth);
+	int k = floor((z - bounds.min().z()) / cellDepth);
+	if (i < 0 || i >= res || k < 0 || k >= res) return NULL;
+	return &cells[k * res + i];
+}
+
+float LandingMap::getScore(float x, float z) const {
+	const LandingCell *cell = cellAt(x, z);
+	return cell ? cell->score : 0;
+}
+
+// The worst score under the x/z footprint of box; a lander is only as
+// well supported as its worst leg
+//
+float LandingMap::scoreArea(const Box & box) const {
+	if (!isCreated()) return 0;
+	int i0 = floor((box.min().x() - bounds.min().x()) / cellWidth);
+	int i1 = floor((box.max().x() - bounds.min().x()) / cellWidth);
+	int k0 = floor((box.min().z() - bounds.min().z()) / cellDepth);
+	int k1 = floor((box.max().z() - bounds.min().z()) / cellDepth);
+	if (i0 < 0 || i1 >= res || k0 < 0 || k1 >= res) return 0;
+	float s = 1;
+	for (int k = k0; k <= k1; k++)
+		for (int i = i0; i <= i1; i++)
+			s = MIN(s, cells[k * res + i].score);
+	return s;
+}
+
+// Draw the cells scoring at least minScore as quads just over the
+// terrain, from yellow (minScore) to green (1)
+//
+void LandingMap::draw(float minScore) {
+	if (!isCreated()) return;
+	if (meshDirty) {
+		mesh.clear();
+		mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+		float lift = (bounds.max().y() - bounds.min().y()) * 0.002;
+		for (int k = 0; k < res; k++) {
+			for (int i = 0; i < res; i++) {
+				const LandingCell & cell = cells[k * res + i];
+				if (cell.score < minScore || cell.score <= 0) continue;
+				float x = bounds.min().x() + i * cellWidth;
+				float z = bounds.min().z() + k * cellDepth;
+				float y = cell.height + lift;
+				ofIndexType base = mesh.getNumVertices();
+				mesh.addVertex(glm::vec3(x, y, z));
+				mesh.addVertex(glm::vec3(x + cellWidth, y, z));
+				mesh.addVertex(glm::vec3(x + cellWidth, y, z + cellDepth));
+				mesh.addVertex(glm::vec3(x, y, z + cellDepth));
+				float t = minScore < 1 ? (cell.score - minScore) / (1 - minScore) : 1;
+				ofFloatColor color = ofFloatColor::yellow.getLerped(ofFloatColor::green, t);
+				color.a = 0.35;
+				for (int c = 0; c < 4; c++)
+					mesh.addColor(color);
+				mesh.addIndex(base);
+				mesh.addIndex(base + 1);
+				mesh.addIndex(base + 2);
+				mesh.addIndex(base);
+				mesh.addIndex(base + 2);
+				mesh.addIndex(base + 3);
+			}
+		}
+		meshDirty = false;
+	}
+	mesh.draw();
+}
+
+// Read a map cached by save().  Fails if the file is missing, another
+// version, or was built from a different mesh or resolution
+//
+bool LandingMap::load(const string & path, const Octree & octree, int resolution) {
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	ifstream in(ofToDataPath(path, true), ios::binary);
+	LandingMapHeader h;
+	if (!in.read((char *)&h, sizeof(h))) return false;
+	if (strncmp(h.magic, "LMAP", 4) != 0 || h.version != LANDING_MAP_VERSION) return false;
+	const Box & b = octree.root.box;
+	if (h.res != resolution || h.numVertices != octree.mesh.getNumVertices() ||
+		h.min[0] != b.min().x() || h.min[1] != b.min().y() || h.min[2] != b.min().z() ||
+		h.max[0] != b.max().x() || h.max[1] != b.max().y() || h.max[2] != b.max().z())
+		return false;
+
+	vector<LandingCell> read(h.res * h.res);
+	if (!in.read((char *)read.data(), read.size() * sizeof(LandingCell))) {
+		cout << path << ": truncated" << endl;
+		return false;
+	}
+	res = h.res;
+	bounds = b;
+	numVertices = h.numVertices;
+	cellWidth = (bounds.max().x() - bounds.min().x()) / res;
+	cellDepth = (bounds.max().z() - bounds.min().z()) / res;
+	cells.swap(read);
+	rescore();
+	buildTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+	return true;
+}
+
+bool LandingMap::save(const string & path) const {
+	LandingMapHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "LMAP", 4);
+	h.version = LANDING_MAP_VERSION;
+	h.res = res;
+	h.numVertices = numVertices;
+	for (int k = 0; k < 3; k++) {
+		h.min[k] = bounds.min().data()[k];
+		h.max[k] = bounds.max().data()[k];
+	}
+	ofstream out(ofToDataPath(path, true), ios::binary);
+	out.write((const char *)&h, sizeof(h));
+	out.write((const char *)cells.data(), cells.size() * sizeof(LandingCell));
+	return out.good();
+}
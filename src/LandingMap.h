@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+
+//  Landing suitability of the terrain on an x/z grid, scored once from
+//  the Octree so the game can look it up in constant time.
+//
+//  Each cell is a probe: the terrain vertices under it (plus half a cell
+//  around it) are gathered with Octree::pointsInBox and a plane is fit to
+//  them by least squares.  The plane's tilt is the cell's slope, the RMS
+//  distance of the vertices from the plane its roughness, and the spread
+//  of their heights its flatness.  Each is scored against a limit and the
+//  three scores are multiplied, so a cell that fails any one scores 0 and
+//  an ideal pad scores 1.
+//
+//  create() scores rows of cells on a pool of worker threads, which only
+//  read the tree.  The pool is started by the first create() and kept
+//  until the map is destroyed, so building maps over and over doesn't
+//  start new threads.  The measurements are cached in a binary file
+//  keyed by the mesh's vertex count and bounds; scores are redone from
+//  them on load, so changing a limit doesn't need a rebuild.  update()
+//  re-scores the cells under a region, after a crater.
+//
+#define LANDING_MAP_VERSION 1
+
+class LandingCell {
+public:
+	float slope = 0;			// degrees from level
+	float roughness = 0;		// RMS distance from the fitted plane
+	float spread = 0;			// highest minus lowest vertex
+	float height = 0;			// fitted plane at the cell center
+	int numPoints = 0;
+	float score = 0;			// 0 to 1
+};
+
+struct LandingMapHeader {
+	char magic[4];				// "LMAP"
+	uint32_t version;
+	uint32_t res;
+	uint32_t numVertices;		// of the mesh the map was built from
+	float min[3], max[3];		// bounds of the octree root
+};
+
+class LandingMap;
+
+class LandingWorker : public ofThread {
+public:
+	void threadedFunction();
+	LandingMap *map = NULL;
+};
+
+class LandingMap {
+public:
+	~LandingMap() { stopWorkers(); }
+	void create(const Octree & octree, int resolution, int numThreads);
+	void update(const Octree & octree, const Box & region);
+	bool load(const string & path, const Octree & octree, int resolution);
+	bool save(const string & path) const;
+	bool isCreated() const { return res > 0; }
+	void rescore();
+
+	const LandingCell * cellAt(float x, float z) const;
+	float getScore(float x, float z) const;
+	float scoreArea(const Box & box) const;
+	void draw(float minScore);
+
+	Box bounds;
+	int res = 0;
+	float cellWidth = 0, cellDepth = 0;
+	vector<LandingCell> cells;		// cells[k * res + i]
+	int numVertices = 0;
+
+	// limits; a cell at or past any of them scores 0
+	//
+	float maxSlope = 12;			// degrees
+	float maxRoughness = 0.4;
+	float maxSpread = 1.5;
+
+	float buildTime = 0;			// ms for the last create() or load()
+
+private:
+	friend class LandingWorker;
+	void scoreCell(const Octree & octree, int i, int k, vector<int> & pointsRtn);
+	void scoreRows(const Octree & octree);
+	float score(const LandingCell & cell) const;
+	void startWorkers(int numThreads);
+	void stopWorkers();
+
+	vector<shared_ptr<LandingWorker>> workers;
+	ofThreadChannel<int> work;		// one message per worker wanted on a create()
+	ofThreadChannel<int> done;
+	const Octree *jobOctree = NULL;	// the tree the workers are scoring
+	std::atomic<int> nextRow{ 0 };	// next row for a worker to take
+	ofVboMesh mesh;					// colored cells for draw()
+	bool meshDirty = true;
+};
@@ -0,0 +1,91 @@
+
+#include "MergedModel.h"
+
+static_assert(sizeof(ofIndexType) == sizeof(uint32_t), "mergeMeshes writes 32 bit indices");
+
+// submeshes can share a material if everything the draw sets up matches
+//
+static bool sameMaterial(const MergedMaterial & a, const ofMaterial & material, const ofTexture & texture) {
+	const ofMaterial & m = a.material;
+	bool textured = texture.isAllocated();
+	if (a.textured != textured) return false;
+	if (textured && a.texture.getTextureData().textureID != texture.getTextureData().textureID) return false;
+	return m.getDiffuseColor() == material.getDiffuseColor() &&
+		m.getAmbientColor() == material.getAmbientColor() &&
+		m.getSpecularColor() == material.getSpecularColor() &&
+		m.getEmissiveColor() == material.getEmissiveColor() &&
+		m.getShininess() == material.getShininess();
+}
+
+// Pack every submesh of model into the merged buffers.  Uploads to GL,
+// so it has to run on the main thread
+//
+void MergedModel::build(ofxAssimpModelLoader & model) {
+	numMeshes = model.getNumMeshes();
+	materials.clear();
+
+	// material table; each submesh's key is the entry it uses
+	//
+	vector<ofMesh> meshes(numMeshes);
+	vector<MergeMesh> inputs(numMeshes);
+	for (int i = 0; i < numMeshes; i++) {
+		ofMaterial material = model.getMaterialForMesh(i);
+		ofTexture texture = model.getTextureForMesh(i);
+		int m = 0;
+		while (m < materials.size() && !sameMaterial(materials[m], material, texture)) m++;
+		if (m == materials.size()) {
+			MergedMaterial entry;
+			entry.material = material;
+			entry.texture = texture;
+			entry.textured = texture.isAllocated();
+			materials.push_back(entry);
+		}
+
+		ofMesh & mesh = meshes[i];
+		mesh = model.getMesh(i);
+		MergeMesh & input = inputs[i];
+		input.numVertices = mesh.getNumVertices();
+		if (input.numVertices > 0) input.positions = &mesh.getVertices()[0].x;
+		if (input.numVertices > 0 && mesh.getNumNormals() == input.numVertices)
+			input.normals = &mesh.getNormals()[0].x;
+		if (input.numVertices > 0 && mesh.getNumTexCoords() == input.numVertices)
+			input.texCoords = &mesh.getTexCoords()[0].x;
+		input.numIndices = mesh.getNumIndices();
+		if (input.numIndices > 0) input.indices = &mesh.getIndices()[0];
+		glm::mat4 transform = model.getMeshHelper(i).matrix;
+		memcpy(input.transform, &transform[0][0], sizeof(input.transform));
+		input.material = m;
+	}
+
+	MergeResult merged;
+	mergeMeshes(inputs, merged);
+	meshBounds = merged.bounds;
+	for (const MergeRange & range : merged.ranges) {
+		materials[range.material].first = range.first;
+		materials[range.material].count = range.count;
+	}
+	numVertices = merged.vertices.size();
+	if (merged.vertices.empty()) return;
+
+	vertexBuffer.allocate(merged.vertices, GL_STATIC_DRAW);
+	vbo.setVertexBuffer(vertexBuffer, 3, sizeof(MergeVertex), offsetof(MergeVertex, position));
+	vbo.setNormalBuffer(vertexBuffer, sizeof(MergeVertex), offsetof(MergeVertex, normal));
+	vbo.setTexCoordBuffer(vertexBuffer, sizeof(MergeVertex), offsetof(MergeVertex, texCoord));
+	vbo.setIndexData(&merged.indices[0], merged.indices.size(), GL_STATIC_DRAW);
+}
+
+// one draw call per material
+//
+void MergedModel::draw() {
+	drawCalls = 0;
+	for (int m = 0; m < materials.size(); m++) {
+		MergedMaterial & entry = materials[m];
+		if (entry.count == 0) continue;
+		entry.material.begin();
+		if (entry.textured) entry.texture.bind();
+		vbo.drawElements(GL_TRIANGLES, entry.count, entry.first);
+		if (entry.textured) entry.texture.unbind();
+		entry.material.end();
+		drawCalls++;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpModelLoader.h"
+#include "MeshMerge.h"
+
+//  A multi-mesh model packed into a single buffer for drawing.
+//
+//  build() bakes each submesh's node transform into its vertices and
+//  interleaves positions, normals and texture coordinates into one vertex
+//  buffer, with one index buffer (mergeMeshes, MeshMerge.h).  Submeshes
+//  are grouped by material, and each group is a contiguous index range
+//  drawn in one call, so the model draws in as many calls as it has
+//  distinct materials.  The bounds of every submesh, in the model's
+//  space, are kept for the debug overlay.  draw() expects the model
+//  matrix to already be applied.
+//
+class MergedMaterial {
+public:
+	ofMaterial material;
+	ofTexture texture;
+	bool textured = false;
+	int first = 0;			// index range of the submeshes using it
+	int count = 0;
+};
+
+class MergedModel {
+public:
+	void build(ofxAssimpModelLoader & model);
+	void draw();
+	bool isBuilt() const { return !materials.empty(); }
+
+	vector<MergedMaterial> materials;
+	vector<Box> meshBounds;		// per submesh
+	ofBufferObject vertexBuffer;
+	ofVbo vbo;
+	int numMeshes = 0;
+	int numVertices = 0;
+	int drawCalls = 0;			// in the last draw()
+};
@@ -0,0 +1,92 @@
+
+#include "MeshMerge.h"
+#include <algorithm>
+#include <cmath>
+
+// normals go through the inverse transpose of the transform's upper 3x3,
+// which is its cofactor matrix over the determinant.  The normal is
+// normalized after, so only the determinant's sign is kept
+//
+static void normalMatrix(const float *m, float n[9]) {
+	// a(row, col) of the 3x3, column major
+	auto a = [m](int r, int c) { return m[c * 4 + r]; };
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 3; c++) {
+			int r1 = (r + 1) % 3, r2 = (r + 2) % 3;
+			int c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+			n[c * 3 + r] = a(r1, c1) * a(r2, c2) - a(r1, c2) * a(r2, c1);
+		}
+	}
+	float det = a(0, 0) * n[0] + a(0, 1) * n[3] + a(0, 2) * n[6];
+	if (det < 0)
+		for (int k = 0; k < 9; k++) n[k] = -n[k];
+}
+
+// Pack meshes into result, grouped by material key
+//
+void mergeMeshes(const std::vector<MergeMesh> & meshes, MergeResult & result) {
+	result.vertices.clear();
+	result.indices.clear();
+	result.ranges.clear();
+	result.bounds.assign(meshes.size(), Box(Vector3(0, 0, 0), Vector3(0, 0, 0)));
+
+	std::vector<int> keys;
+	for (const MergeMesh & mesh : meshes) keys.push_back(mesh.material);
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	for (int key : keys) {
+		MergeRange range;
+		range.material = key;
+		range.first = result.indices.size();
+		for (int i = 0; i < meshes.size(); i++) {
+			const MergeMesh & mesh = meshes[i];
+			if (mesh.material != key) continue;
+			const float *m = mesh.transform;
+			float n[9];
+			normalMatrix(m, n);
+
+			uint32_t base = result.vertices.size();
+			Vector3 min, max;
+			for (int v = 0; v < mesh.numVertices; v++) {
+				MergeVertex vertex;
+				const float *p = mesh.positions + 3 * v;
+				for (int r = 0; r < 3; r++)
+					vertex.position[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+				if (mesh.normals) {
+					const float *q = mesh.normals + 3 * v;
+					float len2 = 0;
+					for (int r = 0; r < 3; r++) {
+						vertex.normal[r] = n[r] * q[0] + n[3 + r] * q[1] + n[6 + r] * q[2];
+						len2 += vertex.normal[r] * vertex.normal[r];
+					}
+					float scale = len2 > 0 ? 1 / sqrtf(len2) : 0;
+					for (int r = 0; r < 3; r++) vertex.normal[r] *= scale;
+				}
+				else {
+					vertex.normal[0] = 0; vertex.normal[1] = 1; vertex.normal[2] = 0;
+				}
+				vertex.texCoord[0] = mesh.texCoords ? mesh.texCoords[2 * v] : 0;
+				vertex.texCoord[1] = mesh.texCoords ? mesh.texCoords[2 * v + 1] : 0;
+				result.vertices.push_back(vertex);
+
+				Vector3 pos(vertex.position[0], vertex.position[1], vertex.position[2]);
+				min = (v == 0) ? pos : Vector3::min(min, pos);
+				max = (v == 0) ? pos : Vector3::max(max, pos);
+			}
+			if (mesh.numVertices > 0)
+				result.bounds[i] = Box(min, max);
+
+			if (mesh.indices) {
+				for (int k = 0; k < mesh.numIndices; k++)
+					result.indices.push_back(base + mesh.indices[k]);
+			}
+			else {
+				for (int k = 0; k < mesh.numVertices; k++)
+					result.indices.push_back(base + k);
+			}
+		}
+		range.count = result.indices.size() - range.first;
+		result.ranges.push_back(range);
+	}
+}
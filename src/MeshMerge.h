@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "box.h"
+
+//  The CPU half of MergedModel::build: submeshes in, one vertex buffer,
+//  one index buffer and an index range per material out.
+//
+//  Each submesh's transform is baked into its positions, and the inverse
+//  transpose of it into its normals.  Submeshes with the same material
+//  key are packed next to each other so each key is one contiguous range
+//  of indices, and indices are rebased onto the merged vertex buffer.
+//  Plain arrays and no openFrameworks or GL, so the merge can be tested
+//  on its own; MergedModel fills MergeMesh from the Assimp meshes and
+//  uploads the result.
+//
+
+// one submesh, pointing at its arrays (owned by the caller)
+//
+class MergeMesh {
+public:
+	const float *positions = NULL;		// 3 floats per vertex
+	const float *normals = NULL;		// 3 per vertex, or NULL for (0, 1, 0)
+	const float *texCoords = NULL;		// 2 per vertex, or NULL for (0, 0)
+	int numVertices = 0;
+	const uint32_t *indices = NULL;		// triangles, or NULL to draw the vertices in order
+	int numIndices = 0;
+	float transform[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };	// column major, as glm::mat4
+	int material = 0;					// submeshes with equal keys draw in one call
+};
+
+// interleaved for the vbo: position, normal, texcoord
+//
+struct MergeVertex {
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+class MergeRange {
+public:
+	int material = 0;		// key
+	int first = 0;			// into indices
+	int count = 0;
+};
+
+class MergeResult {
+public:
+	std::vector<MergeVertex> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<MergeRange> ranges;		// one per distinct key, by increasing key
+	std::vector<Box> bounds;			// per submesh, in the order given, after its transform
+};
+
+void mergeMeshes(const std::vector<MergeMesh> & meshes, MergeResult & result);
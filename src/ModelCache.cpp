@@ -0,0 +1,97 @@
+
+#include "ModelCache.h"
+
+// the cached model for path, importing it if this is the first request
+//
+shared_ptr<ofxAssimpModelLoader> ModelCache::get(const string & path) {
+	auto it = models.find(path);
+	if (it != models.end()) {
+		hits++;
+		return it->second;
+	}
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	shared_ptr<ofxAssimpModelLoader> model = make_shared<ofxAssimpModelLoader>();
+	if (!model->loadModel(path)) {
+		cout << "can't load model " << path << endl;
+		return nullptr;
+	}
+	model->setScaleNormalization(false);
+	loadTime += (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+	loads++;
+	models[path] = model;
+	return model;
+}
+
+// the cached model for path packed into one buffer, merging it if this
+// is the first request.  Uploads to GL, so main thread only
+//
+shared_ptr<MergedModel> ModelCache::getMerged(const string & path) {
+	auto it = merged.find(path);
+	if (it != merged.end()) return it->second;
+
+	shared_ptr<ofxAssimpModelLoader> model = get(path);
+	if (!model) return nullptr;
+	shared_ptr<MergedModel> m = make_shared<MergedModel>();
+	m->build(*model);
+	merged[path] = m;
+	return m;
+}
+
+bool ModelInstance::load(ModelCache & cache, const string & path) {
+	model = cache.get(path);
+	if (model) merged = cache.getMerged(path);
+	return model != nullptr;
+}
+
+// put this instance's transform on the shared model
+//
+void ModelInstance::apply() {
+	model->setPosition(position.x, position.y, position.z);
+	model->setRotation(0, angle, rotationAxis.x, rotationAxis.y, rotationAxis.z);
+}
+
+ofPoint ModelInstance::getSceneMin() {
+	return model ? model->getSceneMin() : ofPoint();
+}
+
+ofPoint ModelInstance::getSceneMax() {
+	return model ? model->getSceneMax() : ofPoint();
+}
+
+int ModelInstance::getNumMeshes() {
+	return model ? model->getNumMeshes() : 0;
+}
+
+// bounds of each submesh in the model's space, for the debug overlay
+//
+const vector<Box> & ModelInstance::getMeshBounds() {
+	static vector<Box> none;
+	return merged ? merged->meshBounds : none;
+}
+
+glm::mat4 ModelInstance::getModelMatrix() {
+	if (!model) return glm::mat4(1.0);
+	apply();
+	return model->getModelMatrix();
+}
+
+// draws the merged model if there is one, in one call per material
+//
+void ModelInstance::drawFaces() {
+	if (!model || !visible) return;
+	apply();
+	if (merged && merged->isBuilt()) {
+		ofPushMatrix();
+		ofMultMatrix(model->getModelMatrix());
+		merged->draw();
+		ofPopMatrix();
+	}
+	else model->drawFaces();
+}
+
+void ModelInstance::drawWireframe() {
+	if (!model || !visible) return;
+	apply();
+	model->drawWireframe();
+}
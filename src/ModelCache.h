@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpModelLoader.h"
+#include "MergedModel.h"
+
+//  Models loaded once and kept resident, keyed by path.
+//
+//  get() imports a model through Assimp the first time it's asked for
+//  and hands back the same one after that, so nothing is reparsed or
+//  re-uploaded.  Models come back with scale normalization off, like
+//  every model in the game.  getMerged() is the same model packed into
+//  one buffer (see MergedModel), built once on first use.
+//
+//  A ModelInstance is a cheap handle on a cached model with its own
+//  position, rotation and visibility.  Its transform is put on the
+//  shared model just before it's drawn or measured, and hiding an
+//  instance (e.g. when the lander explodes) leaves the shared meshes
+//  and textures alone.
+//
+class ModelCache {
+public:
+	shared_ptr<ofxAssimpModelLoader> get(const string & path);
+	shared_ptr<MergedModel> getMerged(const string & path);
+
+	map<string, shared_ptr<ofxAssimpModelLoader>> models;
+	map<string, shared_ptr<MergedModel>> merged;
+	int loads = 0;				// imports from disk
+	int hits = 0;
+	float loadTime = 0;			// ms spent importing
+};
+
+class ModelInstance {
+public:
+	bool load(ModelCache & cache, const string & path);
+	bool isLoaded() const { return model != nullptr; }
+
+	void setPosition(float x, float y, float z) { position = glm::vec3(x, y, z); }
+	void setRotation(float degrees, const glm::vec3 & axis) { angle = degrees; rotationAxis = axis; }
+	ofPoint getPosition() const { return ofPoint(position.x, position.y, position.z); }
+	ofPoint getSceneMin();
+	ofPoint getSceneMax();
+	int getNumMeshes();
+	const vector<Box> & getMeshBounds();
+	glm::mat4 getModelMatrix();
+	void drawFaces();
+	void drawWireframe();
+
+	bool visible = true;
+	shared_ptr<ofxAssimpModelLoader> model;
+	shared_ptr<MergedModel> merged;		// what drawFaces() draws
+
+private:
+	void apply();
+
+	glm::vec3 position = glm::vec3(0, 0, 0);
+	float angle = 0;
+	glm::vec3 rotationAxis = glm::vec3(0, 1, 0);
+};
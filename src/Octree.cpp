@@ -21,7 +21,7 @@ void Octree::drawBox(const Box &box) {
 	Vector3 max = box.parameters[1];
 	Vector3 size = max - min;
 	Vector3 center = size / 2 + min;
-	ofVec3f p = ofVec3f(center.x(), center.y(), center.z());
+	glm::vec3 p = glm::vec3(center.x(), center.y(), center.z());
 	float w = size.x();
 	float h = size.y();
 	float d = size.z();
@@ -31,37 +31,20 @@ void Octree::drawBox(const Box &box) {
 // return a Mesh Bounding Box for the entire Mesh
 //
 Box Octree::meshBounds(const ofMesh & mesh) {
-	int n = mesh.getNumVertices();
-	ofVec3f v = mesh.getVertex(0);
-	ofVec3f max = v;
-	ofVec3f min = v;
-	for (int i = 1; i < n; i++) {
-		ofVec3f v = mesh.getVertex(i);
-
-		if (v.x > max.x) max.x = v.x;
-		else if (v.x < min.x) min.x = v.x;
-
-		if (v.y > max.y) max.y = v.y;
-		else if (v.y < min.y) min.y = v.y;
-
-		if (v.z > max.z) max.z = v.z;
-		else if (v.z < min.z) min.z = v.z;
-	}
-	cout << "vertices: " << n << endl;
-//	cout << "min: " << min << "max: " << max << endl;
-	return Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
+	return Box::bounds(Vector3View(mesh.getVertices()));
 }
 
 // getMeshPointsInBox:  return an array of indices to points in mesh that are contained 
 //                      inside the Box.  Return count of points found;
+//                      the vertices are tested in place in the mesh's array
 //
 int Octree::getMeshPointsInBox(const ofMesh & mesh, const vector<int>& points,
-	Box & box, vector<int> & pointsRtn)
+	const Box & box, vector<int> & pointsRtn)
 {
 	int count = 0;
+	Vector3View verts(mesh.getVertices());
 	for (int i = 0; i < points.size(); i++) {
-		ofVec3f v = mesh.getVertex(points[i]);
-		if (box.inside(Vector3(v.x, v.y, v.z))) {
+		if (box.inside(verts.point(points[i]))) {
 			count++;
 			pointsRtn.push_back(points[i]);
 		}
@@ -73,19 +56,16 @@ int Octree::getMeshPointsInBox(const ofMesh & mesh, const vector<int>& points,
 //                      inside the Box.  Return count of faces found;
 //
 int Octree::getMeshFacesInBox(const ofMesh & mesh, const vector<int>& faces,
-	Box & box, vector<int> & facesRtn)
+	const Box & box, vector<int> & facesRtn)
 {
 	int count = 0;
+	Vector3View verts(mesh.getVertices());
+	const vector<ofIndexType> & indices = mesh.getIndices();
 	for (int i = 0; i < faces.size(); i++) {
-		ofMeshFace face = mesh.getFace(faces[i]);
-		ofVec3f v[3];
-		v[0] = face.getVertex(0);
-		v[1] = face.getVertex(1);
-		v[2] = face.getVertex(2);
+		int f = 3 * faces[i];
 		Vector3 p[3];
-		p[0] = Vector3(v[0].x, v[0].y, v[0].z);
-		p[1] = Vector3(v[1].x, v[1].y, v[1].z);
-		p[2] = Vector3(v[2].x, v[2].y, v[2].z);
+		for (int k = 0; k < 3; k++)
+			p[k] = verts[indices.empty() ? f + k : indices[f + k]];
 		if (box.inside(p,3)) {
 			count++;
 			facesRtn.push_back(faces[i]);
@@ -96,41 +76,34 @@ int Octree::getMeshFacesInBox(const ofMesh & mesh, const vector<int>& faces,
 
 //  Subdivide a Box into eight(8) equal size boxes, return them in boxList;
 //
+//  ground floor (octants 0-3) going around x/z, then the second story
+//  above it.  The boxes come from octantBox() so every builder and the
+//  compacted queries agree on them to the bit
+//
 void Octree::subDivideBox8(const Box &box, vector<Box> & boxList) {
-	Vector3 min = box.parameters[0];
-	Vector3 max = box.parameters[1];
-	Vector3 size = max - min;
-	Vector3 center = size / 2 + min;
-	float xdist = (max.x() - min.x()) / 2;
-	float ydist = (max.y() - min.y()) / 2;
-	float zdist = (max.z() - min.z()) / 2;
-	Vector3 h = Vector3(0, ydist, 0);
-
-	//  generate ground floor
-	//
-	Box b[8];
-	b[0] = Box(min, center);
-	b[1] = Box(b[0].min() + Vector3(xdist, 0, 0), b[0].max() + Vector3(xdist, 0, 0));
-	b[2] = Box(b[1].min() + Vector3(0, 0, zdist), b[1].max() + Vector3(0, 0, zdist));
-	b[3] = Box(b[2].min() + Vector3(-xdist, 0, 0), b[2].max() + Vector3(-xdist, 0, 0));
-
 	boxList.clear();
-	for (int i = 0; i < 4; i++)
-		boxList.push_back(b[i]);
-
-	// generate second story
-	//
-	for (int i = 4; i < 8; i++) {
-		b[i] = Box(b[i - 4].min() + h, b[i - 4].max() + h);
-		boxList.push_back(b[i]);
-	}
+	for (int o = 0; o < 8; o++)
+		boxList.push_back(octantBox(box, o));
 }
 
 void Octree::create(const ofMesh & geo, int numLevels) {
 	// initialize octree structure
 	//
 	mesh = geo;
+	build(numLevels);
+}
+
+// same as above, but takes over the caller's mesh instead of copying it,
+// so the tree's mesh is the only copy
+//
+void Octree::create(ofMesh && geo, int numLevels) {
+	mesh = std::move(geo);
+	build(numLevels);
+}
+
+void Octree::build(int numLevels) {
 	int level = 0;
+	levels = numLevels;
 	root.box = meshBounds(mesh);
 	if (!bUseFaces) {
 		for (int i = 0; i < mesh.getNumVertices(); i++) {
@@ -148,9 +121,227 @@ void Octree::create(const ofMesh & geo, int numLevels) {
     subdivide(mesh, root, numLevels, level);
 }
 
+// Build from Z-order (Morton) keys instead: every vertex is quantized
+// to the finest cell of the tree and its cell coordinates interleaved
+// into one key, so sorting the keys puts the points of every node next
+// to each other.  The mesh's vertices are reordered to match (and its
+// indices remapped), after which a node's points are a range of
+// consecutive vertices and the tree is built by splitting ranges,
+// without testing any point against a box.
+//
+void Octree::createMorton(const ofMesh & geo, int numLevels) {
+	mesh = geo;
+	buildMorton(numLevels);
+}
 
+void Octree::createMorton(ofMesh && geo, int numLevels) {
+	mesh = std::move(geo);
+	buildMorton(numLevels);
+}
+
+// spread the low 21 bits of v out to every third bit
+//
+static uint64_t spreadBits(uint64_t v) {
+	v &= 0x1fffff;
+	v = (v | v << 32) & 0x1f00000000ffffULL;
+	v = (v | v << 16) & 0x1f0000ff0000ffULL;
+	v = (v | v << 8) & 0x100f00f00f00f00fULL;
+	v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+	v = (v | v << 2) & 0x1249249249249249ULL;
+	return v;
+}
+
+// cell of coordinate v along one axis of [min, max], out of 2^bits
+//
+static uint64_t quantize(float v, float min, float max, int bits) {
+	if (max <= min) return 0;
+	double cells = (double)(1 << bits);
+	double q = floor((v - (double)min) / ((double)max - min) * cells);
+	return (uint64_t)ofClamp(q, 0, cells - 1);
+}
+
+void Octree::buildMorton(int numLevels) {
+	root = TreeNode();
+	nodes.clear();
+	levels = numLevels;
+	root.box = meshBounds(mesh);
+	int n = mesh.getNumVertices();
+	int bits = MIN(MAX(numLevels - 1, 1), 21);
+
+	// keys; per level the three bits are y, z, x from high to low
+	//
+	const Vector3 & min = root.box.parameters[0];
+	const Vector3 & max = root.box.parameters[1];
+	vector<uint64_t> keys(n);
+	const glm::vec3 *verts = mesh.getVertices().data();
+	for (int i = 0; i < n; i++) {
+		const glm::vec3 & v = verts[i];
+		keys[i] = spreadBits(quantize(v.y, min.y(), max.y(), bits)) << 2 |
+			spreadBits(quantize(v.z, min.z(), max.z(), bits)) << 1 |
+			spreadBits(quantize(v.x, min.x(), max.x(), bits));
+	}
+
+	// LSD radix sort of (key, vertex), a byte at a time
+	//
+	vector<int> order(n), tmpOrder(n);
+	vector<uint64_t> tmpKeys(n);
+	for (int i = 0; i < n; i++) order[i] = i;
+	for (int shift = 0; shift < 3 * bits; shift += 8) {
+		int counts[257] = { 0 };
+		for (int i = 0; i < n; i++)
+			counts[((keys[i] >> shift) & 0xff) + 1]++;
+		for (int b = 0; b < 256; b++)
+			counts[b + 1] += counts[b];
+		for (int i = 0; i < n; i++) {
+			int dst = counts[(keys[i] >> shift) & 0xff]++;
+			tmpKeys[dst] = keys[i];
+			tmpOrder[dst] = order[i];
+		}
+		keys.swap(tmpKeys);
+		order.swap(tmpOrder);
+	}
+	sortVertices(order);
+
+	root.points.resize(n);
+	for (int i = 0; i < n; i++) root.points[i] = i;
+	subdivideMorton(root, keys, 0, n, 1, numLevels, bits);
+}
+
+// Put the mesh's vertices (and normals, texture coordinates and colors)
+// in "order", where order[i] is the old index of new vertex i, and
+// remap the indices to match
+//
+void Octree::sortVertices(const vector<int> & order) {
+	int n = order.size();
+	vector<glm::vec3> vertices(n);
+	for (int i = 0; i < n; i++) vertices[i] = mesh.getVertices()[order[i]];
+	mesh.getVertices().swap(vertices);
+	if (mesh.getNumNormals() == n) {
+		vector<glm::vec3> normals(n);
+		for (int i = 0; i < n; i++) normals[i] = mesh.getNormals()[order[i]];
+		mesh.getNormals().swap(normals);
+	}
+	if (mesh.getNumTexCoords() == n) {
+		vector<glm::vec2> texCoords(n);
+		for (int i = 0; i < n; i++) texCoords[i] = mesh.getTexCoords()[order[i]];
+		mesh.getTexCoords().swap(texCoords);
+	}
+	if (mesh.getNumColors() == n) {
+		vector<ofFloatColor> colors(n);
+		for (int i = 0; i < n; i++) colors[i] = mesh.getColors()[order[i]];
+		mesh.getColors().swap(colors);
+	}
+	vector<int> newIndex(n);
+	for (int i = 0; i < n; i++) newIndex[order[i]] = i;
+	for (auto & index : mesh.getIndices())
+		index = newIndex[index];
+}
+
+// Split node, whose points are vertices begin to end - 1, on the key
+// bits for this level.  Children are added in octant order, which isn't
+// the key order (see subDivideBox8 for the octant layout)
+//
+void Octree::subdivideMorton(TreeNode & node, const vector<uint64_t> & keys, int begin, int end,
+	int level, int numLevels, int bits) {
+	if (level >= numLevels || level > bits) return;
+	int shift = 3 * (bits - level);
+
+	// keys in the node share their higher bits, so each octant's are
+	// a run
+	//
+	int start[9];
+	int i = begin;
+	for (int digit = 0; digit < 8; digit++) {
+		start[digit] = i;
+		while (i < end && (int)((keys[i] >> shift) & 7) == digit) i++;
+	}
+	start[8] = end;
+
+	static const int xs[4] = { 0, 1, 1, 0 };
+	static const int zs[4] = { 0, 0, 1, 1 };
+	int numChildren = 0;
+	for (int digit = 0; digit < 8; digit++)
+		if (start[digit + 1] > start[digit]) numChildren++;
+	node.children.reserve(numChildren);
+	for (int o = 0; o < 8; o++) {
+		int digit = (o >= 4) << 2 | zs[o & 3] << 1 | xs[o & 3];
+		int first = start[digit], last = start[digit + 1];
+		if (last == first) continue;
+		node.children.push_back(TreeNode());
+		TreeNode & child = node.children.back();
+		child.box = octantBox(node.box, o);
+		child.points.resize(last - first);
+		for (int p = first; p < last; p++) child.points[p - first] = p;
+	}
+
+	int c = 0;
+	for (int o = 0; o < 8; o++) {
+		int digit = (o >= 4) << 2 | zs[o & 3] << 1 | xs[o & 3];
+		int first = start[digit], last = start[digit + 1];
+		if (last == first) continue;
+		if (last - first > 1)
+			subdivideMorton(node.children[c], keys, first, last, level + 1, numLevels, bits);
+		c++;
+	}
+}
+
+
+// Split a node's points among its eight octants.  Each point goes to
+// exactly one octant, picked by comparing it with the node's center, so
+// every point is looked at once and points on a boundary aren't put in
+// two children.  Children are added in octant order
+//
 void Octree::subdivide(const ofMesh & mesh, TreeNode & node, int numLevels, int level) {
 	if (level >= numLevels) return;
+	if (bUseFaces) {
+		subdivideFaces(mesh, node, numLevels, level);
+		return;
+	}
+	level++;
+
+	Vector3 center = node.box.center();
+	Vector3View verts(mesh.getVertices());
+
+	// octant of each point, from one compare with the center: bits x, y, z
+	// of above are set where the point is at or past it.  x and z pick
+	// the quadrant in the order subDivideBox8 lays them out, y the story
+	//
+	static const uint8_t octant[8] = { 0, 1, 4, 5, 3, 2, 7, 6 };
+	int n = node.points.size();
+	octantScratch.resize(n);
+	int counts[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	for (int i = 0; i < n; i++) {
+		int above = float4::lessEqual(center.simd(), float4::load3(verts.point(node.points[i])));
+		uint8_t o = octant[above];
+		octantScratch[i] = o;
+		counts[o]++;
+	}
+
+	int childOf[8];
+	int numChildren = 0;
+	for (int o = 0; o < 8; o++)
+		if (counts[o] > 0) numChildren++;
+	node.children.resize(numChildren);
+	for (int o = 0, c = 0; o < 8; o++) {
+		if (counts[o] == 0) continue;
+		childOf[o] = c;
+		node.children[c].box = octantBox(node.box, o);
+		node.children[c].points.reserve(counts[o]);
+		c++;
+	}
+	for (int i = 0; i < n; i++)
+		node.children[childOf[octantScratch[i]]].points.push_back(node.points[i]);
+
+	for (int c = 0; c < numChildren; c++) {
+		if (node.children[c].points.size() > 1)
+			subdivide(mesh, node.children[c], numLevels, level);
+	}
+}
+
+// Face version of subdivide(): tests the faces against each octant's
+// box in turn
+//
+void Octree::subdivideFaces(const ofMesh & mesh, TreeNode & node, int numLevels, int level) {
 	vector<Box> boxList;
 	subDivideBox8(node.box, boxList);
 	level++;
@@ -158,11 +349,7 @@ void Octree::subdivide(const ofMesh & mesh, TreeNode & node, int numLevels, int
 	int totalPoints = 0;
 	for (int i = 0; i < boxList.size(); i++) {
 		TreeNode child;
-		int count = 0;
-		if (!bUseFaces)
-			count = getMeshPointsInBox(mesh, node.points, boxList[i], child.points);
-		else 
-			count = getMeshFacesInBox(mesh, node.points, boxList[i], child.points);
+		int count = getMeshFacesInBox(mesh, node.points, boxList[i], child.points);
 		totalPoints += count;
 
 		if (count > 0) {
@@ -185,12 +372,13 @@ void Octree::subdivide(const ofMesh & mesh, TreeNode & node, int numLevels, int
 // Implement functions below for Homework project
 //
 
-bool Octree::intersect(const Ray &ray, const TreeNode & node, TreeNode & nodeRtn) {
+bool Octree::intersect(const Ray &ray, const TreeNode & node, TreeNode & nodeRtn) const {
 	bool intersects = false;
 	// Check if the ray intersects with current node's box 
 	if (node.box.intersect(ray, 0, 1000)) {
-		// Check if the current node has only one point
-		if (node.points.size() == 1) {
+		// Check if the current node has only one point, or is a leaf
+		// holding duplicates at the deepest level
+		if (node.points.size() == 1 || (node.children.empty() && node.points.size() > 1)) {
 			// Return current node and true if there is only one point
 			nodeRtn = node;
 			return true;
@@ -208,12 +396,12 @@ bool Octree::intersect(const Ray &ray, const TreeNode & node, TreeNode & nodeRtn
 	return intersects;
 }
 
-bool Octree::intersect(const Box &box, TreeNode & node, vector<Box> & boxListRtn) {
+bool Octree::intersect(const Box &box, const TreeNode & node, vector<Box> & boxListRtn) {
 	bool intersects = false;
-	Box landerBox = box; // Instantiates/Holds lander's bounding box
-	if (landerBox.overlap(node.box)) {
-		// Checks if currentNode has only one data point
-		if (node.points.size() == 1) {
+	// box is the lander's bounding box
+	if (box.overlap(node.box)) {
+		// Checks if currentNode has only one data point (or duplicates)
+		if (node.points.size() == 1 || (node.children.empty() && node.points.size() > 1)) {
 			// Adds current node's bounding box to list of boxes to return
 			boxListRtn.push_back(node.box);
 			return true;
@@ -246,6 +434,431 @@ void Octree::drawLeafNodes(TreeNode & node) {
 
 }
 
+// The box of octant "octant" of box.  Every octant box comes from here
+// (subDivideBox8 and the builders call it), so
+// compacted queries, which rebuild boxes on the way down, see the same
+// boxes as the original tree
+//
+Box Octree::octantBox(const Box & box, int octant) {
+	return box.octant(octant);
+}
 
+// Replace the tree of TreeNodes with compact nodes and free it.  Only
+// root.box is kept; anything that walks root (the height field, the
+// terrain chunks) has to be built before this
+//
+void Octree::compact() {
+	nodes.clear();
+	leafPoints.clear();
+	unmatchedChildren = 0;
+	nodes.push_back(CompactNode());
+	compactNode(root, 0);
+	nodes.shrink_to_fit();
+	leafPoints.shrink_to_fit();
+	if (unmatchedChildren > 0)
+		cout << "octree: " << unmatchedChildren << " children matched no octant and were left out of the compact nodes" << endl;
+	vector<TreeNode>().swap(root.children);
+	vector<int>().swap(root.points);
+}
 
+// a node with one point, or none with children, is a leaf, as the
+// queries on the tree treat it
+//
+void Octree::compactNode(const TreeNode & node, int index) {
+	if (node.points.size() == 1 || node.children.empty()) {
+		nodes[index].firstPoint = leafPoints.size();
+		nodes[index].numPoints = node.points.size();
+		leafPoints.insert(leafPoints.end(), node.points.begin(), node.points.end());
+		return;
+	}
 
+	// find which octant each child is; boxes that match more than one
+	// (a flat mesh) take the first one still free
+	//
+	int octants[8];
+	uint8_t mask = 0;
+	for (int i = 0; i < node.children.size(); i++) {
+		const Box & b = node.children[i].box;
+		octants[i] = -1;
+		for (int o = 0; o < 8 && octants[i] < 0; o++) {
+			if (mask & (1 << o)) continue;
+			Box ob = octantBox(node.box, o);
+			if (ob.parameters[0] == b.parameters[0] && ob.parameters[1] == b.parameters[1]) {
+				octants[i] = o;
+				mask |= 1 << o;
+			}
+		}
+	}
+	int first = nodes.size();
+	int numChildren = 0;
+	for (int o = 0; o < 8; o++)
+		if (mask & (1 << o)) numChildren++;
+	nodes[index].firstChild = first;
+	nodes[index].childMask = mask;
+	nodes.resize(first + numChildren);
+
+	// children go in octant order, which is also the order subdivide()
+	// added them in
+	//
+	for (int i = 0; i < node.children.size(); i++) {
+		if (octants[i] < 0) {
+			unmatchedChildren++;	// can't happen while every box comes from octantBox
+			continue;
+		}
+		int slot = first;
+		for (int o = 0; o < octants[i]; o++)
+			if (mask & (1 << o)) slot++;
+		compactNode(node.children[i], slot);
+	}
+}
+
+// Whole tree ray query; returns the index of the point in the leaf hit
+//
+bool Octree::intersect(const Ray & ray, int & pointRtn) const {
+	if (isCompact()) return intersectCompact(ray, 0, root.box, pointRtn);
+	TreeNode node;
+	if (!intersect(ray, root, node)) return false;
+	pointRtn = node.points[0];
+	return true;
+}
+
+bool Octree::intersect(const Box & box, vector<Box> & boxListRtn) {
+	if (isCompact()) return intersectCompact(box, 0, root.box, boxListRtn);
+	return intersect(box, root, boxListRtn);
+}
+
+// same searches as the TreeNode versions above, with each child's box
+// derived from its parent's
+//
+bool Octree::intersectCompact(const Ray & ray, int index, const Box & box, int & pointRtn) const {
+	if (!box.intersect(ray, 0, 1000)) return false;
+	const CompactNode & node = nodes[index];
+	if (node.numPoints > 0) {
+		pointRtn = leafPoints[node.firstPoint];
+		return true;
+	}
+	bool intersects = false;
+	int child = node.firstChild;
+	for (int o = 0; o < 8; o++) {
+		if (!(node.childMask & (1 << o))) continue;
+		if (intersectCompact(ray, child++, octantBox(box, o), pointRtn))
+			intersects = true;
+	}
+	return intersects;
+}
+
+bool Octree::intersectCompact(const Box & query, int index, const Box & box, vector<Box> & boxListRtn) const {
+	if (!query.overlap(box)) return false;
+	const CompactNode & node = nodes[index];
+	if (node.numPoints > 0) {
+		boxListRtn.push_back(box);
+		return true;
+	}
+	bool intersects = false;
+	int child = node.firstChild;
+	for (int o = 0; o < 8; o++) {
+		if (!(node.childMask & (1 << o))) continue;
+		if (intersectCompact(query, child++, octantBox(box, o), boxListRtn))
+			intersects = true;
+	}
+	return intersects;
+}
+
+void Octree::drawCompact(int index, const Box & box, int numLevels, int level) {
+	if (level >= numLevels) return;
+	drawBox(box);
+	level++;
+	const CompactNode & node = nodes[index];
+	int child = node.firstChild;
+	for (int o = 0; o < 8; o++) {
+		if (node.childMask & (1 << o))
+			drawCompact(child++, octantBox(box, o), numLevels, level);
+	}
+}
+
+static size_t treeBytes(const TreeNode & node) {
+	size_t bytes = sizeof(TreeNode) + node.points.capacity() * sizeof(int);
+	for (int i = 0; i < node.children.size(); i++)
+		bytes += treeBytes(node.children[i]);
+	return bytes;
+}
+
+// memory held by the tree's nodes and point lists, not counting the mesh
+//
+size_t Octree::nodeBytes() const {
+	return treeBytes(root) + nodes.capacity() * sizeof(CompactNode) + leafPoints.capacity() * sizeof(uint32_t);
+}
+
+static void countLeafPoints(const TreeNode & node, vector<int> & counts) {
+	if (node.children.empty()) {
+		for (int i = 0; i < node.points.size(); i++)
+			counts[node.points[i]]++;
+	}
+	for (int i = 0; i < node.children.size(); i++)
+		countLeafPoints(node.children[i], counts);
+}
+
+// Check that every vertex of the mesh is in exactly one leaf.  Prints
+// and returns the number lost and duplicated
+//
+bool Octree::checkPoints(int & lostRtn, int & duplicatedRtn) const {
+	vector<int> counts(mesh.getNumVertices(), 0);
+	countLeafPoints(root, counts);
+	lostRtn = duplicatedRtn = 0;
+	for (int i = 0; i < counts.size(); i++) {
+		if (counts[i] == 0) lostRtn++;
+		else if (counts[i] > 1) duplicatedRtn++;
+	}
+	if (lostRtn > 0 || duplicatedRtn > 0)
+		cout << "octree: " << lostRtn << " vertices lost, " << duplicatedRtn << " duplicated" << endl;
+	return lostRtn == 0 && duplicatedRtn == 0;
+}
+
+// The deepest node whose box holds all of box, and its level (the
+// root's is 1, as in subdivide())
+//
+TreeNode & Octree::nodeContaining(const Box & box, int & levelRtn) {
+	TreeNode *node = &root;
+	levelRtn = 1;
+	for (;;) {
+		TreeNode *next = NULL;
+		for (int i = 0; i < node->children.size() && next == NULL; i++) {
+			const Box & b = node->children[i].box;
+			if (b.inside(box.min()) && b.inside(box.max())) next = &node->children[i];
+		}
+		if (next == NULL) return *node;
+		node = next;
+		levelRtn++;
+	}
+}
+
+// Carve a crater into the mesh: vertices within radius of center sink
+// by up to depth, most at the center.  Only the subtree holding the
+// crater is rebuilt, so the cost follows the size of the crater, not of
+// the terrain.  Vertices don't go below the root box, which keeps the
+// rest of the tree valid.  Returns the vertices moved in movedRtn and
+// the box they moved within in regionRtn.  The tree can't be edited
+// once compacted
+//
+int Octree::carve(const Vector3 & center, float radius, float depth, vector<int> & movedRtn, Box & regionRtn) {
+	movedRtn.clear();
+	if (isCompact() || mesh.getNumVertices() == 0) return 0;
+	Vector3 lo = Vector3::max(center - Vector3(radius, radius + depth, radius), root.box.min());
+	Vector3 hi = Vector3::min(center + Vector3(radius, radius, radius), root.box.max());
+	if (!(lo <= hi)) return 0;
+	regionRtn = Box(lo, hi);
+
+	int level;
+	TreeNode & node = nodeContaining(regionRtn, level);
+	vector<int> inRegion;
+	getMeshPointsInBox(mesh, node.points, regionRtn, inRegion);
+	glm::vec3 *verts = mesh.getVertices().data();
+	float bottom = root.box.min().y();
+	for (int i = 0; i < inRegion.size(); i++) {
+		glm::vec3 & v = verts[inRegion[i]];
+		float t = (Vector3(&v.x) - center).length() / radius;
+		if (t >= 1) continue;
+		v.y = MAX(v.y - depth * (1 - t * t), bottom);
+		movedRtn.push_back(inRegion[i]);
+	}
+
+	// the node's point list is the same, only how it splits changed
+	//
+	if (!movedRtn.empty()) {
+		node.children.clear();
+		if (node.points.size() > 1)
+			subdivide(mesh, node, levels, level);
+	}
+	return movedRtn.size();
+}
+
+// squared distance from p to the nearest and farthest points of box,
+// per axis in float4 lanes
+//
+static float nearDistance2(const Box & box, const Vector3 & p) {
+	float4::f4 v = p.simd();
+	float4::f4 d = float4::max(float4::max(float4::sub(box.min().simd(), v), float4::sub(v, box.max().simd())), float4::splat(0));
+	return float4::sum3(float4::mul(d, d));
+}
+
+static float farDistance2(const Box & box, const Vector3 & p) {
+	float4::f4 v = p.simd();
+	float4::f4 d = float4::max(float4::sub(v, box.min().simd()), float4::sub(box.max().simd(), v));
+	return float4::sum3(float4::mul(d, d));
+}
+
+static float distance2(const Vector3 & a, const Vector3 & b) {
+	Vector3 d = a - b;
+	return d.dot(d);
+}
+
+// heap order for the node queue, nearest on top
+//
+static bool fartherNode(const NearNode & a, const NearNode & b) {
+	return a.d2 > b.d2;
+}
+
+// The mesh point nearest p, or -1 if there's none within maxDist
+//
+int Octree::nearest(const Vector3 & p, float maxDist) const {
+	vector<int> points;
+	if (nearest(p, 1, points, maxDist) == 0) return -1;
+	return points[0];
+}
+
+// The k mesh points nearest p and within maxDist, nearest first.  Nodes
+// are visited in order of distance from p, and once k points are found
+// the search radius shrinks to the kth one, so only the nodes around p
+// are opened
+//
+int Octree::nearest(const Vector3 & p, int k, vector<int> & pointsRtn, float maxDist) const {
+	pointsRtn.clear();
+	if (k <= 0 || bUseFaces || mesh.getNumVertices() == 0) return 0;
+	Vector3View verts = vertices();
+	float bound = maxDist * maxDist;
+	vector<NearNode> nearQueue;			// nodes still to look at
+	vector<pair<float, int>> nearBest;	// the k best points, as a max heap
+	nearQueue.reserve(64);
+	nearBest.reserve(k);
+
+	auto push = [&](const TreeNode *node, int index, const Box & box) {
+		float d2 = nearDistance2(box, p);
+		if (d2 > bound) return;
+		nearQueue.push_back({ d2, node, index, box });
+		push_heap(nearQueue.begin(), nearQueue.end(), fartherNode);
+	};
+	auto add = [&](int i) {
+		float d2 = distance2(verts[i], p);
+		if (d2 > bound) return;
+		nearBest.push_back(make_pair(d2, i));
+		push_heap(nearBest.begin(), nearBest.end());
+		if (nearBest.size() > k) {
+			pop_heap(nearBest.begin(), nearBest.end());
+			nearBest.pop_back();
+		}
+		if (nearBest.size() == k) bound = nearBest.front().first;
+	};
+
+	push(isCompact() ? NULL : &root, 0, root.box);
+	while (!nearQueue.empty()) {
+		pop_heap(nearQueue.begin(), nearQueue.end(), fartherNode);
+		NearNode n = nearQueue.back();
+		nearQueue.pop_back();
+		if (n.d2 > bound) break;		// everything left is farther still
+
+		if (n.node == NULL) {
+			const CompactNode & node = nodes[n.index];
+			if (node.numPoints > 0) {
+				for (uint32_t i = 0; i < node.numPoints; i++)
+					add(leafPoints[node.firstPoint + i]);
+				continue;
+			}
+			int child = node.firstChild;
+			for (int o = 0; o < 8; o++) {
+				if (!(node.childMask & (1 << o))) continue;
+				push(NULL, child++, octantBox(n.box, o));
+			}
+		}
+		else if (n.node->children.empty() || n.node->points.size() == 1) {
+			for (int i = 0; i < n.node->points.size(); i++)
+				add(n.node->points[i]);
+		}
+		else {
+			for (int i = 0; i < n.node->children.size(); i++)
+				push(&n.node->children[i], 0, n.node->children[i].box);
+		}
+	}
+
+	sort_heap(nearBest.begin(), nearBest.end());
+	for (int i = 0; i < nearBest.size(); i++)
+		pointsRtn.push_back(nearBest[i].second);
+	return pointsRtn.size();
+}
+
+// Every mesh point within radius of p, in no particular order
+//
+int Octree::pointsInRadius(const Vector3 & p, float radius, vector<int> & pointsRtn) const {
+	pointsRtn.clear();
+	if (bUseFaces || mesh.getNumVertices() == 0) return 0;
+	if (isCompact()) radiusSearchCompact(0, root.box, p, radius * radius, pointsRtn);
+	else radiusSearch(root, p, radius * radius, pointsRtn);
+	return pointsRtn.size();
+}
+
+// nodes wholly inside the sphere take all their points without testing
+// each one
+//
+void Octree::radiusSearch(const TreeNode & node, const Vector3 & p, float r2, vector<int> & pointsRtn) const {
+	if (nearDistance2(node.box, p) > r2) return;
+	if (farDistance2(node.box, p) <= r2) {
+		pointsRtn.insert(pointsRtn.end(), node.points.begin(), node.points.end());
+		return;
+	}
+	if (node.children.empty() || node.points.size() == 1) {
+		Vector3View verts = vertices();
+		for (int i = 0; i < node.points.size(); i++)
+			if (distance2(verts[node.points[i]], p) <= r2) pointsRtn.push_back(node.points[i]);
+		return;
+	}
+	for (int i = 0; i < node.children.size(); i++)
+		radiusSearch(node.children[i], p, r2, pointsRtn);
+}
+
+void Octree::radiusSearchCompact(int index, const Box & box, const Vector3 & p, float r2, vector<int> & pointsRtn) const {
+	if (nearDistance2(box, p) > r2) return;
+	const CompactNode & node = nodes[index];
+	if (node.numPoints > 0) {
+		Vector3View verts = vertices();
+		for (uint32_t i = node.firstPoint; i < node.firstPoint + node.numPoints; i++)
+			if (distance2(verts[leafPoints[i]], p) <= r2) pointsRtn.push_back(leafPoints[i]);
+		return;
+	}
+	int child = node.firstChild;
+	for (int o = 0; o < 8; o++) {
+		if (!(node.childMask & (1 << o))) continue;
+		radiusSearchCompact(child++, octantBox(box, o), p, r2, pointsRtn);
+	}
+}
+
+// Every mesh point inside box, in no particular order.  Only reads the
+// tree, so threads can search it at the same time
+//
+int Octree::pointsInBox(const Box & box, vector<int> & pointsRtn) const {
+	pointsRtn.clear();
+	if (bUseFaces || mesh.getNumVertices() == 0) return 0;
+	if (isCompact()) boxSearchCompact(0, root.box, box, pointsRtn);
+	else boxSearch(root, box, pointsRtn);
+	return pointsRtn.size();
+}
+
+void Octree::boxSearch(const TreeNode & node, const Box & box, vector<int> & pointsRtn) const {
+	if (!box.overlap(node.box)) return;
+	if (box.inside(node.box.min()) && box.inside(node.box.max())) {
+		pointsRtn.insert(pointsRtn.end(), node.points.begin(), node.points.end());
+		return;
+	}
+	if (node.children.empty() || node.points.size() == 1) {
+		Vector3View verts = vertices();
+		for (int i = 0; i < node.points.size(); i++)
+			if (box.inside(verts.point(node.points[i]))) pointsRtn.push_back(node.points[i]);
+		return;
+	}
+	for (int i = 0; i < node.children.size(); i++)
+		boxSearch(node.children[i], box, pointsRtn);
+}
+
+void Octree::boxSearchCompact(int index, const Box & nodeBox, const Box & box, vector<int> & pointsRtn) const {
+	if (!box.overlap(nodeBox)) return;
+	const CompactNode & node = nodes[index];
+	if (node.numPoints > 0) {
+		Vector3View verts = vertices();
+		for (uint32_t i = node.firstPoint; i < node.firstPoint + node.numPoints; i++)
+			if (box.inside(verts.point(leafPoints[i]))) pointsRtn.push_back(leafPoints[i]);
+		return;
+	}
+	int child = node.firstChild;
+	for (int o = 0; o < 8; o++) {
+		if (!(node.childMask & (1 << o))) continue;
+		boxSearchCompact(child++, octantBox(nodeBox, o), box, pointsRtn);
+	}
+}
@@ -22,31 +22,108 @@ public:
 	vector<TreeNode> children;
 };
 
+// Node of a compacted tree.  A child's box is always one of the eight
+// octants of its parent's (see subDivideBox8), so boxes aren't stored;
+// they are rebuilt from the root box on the way down.  The children of
+// a node are stored together, in octant order.  A leaf's points (more
+// than one only for duplicates at the deepest level) are a range of
+// Octree::leafPoints
+//
+class CompactNode {
+public:
+	uint32_t firstChild = 0;		// index of the first child in nodes
+	uint32_t firstPoint = 0;		// index of a leaf's first point in leafPoints
+	uint32_t numPoints = 0;			// 0 for a node with children
+	uint8_t childMask = 0;			// bit i is set if octant i has a child
+};
+
+// A node waiting in a nearest point search, with the squared distance
+// from the query point to its box
+//
+class NearNode {
+public:
+	float d2;
+	const TreeNode *node;			// NULL in a compacted tree
+	int index;						// into nodes, in a compacted tree
+	Box box;
+};
+
 class Octree {
 public:
 	
 	void create(const ofMesh & mesh, int numLevels);
+	void create(ofMesh && mesh, int numLevels);
+	void build(int numLevels);
+	void createMorton(const ofMesh & mesh, int numLevels);
+	void createMorton(ofMesh && mesh, int numLevels);
+	void buildMorton(int numLevels);
 	void subdivide(const ofMesh & mesh, TreeNode & node, int numLevels, int level);
-	bool intersect(const Ray &, const TreeNode & node, TreeNode & nodeRtn);
-	bool intersect(const Box &, TreeNode & node, vector<Box> & boxListRtn);
+	void subdivideFaces(const ofMesh & mesh, TreeNode & node, int numLevels, int level);
+	bool checkPoints(int & lostRtn, int & duplicatedRtn) const;
+	bool intersect(const Ray &, const TreeNode & node, TreeNode & nodeRtn) const;
+	bool intersect(const Box &, const TreeNode & node, vector<Box> & boxListRtn);
 	bool intersect();
 	void draw(TreeNode & node, int numLevels, int level);
 	void draw(int numLevels, int level) {
-		draw(root, numLevels, level);
+		if (isCompact()) drawCompact(0, root.box, numLevels, level);
+		else draw(root, numLevels, level);
 	}
+
+	// whole tree queries, through the compacted nodes once compact()
+	// has been called
+	//
+	bool intersect(const Ray &, int & pointRtn) const;
+	bool intersect(const Box &, vector<Box> & boxListRtn);
+
+	// proximity queries on either layout, returning mesh indices.  The
+	// nearest point searches are best-first, so they stop as soon as no
+	// node left can hold anything closer.  They only read the tree, so
+	// threads can search it at the same time
+	//
+	int nearest(const Vector3 & p, float maxDist = FLT_MAX) const;
+	int nearest(const Vector3 & p, int k, vector<int> & pointsRtn, float maxDist = FLT_MAX) const;
+	int pointsInRadius(const Vector3 & p, float radius, vector<int> & pointsRtn) const;
+	int pointsInBox(const Box & box, vector<int> & pointsRtn) const;
+
+	int carve(const Vector3 & center, float radius, float depth, vector<int> & movedRtn, Box & regionRtn);
+	TreeNode & nodeContaining(const Box & box, int & levelRtn);
+
+	void compact();
+	bool isCompact() const { return !nodes.empty(); }
+	size_t nodeBytes() const;
+	static Box octantBox(const Box & box, int octant);
 	void drawLeafNodes(TreeNode & node);
 	static void drawBox(const Box &box);
 	static Box meshBounds(const ofMesh &);
-	int getMeshPointsInBox(const ofMesh &mesh, const vector<int> & points, Box & box, vector<int> & pointsRtn);
-	int getMeshFacesInBox(const ofMesh &mesh, const vector<int> & faces, Box & box, vector<int> & facesRtn);
+	int getMeshPointsInBox(const ofMesh &mesh, const vector<int> & points, const Box & box, vector<int> & pointsRtn);
+	int getMeshFacesInBox(const ofMesh &mesh, const vector<int> & faces, const Box & box, vector<int> & facesRtn);
 	void subDivideBox8(const Box &b, vector<Box> & boxList);
 
 	ofMesh mesh;
+	Vector3View vertices() const { return Vector3View(mesh.getVertices()); }
 	TreeNode root;
+	vector<CompactNode> nodes;		// nodes[0] is the root, once compacted
+	vector<uint32_t> leafPoints;	// mesh indices of the compacted leaves' points
+	int levels = 0;					// numLevels the tree was built with
 	bool bUseFaces = false;
 
 	// debug;
 	//
 	int strayVerts= 0;
 	int numLeaf = 0;
+	int unmatchedChildren = 0;			// tree children compact() couldn't place
+	vector<uint8_t> octantScratch;		// subdivide()'s octant per point
+
+private:
+	void sortVertices(const vector<int> & order);
+	void subdivideMorton(TreeNode & node, const vector<uint64_t> & keys, int begin, int end,
+		int level, int numLevels, int bits);
+	void compactNode(const TreeNode & node, int index);
+	bool intersectCompact(const Ray &, int index, const Box & box, int & pointRtn) const;
+	bool intersectCompact(const Box &, int index, const Box & box, vector<Box> & boxListRtn) const;
+	void drawCompact(int index, const Box & box, int numLevels, int level);
+	void radiusSearch(const TreeNode & node, const Vector3 & p, float r2, vector<int> & pointsRtn) const;
+	void radiusSearchCompact(int index, const Box & box, const Vector3 & p, float r2, vector<int> & pointsRtn) const;
+	void boxSearch(const TreeNode & node, const Box & box, vector<int> & pointsRtn) const;
+	void boxSearchCompact(int index, const Box & nodeBox, const Box & box, vector<int> & pointsRtn) const;
 };
\ No newline at end of file
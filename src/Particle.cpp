@@ -8,6 +8,7 @@ Particle::Particle() {
 	velocity.set(0, 0, 0);
 	acceleration.set(0, 0, 0);
 	position.set(0, 0, 0);
+	lastPosition.set(0, 0, 0);
 	forces.set(0, 0, 0);
 	lifespan = 5;
 	birthtime = 0;
@@ -34,6 +35,7 @@ void Particle::integrate() {
 
 	// update position based on velocity
 	//
+	lastPosition = position;
 	position += (velocity * dt);
 
 	// update acceleration with accumulated paritcles forces
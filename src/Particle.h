@@ -9,6 +9,7 @@ public:
 	Particle();
 
 	ofVec3f position;
+	ofVec3f lastPosition;	// position before the last integrate()
 	ofVec3f velocity;
 	ofVec3f acceleration;
 	ofVec3f forces;
@@ -0,0 +1,37 @@
+#pragma once
+
+//  Filling a frame's particle batch: positions and faded colors packed
+//  for one draw.  Kept free of openFrameworks (templates over the
+//  particle, position and color types) so what goes into the vbo can be
+//  checked without a GL context; ParticleVertexStream::pack calls it
+//  with Particle, glm::vec3 and ofFloatColor.
+//
+
+// how much of a particle is left "age" seconds into "lifespan": 1 at
+// birth down to 10/255 at the end, the ramp Particle::draw() used.
+// Particles with no lifespan don't fade
+//
+inline float particleFade(float age, float lifespan) {
+	if (lifespan <= 0) return 1;
+	float t = age / lifespan;
+	if (t < 0) t = 0;
+	if (t > 1) t = 1;
+	return 1 + t * (10 / 255.0f - 1);
+}
+
+// write count particles into positions and colors.  Only alpha fades:
+// the particles are drawn with additive SRC_ALPHA blending, which
+// already scales the color by alpha, so fading the color as well would
+// dim them with the square of the fade.  "time" is in ms, the clock of
+// the particles' birthtime
+//
+template<typename P, typename V, typename C>
+void fillParticleBatch(const P *particles, int count, float time, V *positions, C *colors) {
+	for (int i = 0; i < count; i++) {
+		const P & p = particles[i];
+		positions[i] = V(p.position.x, p.position.y, p.position.z);
+		C c(p.color);
+		c.a *= particleFade((time - p.birthtime) / 1000.0f, p.lifespan);
+		colors[i] = c;
+	}
+}
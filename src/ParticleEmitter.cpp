@@ -40,9 +40,12 @@ void ParticleEmitter::init() {
 	lastSpawned = 0;
 	radius = 1;
 	particleRadius = .1;
+	particleColor = ofColor::aquamarine;
 	visible = true;
 	type = DirectionalEmitter;
 	groupSize = 1;
+	maxParticles = -1;
+	spawnBudget = NULL;
 	damping = .99;
 }
 
@@ -111,6 +114,11 @@ void ParticleEmitter::update() {
 //
 void ParticleEmitter::spawn(float time) {
 
+	// stay within the particle budget
+	//
+	if (maxParticles >= 0 && sys->particles.size() >= maxParticles) return;
+	if (spawnBudget != NULL && !spawnBudget->take()) return;
+
 	Particle particle;
 
 	// set initial velocity and position
@@ -145,6 +153,7 @@ void ParticleEmitter::spawn(float time) {
 	else particle.lifespan = lifespan;
 	particle.birthtime = time;
 	particle.radius = particleRadius;
+	particle.color = particleColor;
 	particle.mass = mass;
 	particle.damping = damping;
 
@@ -6,6 +6,26 @@
 
 typedef enum { DirectionalEmitter, RadialEmitter, SphereEmitter, DiscEmitter } EmitterType;
 
+//  Particles every emitter sharing it may spawn in one frame, together.
+//  The count starts over when the frame number changes
+//
+class SpawnBudget {
+public:
+	bool take() {
+		uint64_t frame = ofGetFrameNum();
+		if (frame != lastFrame) {
+			lastFrame = frame;
+			spawned = 0;
+		}
+		if (maxPerFrame >= 0 && spawned >= maxPerFrame) return false;
+		spawned++;
+		return true;
+	}
+	int maxPerFrame = -1;		// -1 for no limit
+	int spawned = 0;			// this frame
+	uint64_t lastFrame = -1;
+};
+
 //  General purpose Emitter class for emitting sprites
 //  This works similar to a Particle emitter
 //
@@ -29,6 +49,7 @@ public:
 	void setLifespanRange(const ofVec2f &r) { lifeMinMax = r; }
 	void setMass(float m) { mass = m; }
 	void setDamping(float d) { damping = d; }
+	void setParticleColor(const ofColor &c) { particleColor = c; }
 	void update();
 	void spawn(float time);
 	ParticleSystem *sys;
@@ -44,9 +65,12 @@ public:
 	bool started;
 	float lastSpawned;  // ms
 	float particleRadius;
+	ofColor particleColor;
 	float radius;
 	bool visible;
 	int groupSize;      // number of particles to spawn in a group
+	int maxParticles;   // cap on live particles in sys, -1 for no limit
+	SpawnBudget *spawnBudget;	// shared cap on particles spawned per frame, NULL for none
 	bool createdSys;
 	EmitterType type;
 };
@@ -0,0 +1,70 @@
+
+#include "ParticleGrid.h"
+
+ParticleGrid::ParticleGrid() {
+	cellSize = 1.0;
+	tableSize = 0;
+	numParticles = 0;
+}
+
+// hash integer cell coordinates into the table (Teschner et al. primes)
+//
+int ParticleGrid::hashCell(int ix, int iy, int iz) const {
+	unsigned int h = ((unsigned int)ix * 73856093u) ^ ((unsigned int)iy * 19349663u) ^ ((unsigned int)iz * 83492791u);
+	return (int)(h & (unsigned int)(tableSize - 1));
+}
+
+// rebuild the hash from the current particle positions.  This is a
+// counting sort: count particles per bucket, prefix sum the counts into
+// bucket end offsets, then scatter the particle indices.
+//
+void ParticleGrid::build(const vector<Particle> & particles) {
+	numParticles = particles.size();
+	if (numParticles == 0) return;
+
+	// size the table to roughly twice the particle count so that most
+	// buckets hold a single cell.  Only grow, never shrink, so that the
+	// buffers are reused from step to step.
+	//
+	int wanted = 1;
+	while (wanted < 2 * numParticles) wanted <<= 1;
+	if (wanted > tableSize) {
+		tableSize = wanted;
+		cellStart.resize(tableSize + 1);
+	}
+	if ((int)particleHash.size() < numParticles) {
+		particleHash.resize(numParticles);
+		cellEntries.resize(numParticles);
+	}
+
+	std::fill(cellStart.begin(), cellStart.end(), 0);
+	for (int i = 0; i < numParticles; i++) {
+		const ofVec3f & p = particles[i].position;
+		int h = hashCell(cellCoord(p.x), cellCoord(p.y), cellCoord(p.z));
+		particleHash[i] = h;
+		cellStart[h]++;
+	}
+	for (int h = 1; h < tableSize; h++) {
+		cellStart[h] += cellStart[h - 1];
+	}
+	cellStart[tableSize] = numParticles;
+
+	// scatter; walk backwards decrementing each bucket's end offset, which
+	// leaves cellStart[h] at the start of bucket h when we are done
+	//
+	for (int i = numParticles - 1; i >= 0; i--) {
+		cellEntries[--cellStart[particleHash[i]]] = i;
+	}
+}
+
+// collect the indices of all particles within "dist" of point.
+// Return count of particles found;
+//
+int ParticleGrid::query(const vector<Particle> & particles, const ofVec3f & point, float dist, vector<int> & indicesRtn) const {
+	int count = 0;
+	forEachNeighbor(particles, point, dist, [&](int i) {
+		indicesRtn.push_back(i);
+		count++;
+	});
+	return count;
+}
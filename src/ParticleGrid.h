@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Particle.h"
+
+//  Spatial hash over the live particles of a ParticleSystem.
+//
+//  Particles are binned into cubic cells of size "cellSize" and the cells
+//  are hashed into a table sized to the particle count.  The table is
+//  stored as a counting sort (cellStart/cellEntries).  It isn't updated
+//  as particles move: ParticleSystem rebuilds the whole table, lazily,
+//  on the first query after particles were moved, added or removed.  A
+//  rebuild is a single O(n) pass that reuses the buffers from the last
+//  one and does not allocate once they have grown to the working set.
+//
+class ParticleGrid {
+public:
+	ParticleGrid();
+	void setCellSize(float s) { cellSize = s; }
+	void build(const vector<Particle> & particles);
+	int query(const vector<Particle> & particles, const ofVec3f & point, float dist, vector<int> & indicesRtn) const;
+
+	// call f(index) for every particle within "dist" of point
+	//
+	template<typename F>
+	void forEachNeighbor(const vector<Particle> & particles, const ofVec3f & point, float dist, F f) const;
+
+	int hashCell(int ix, int iy, int iz) const;
+	int cellCoord(float v) const { return (int)floor(v / cellSize); }
+
+	float cellSize;
+	int tableSize;				// always a power of two
+	vector<int> cellStart;		// tableSize + 1 offsets into cellEntries
+	vector<int> cellEntries;	// particle indices sorted by hash bucket
+	vector<int> particleHash;	// hash bucket of each particle
+	int numParticles;
+};
+
+template<typename F>
+void ParticleGrid::forEachNeighbor(const vector<Particle> & particles, const ofVec3f & point, float dist, F f) const {
+	if (numParticles == 0 || numParticles != (int)particles.size()) return;
+
+	float dist2 = dist * dist;
+	int x0 = cellCoord(point.x - dist), x1 = cellCoord(point.x + dist);
+	int y0 = cellCoord(point.y - dist), y1 = cellCoord(point.y + dist);
+	int z0 = cellCoord(point.z - dist), z1 = cellCoord(point.z + dist);
+
+	// a query box wider than the table would visit the same buckets
+	// over and over; fall back to a linear scan in that case
+	//
+	long long cells = (long long)(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1);
+	if (cells > tableSize) {
+		for (int i = 0; i < numParticles; i++) {
+			if (particles[i].position.squareDistance(point) <= dist2) f(i);
+		}
+		return;
+	}
+
+	for (int ix = x0; ix <= x1; ix++) {
+		for (int iy = y0; iy <= y1; iy++) {
+			for (int iz = z0; iz <= z1; iz++) {
+				int h = hashCell(ix, iy, iz);
+				for (int k = cellStart[h]; k < cellStart[h + 1]; k++) {
+					int i = cellEntries[k];
+
+					// buckets are shared by colliding cells, so check the
+					// particle really lives in (ix, iy, iz) before testing
+					// distance, otherwise it could be reported twice
+					//
+					const ofVec3f & p = particles[i].position;
+					if (cellCoord(p.x) != ix || cellCoord(p.y) != iy || cellCoord(p.z) != iz) continue;
+					if (p.squareDistance(point) <= dist2) f(i);
+				}
+			}
+		}
+	}
+}
@@ -2,17 +2,34 @@
 // Kevin M.Smith - CS 134 SJSU
 
 #include "ParticleSystem.h"
+#include "Util.h"
+#include "Profiler.h"
 
 void ParticleSystem::add(const Particle &p) {
 	particles.push_back(p);
+	gridDirty = true;
 }
 
 void ParticleSystem::addForce(ParticleForce *f) {
 	forces.push_back(f);
 }
 
+// the system shares ownership of the force, so it stays valid for as
+// long as the system uses it, whoever else lets go of it
+//
+void ParticleSystem::addForce(const shared_ptr<ParticleForce> & f) {
+	sharedForces.push_back(f);
+	forces.push_back(f.get());
+}
+
+void ParticleSystem::clearForces() {
+	forces.clear();
+	sharedForces.clear();
+}
+
 void ParticleSystem::remove(int i) {
 	particles.erase(particles.begin() + i);
+	gridDirty = true;
 }
 
 void ParticleSystem::setLifespan(float l) {
@@ -28,23 +45,27 @@ void ParticleSystem::reset() {
 }
 
 void ParticleSystem::update() {
-	// check if empty and just return
-	if (particles.size() == 0) return;
+	PROFILE_SCOPE("particles/update");
 
-	vector<Particle>::iterator p = particles.begin();
-	vector<Particle>::iterator tmp;
+	// check if empty and just return
+	if (particles.size() == 0) {
+		gridDirty = true;
+		return;
+	}
 
-	// check which particles have exceed their lifespan and delete
-	// from list.  When deleting multiple objects from a vector while
-	// traversing at the same time, we need to use an iterator.
+	// check which particles have exceed their lifespan and delete them
+	// from the list, flagging them first and compacting the survivors in
+	// one pass rather than erasing one at a time
 	//
-	while (p != particles.end()) {
-		if (p->lifespan != -1 && p->age() > p->lifespan) {
-			tmp = particles.erase(p);
-			p = tmp;
+	bool anyExpired = false;
+	kill.assign(particles.size(), false);
+	for (int i = 0; i < particles.size(); i++) {
+		if (particles[i].lifespan != -1 && particles[i].age() > particles[i].lifespan) {
+			kill[i] = true;
+			anyExpired = true;
 		}
-		else p++;
 	}
+	if (anyExpired) removeFlagged(kill);
 
 	// update forces on all particles first 
 	//
@@ -68,18 +89,159 @@ void ParticleSystem::update() {
 	for (int i = 0; i < particles.size(); i++)
 		particles[i].integrate();
 
+	// push back (or kill) anything that went into the ground
+	//
+	collideTerrain();
+
+	// positions have all moved; the grid is rebuilt by the next query,
+	// so steps nothing asks about don't pay for it
+	//
+	gridDirty = true;
 }
 
-// remove all particlies within "dist" of point (not implemented as yet)
+// test every particle's last step against the terrain in one batch.
+// Long steps are walked in height field cell sized pieces (stepSize())
+// so a fast particle can't tunnel through a ridge.  The cell's highest
+// triangle rules most points out; the rest are tested against the
+// triangle under them, whose normal the particle bounces off
 //
-int ParticleSystem::removeNear(const ofVec3f & point, float dist) { return 0; }
+void ParticleSystem::collideTerrain() {
+	numCollisions = 0;
+	collisionTime = 0;
+	if (terrain == NULL || !terrain->isCreated()) return;
+	PROFILE_SCOPE("particles/collide");
+
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	float step = terrain->stepSize();
+	bool anyKilled = false;
+	if (killOnCollide) kill.assign(particles.size(), false);
 
-//  draw the particle cloud
+	for (int i = 0; i < particles.size(); i++) {
+		Particle & p = particles[i];
+		if (!terrain->inBounds(p.position.x, p.position.z)) continue;
+
+		ofVec3f seg = p.position - p.lastPosition;
+		int n = MAX(1, (int)ceil(seg.length() / step));
+		bool hit = false;
+		ofVec3f q, norm;
+		float ground;
+		for (int k = 1; k <= n && !hit; k++) {
+			q = p.lastPosition + seg * ((float)k / n);
+			if (q.y >= terrain->maxHeight(q.x, q.z)) continue;
+			hit = terrain->getGround(q.x, q.z, ground, norm) && q.y < ground;
+		}
+		if (!hit) continue;
+
+		numCollisions++;
+		if (killOnCollide) {
+			kill[i] = true;
+			anyKilled = true;
+		}
+		else {
+			p.position.set(q.x, ground, q.z);
+			if (p.velocity.dot(norm) < 0)
+				p.velocity = reflectVector(p.velocity, norm) * restitution;
+		}
+	}
+
+	if (anyKilled) removeFlagged(kill);
+	collisionTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+}
+
+// rebuild the spatial hash if particles were moved, added or removed
+// since it was last built
 //
-void ParticleSystem::draw() {
+void ParticleSystem::updateGrid() {
+	if (gridDirty) {
+		grid.build(particles);
+		gridDirty = false;
+	}
+}
+
+// return indices of all particles within "dist" of point
+//
+int ParticleSystem::getNear(const ofVec3f & point, float dist, vector<int> & indicesRtn) {
+	updateGrid();
+	return grid.query(particles, point, dist, indicesRtn);
+}
+
+// remove all particlies within "dist" of point.  Return number removed.
+//
+int ParticleSystem::removeNear(const ofVec3f & point, float dist) {
+	updateGrid();
+
+	// flag the neighbors, then compact the survivors in a single pass
+	// rather than erasing one at a time
+	//
+	kill.assign(particles.size(), false);
+	int count = 0;
+	grid.forEachNeighbor(particles, point, dist, [&](int i) {
+		kill[i] = true;
+		count++;
+	});
+	if (count == 0) return 0;
+
+	removeFlagged(kill);
+	return count;
+}
+
+// remove all particles flagged in "kill", compacting the survivors
+// in place in a single pass
+//
+void ParticleSystem::removeFlagged(const vector<bool> & kill) {
+	int n = 0;
 	for (int i = 0; i < particles.size(); i++) {
-		particles[i].draw();
+		if (!kill[i]) {
+			if (n != i) particles[n] = particles[i];
+			n++;
+		}
+	}
+	particles.resize(n);
+	gridDirty = true;
+}
+
+// allocate the streaming vbo once; "capacity" is the most particles
+// drawn in a frame.  Point size only changes with another setupVbo(), so
+// normals are uploaded once.
+//
+void ParticleSystem::setupVbo(int capacity, float size) {
+	pointSize = size;
+	stream.setup(capacity);
+	int total = stream.totalVertices();
+	vector<glm::vec3> sizes(total, glm::vec3(pointSize));
+	vbo.clear();
+	vbo.setVertexData(&stream.positions[0], total, GL_DYNAMIC_DRAW);
+	vbo.setColorData(&stream.colors[0], total, GL_DYNAMIC_DRAW);
+	vbo.setNormalData(&sizes[0], total, GL_STATIC_DRAW);
+}
+
+// pack the particles into the next segment of the stream and upload
+// only that sub-range
+//
+void ParticleSystem::loadVbo() {
+	if (stream.capacity == 0) setupVbo(4096, 5);
+
+	stream.pack(particles, ofGetElapsedTimeMillis());
+	if (stream.count < 1) return;
+
+	vbo.getVertexBuffer().updateData(stream.first * sizeof(glm::vec3),
+		stream.count * sizeof(glm::vec3), &stream.positions[stream.first]);
+	vbo.getColorBuffer().updateData(stream.first * sizeof(ofFloatColor),
+		stream.count * sizeof(ofFloatColor), &stream.colors[stream.first]);
+}
+
+//  draw the particle cloud in a single call.  The vbo is only loaded on
+//  the first draw of a frame, so drawing in several viewports is cheap.
+//
+void ParticleSystem::draw() {
+	drawCalls = 0;
+	if (loadedFrame != ofGetFrameNum()) {
+		loadVbo();
+		loadedFrame = ofGetFrameNum();
 	}
+	if (stream.count < 1) return;
+	vbo.draw(GL_POINTS, stream.first, stream.count);
+	drawCalls++;
 }
 
 
@@ -3,6 +3,9 @@
 
 #include "ofMain.h"
 #include "Particle.h"
+#include "ParticleGrid.h"
+#include "HeightField.h"
+#include "ParticleVertexStream.h"
 
 
 //  Pure Virtual Function Class - must be subclassed to create new forces.
@@ -19,14 +22,58 @@ class ParticleSystem {
 public:
 	void add(const Particle &);
 	void addForce(ParticleForce *);
+	void addForce(const shared_ptr<ParticleForce> &);
+	void clearForces();
 	void remove(int);
 	void update();
 	void setLifespan(float);
 	void reset();
 	int removeNear(const ofVec3f & point, float dist);
+	void removeFlagged(const vector<bool> & kill);
+	int getNear(const ofVec3f & point, float dist, vector<int> & indicesRtn);
+	template<typename F>
+	void forEachNear(const ofVec3f & point, float dist, F f) {
+		updateGrid();
+		grid.forEachNeighbor(particles, point, dist, f);
+	}
+	void updateGrid();
+	void collideTerrain();
+	void setupVbo(int capacity, float pointSize);
+	void loadVbo();
 	void draw();
 	vector<Particle> particles;
 	vector<ParticleForce *> forces;
+	vector<shared_ptr<ParticleForce>> sharedForces;	// keeps forces added by shared_ptr alive
+
+	// spatial hash over "particles"; built lazily by the first query
+	// after update() moves them or particles are added or removed
+	//
+	ParticleGrid grid;
+	bool gridDirty = true;
+
+	// terrain collision; particles crossing the ground are either
+	// bounced (scaled by restitution) off the ground's triangle or removed
+	// if killOnCollide is set
+	//
+	HeightSource *terrain = NULL;
+	float restitution = 0.3;
+	bool killOnCollide = false;
+
+	// collision stats for the last update()
+	//
+	int numCollisions = 0;
+	float collisionTime = 0;	// ms
+
+	vector<bool> kill;			// particles flagged for removeFlagged(), reused
+
+	// batched rendering; the whole system is drawn as point sprites from
+	// one streaming vbo, the caller binds the sprite shader and texture
+	//
+	ParticleVertexStream stream;
+	ofVbo vbo;
+	float pointSize = 0;		// sprite size the vbo was set up with
+	int drawCalls = 0;			// issued by the last draw()
+	uint64_t loadedFrame = -1;	// frame the vbo was last loaded
 };
 
 
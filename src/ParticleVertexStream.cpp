@@ -0,0 +1,45 @@
+
+#include "ParticleVertexStream.h"
+#include "ParticleBatch.h"
+
+ParticleVertexStream::ParticleVertexStream() {
+	capacity = 0;
+	numSegments = 0;
+	segment = 0;
+	first = 0;
+	count = 0;
+	bytesCopied = 0;
+	allocations = 0;
+	dropped = 0;
+}
+
+// size the ring once; "capacity" is the most vertices drawn in one frame
+//
+void ParticleVertexStream::setup(int cap, int segments) {
+	capacity = cap;
+	numSegments = segments;
+	segment = numSegments - 1;
+	first = 0;
+	count = 0;
+	positions.assign(totalVertices(), glm::vec3(0, 0, 0));
+	colors.assign(totalVertices(), ofFloatColor(0, 0, 0, 0));
+	allocations = 2;
+}
+
+// write particle positions and colors into the next ring segment.
+// Particles fade out over their lifespan (fillParticleBatch); "time" is
+// the current time in ms, same clock as Particle::birthtime.
+// Return the index of the first vertex written.
+//
+int ParticleVertexStream::pack(const vector<Particle> & particles, float time) {
+	allocations = 0;
+	segment = (segment + 1) % numSegments;
+	first = segment * capacity;
+	count = MIN((int)particles.size(), capacity);
+	dropped = particles.size() - count;
+
+	if (count > 0)
+		fillParticleBatch(&particles[0], count, time, &positions[first], &colors[first]);
+	bytesCopied = count * (sizeof(glm::vec3) + sizeof(ofFloatColor));
+	return first;
+}
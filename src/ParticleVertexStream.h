@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Particle.h"
+
+//  CPU side of a streaming particle vertex buffer (positions and colors).
+//
+//  The buffer is split into "numSegments" equal segments used as a ring:
+//  each frame's particles are packed into the next segment, so the GPU can
+//  still be reading last frame's vertices while this frame's are written.
+//  Storage is sized once in setup() and never reallocated.  Nothing in
+//  here touches GL, so packing can be exercised without a context; the
+//  owner uploads [first, first + count) as a sub-range of its vbo.
+//
+class ParticleVertexStream {
+public:
+	ParticleVertexStream();
+	void setup(int capacity, int numSegments = 3);
+	int pack(const vector<Particle> & particles, float time);	// time in ms
+	int totalVertices() const { return capacity * numSegments; }
+
+	vector<glm::vec3> positions;	// capacity * numSegments
+	vector<ofFloatColor> colors;	// particle color, alpha faded by age
+	int capacity;					// max vertices per frame
+	int numSegments;
+	int segment;					// segment written by the last pack()
+	int first;						// first vertex written by the last pack()
+	int count;						// vertices written by the last pack()
+
+	// stats for the last pack()
+	//
+	size_t bytesCopied;
+	int allocations;
+	int dropped;					// particles past capacity
+};
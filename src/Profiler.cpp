@@ -0,0 +1,164 @@
+
+#include "Profiler.h"
+
+Profiler & Profiler::get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+// hands a thread's ring buffer back to the profiler when the thread exits
+//
+class ProfileThreadSlot {
+public:
+	~ProfileThreadSlot() { if (t != NULL) Profiler::get().retire(t); }
+	ProfileThread *t = NULL;
+};
+
+// this thread's ring buffer, made the first time the thread records
+//
+ProfileThread * Profiler::thread() {
+	static thread_local ProfileThreadSlot slot;
+	if (slot.t == NULL) {
+		lock_guard<std::mutex> lock(mutex);
+		threads.push_back(unique_ptr<ProfileThread>(new ProfileThread(nextId++)));
+		slot.t = threads.back().get();
+		slot.t->name = "thread " + ofToString(slot.t->id);
+	}
+	return slot.t;
+}
+
+// free the ring buffer of a thread that is exiting; its samples are
+// dropped from later exports
+//
+void Profiler::retire(ProfileThread *t) {
+	lock_guard<std::mutex> lock(mutex);
+	for (int i = 0; i < threads.size(); i++) {
+		if (threads[i].get() == t) {
+			threads.erase(threads.begin() + i);
+			break;
+		}
+	}
+}
+
+void Profiler::record(const char *name, uint64_t start, uint64_t end) {
+	ProfileSample sample;
+	sample.name = name;
+	sample.start = start;
+	sample.duration = end - start;
+	sample.frame = frame.load(std::memory_order_relaxed);
+	thread()->record(sample);
+}
+
+// name the calling thread in exports
+//
+void Profiler::setThreadName(const string & name) {
+	ProfileThread *t = thread();
+	lock_guard<std::mutex> lock(mutex);
+	t->name = name;
+}
+
+// The samples still in t's ring buffer, oldest first.  t's thread keeps
+// recording while this copies, so head is read again afterwards and
+// any sample whose slot the thread may have been writing over during
+// the copy (including the slot of the sample it hasn't published yet)
+// is dropped rather than returned torn
+//
+vector<ProfileSample> Profiler::snapshot(ProfileThread & t) {
+	uint64_t head = t.head.load(std::memory_order_acquire);
+	uint64_t first = head > ProfileThread::ringSize ? head - ProfileThread::ringSize : 0;
+	vector<ProfileSample> samples;
+	samples.reserve(head - first);
+	for (uint64_t i = first; i < head; i++)
+		samples.push_back(t.samples[i & (ProfileThread::ringSize - 1)]);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t after = t.head.load(std::memory_order_relaxed);
+	uint64_t valid = after >= ProfileThread::ringSize ? after - ProfileThread::ringSize + 1 : 0;
+	if (valid > first)
+		samples.erase(samples.begin(), samples.begin() + MIN(valid - first, samples.size()));
+	return samples;
+}
+
+// Total this frame's samples from the calling (main) thread by name
+// and start the next frame
+//
+void Profiler::endFrame() {
+	ProfileThread *t = thread();
+	uint64_t head = t->head.load(std::memory_order_relaxed);
+	if (head - lastRead > ProfileThread::ringSize)
+		lastRead = head - ProfileThread::ringSize;
+
+	map<string, float> totals;
+	for (uint64_t i = lastRead; i < head; i++) {
+		const ProfileSample & s = t->samples[i & (ProfileThread::ringSize - 1)];
+		totals[s.name] += s.duration / 1000.0;
+	}
+	lastRead = head;
+
+	for (auto & total : totals)
+		history[total.first];		// new names start an empty history
+	for (auto & h : history) {
+		auto it = totals.find(h.first);
+		h.second.push_back(it == totals.end() ? 0 : it->second);
+		if (h.second.size() > historySize) h.second.pop_front();
+	}
+	frame++;
+}
+
+// overlay of the main thread's sections: last frame and rolling
+// 50th/95th/99th percentile in ms
+//
+void Profiler::draw(float x, float y) {
+	if (!bShow) return;
+	char line[256];
+	snprintf(line, sizeof(line), "%-28s %7s %7s %7s %7s", "section (ms)", "last", "p50", "p95", "p99");
+	ofDrawBitmapStringHighlight(line, x, y);
+	y += 16;
+	vector<float> sorted;
+	for (auto & h : history) {
+		if (h.second.empty()) continue;
+		sorted.assign(h.second.begin(), h.second.end());
+		sort(sorted.begin(), sorted.end());
+		int n = sorted.size();
+		snprintf(line, sizeof(line), "%-28s %7.3f %7.3f %7.3f %7.3f", h.first.c_str(), h.second.back(),
+			sorted[n / 2], sorted[MIN(n * 95 / 100, n - 1)], sorted[MIN(n * 99 / 100, n - 1)]);
+		ofDrawBitmapStringHighlight(line, x, y);
+		y += 16;
+	}
+}
+
+bool Profiler::exportCsv(const string & path) {
+	ofstream out(ofToDataPath(path, true));
+	if (!out) return false;
+	out << "thread,name,frame,start_us,duration_us" << endl;
+	lock_guard<std::mutex> lock(mutex);
+	for (auto & t : threads) {
+		vector<ProfileSample> samples = snapshot(*t);
+		for (auto & s : samples)
+			out << t->name << "," << s.name << "," << s.frame << "," << s.start << "," << s.duration << "\n";
+	}
+	return out.good();
+}
+
+// Chrome trace event format: one complete ("X") event per sample and a
+// name for each thread
+//
+bool Profiler::exportTrace(const string & path) {
+	ofstream out(ofToDataPath(path, true));
+	if (!out) return false;
+	out << "{\"traceEvents\":[" << endl;
+	bool first = true;
+	lock_guard<std::mutex> lock(mutex);
+	for (auto & t : threads) {
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t->id <<
+			",\"args\":{\"name\":\"" << t->name << "\"}}";
+		first = false;
+		vector<ProfileSample> samples = snapshot(*t);
+		for (auto & s : samples) {
+			out << ",\n{\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t->id <<
+				",\"ts\":" << s.start << ",\"dur\":" << s.duration << ",\"args\":{\"frame\":" << s.frame << "}}";
+		}
+	}
+	out << "\n]}" << endl;
+	return out.good();
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+//  Lightweight frame profiler.
+//
+//  PROFILE_SCOPE("name") times the rest of the enclosing block.  Every
+//  thread writes its samples into a ring buffer of its own, without
+//  locking, so scopes are cheap enough to leave in release builds;
+//  build with PROFILER_ENABLED 0 to compile them out.  Names must be
+//  string literals, only the pointer is kept.  Nested scopes are named
+//  like paths ("update/collision") so they read as a tree.
+//
+//  Once a frame the main thread calls endFrame(), which totals its own
+//  samples by name and keeps the last historySize totals for rolling
+//  percentiles; draw() shows them as an overlay.  exportCsv() and
+//  exportTrace() write every sample still in the ring buffers, from all
+//  threads, as CSV or as a Chrome trace (chrome://tracing or Perfetto).
+//  A thread's ring buffer is freed when the thread exits, so threads
+//  started and stopped over and over don't pile up rings.
+//
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+struct ProfileSample {
+	const char *name;
+	uint64_t start;			// us since the app started
+	uint32_t duration;		// us
+	uint32_t frame;
+};
+
+// one thread's ring buffer; only that thread writes to it
+//
+class ProfileThread {
+public:
+	static const int ringSize = 1 << 14;		// power of two
+
+	ProfileThread(int id) : id(id), samples(ringSize) { }
+	void record(const ProfileSample & sample) {
+		uint64_t h = head.load(std::memory_order_relaxed);
+		samples[h & (ringSize - 1)] = sample;
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	int id;
+	string name;
+	vector<ProfileSample> samples;
+	std::atomic<uint64_t> head { 0 };		// samples ever written
+};
+
+class Profiler {
+public:
+	static Profiler & get();
+
+	void record(const char *name, uint64_t start, uint64_t end);
+	void setThreadName(const string & name);
+	void endFrame();
+	void draw(float x, float y);
+	bool exportCsv(const string & path);
+	bool exportTrace(const string & path);
+
+	void retire(ProfileThread *t);
+
+	std::atomic<uint32_t> frame { 0 };
+	bool bShow = false;
+	int historySize = 120;		// frames kept for the percentiles
+
+private:
+	ProfileThread * thread();
+	vector<ProfileSample> snapshot(ProfileThread & t);
+
+	std::mutex mutex;						// guards threads
+	vector<unique_ptr<ProfileThread>> threads;
+	int nextId = 0;
+	uint64_t lastRead = 0;					// main thread samples already totaled
+	map<string, deque<float>> history;		// ms per frame, by name
+};
+
+class ProfileScope {
+public:
+	ProfileScope(const char *name) : name(name), start(ofGetElapsedTimeMicros()) { }
+	~ProfileScope() { Profiler::get().record(name, start, ofGetElapsedTimeMicros()); }
+
+	const char *name;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,79 @@
+#include "Ship.h"
+
+// Constructor for Ship instance
+// --Jared Bechthold
+//----------------------------------------------------
+Ship::Ship(string src, ModelCache & cache)
+{
+	// gets ship model from the cache, which loads it from the given
+	// source the first time
+	if (shipModel.load(cache, src))
+		shipLoaded = true;
+
+	// sets up bounding box of ship from the model's bounds
+	boundsMin = getShipModel().getSceneMin();
+	boundsMax = getShipModel().getSceneMax();
+	updateBoundingBox();
+}
+
+// Integrates the ship's physics and moves its model with it
+// --Jared Bechthold
+//----------------------------------------------------
+void Ship::integrate()
+{
+	ShipBody::integrate();
+	setPosition(position);
+}
+
+// Integrates the ship's turning and turns its model with it
+// --Jared Bechthold
+//----------------------------------------------------
+void Ship::integrateTurn()
+{
+	ShipBody::integrateTurn();
+	setRotation();
+}
+
+// Sets position of Ship model and stores in Ship position field
+// --Jared Bechthold
+//----------------------------------------------------
+void Ship::setPosition(glm::vec3 newPos)
+{
+	if (getShipLoaded()) {
+		ShipBody::setPosition(newPos);
+		shipModel.setPosition(newPos.x, newPos.y, newPos.z);
+	}
+}
+
+// Sets rotation angle of Ship model to current value of rotation variable
+// --Jared Bechthold
+//----------------------------------------------------
+void Ship::setRotation()
+{
+	if (getShipLoaded())
+		shipModel.setRotation(this->rotation, glm::vec3(0.0, 1.0, 0.0));
+}
+
+// Returns boolean value if ship is selected
+// --Jared Bechthold
+//----------------------------------------------------
+bool Ship::getShipSelected()
+{
+	return shipSelected;
+}
+
+// Returns boolean value if ship is loaded
+// --Jared Bechthold
+//----------------------------------------------------
+bool Ship::getShipLoaded()
+{
+	return shipLoaded;
+}
+
+// Returns the ship's model
+// --Jared Bechthold
+//----------------------------------------------------
+ModelInstance & Ship::getShipModel()
+{
+	return shipModel;
+}
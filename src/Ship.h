@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ShipBody.h"
+#include "ModelCache.h"
+
+// Ship Class
+// Consolidates the fields and methods relevant to the
+// Ship Model. The physics related movement comes from
+// ShipBody; Ship keeps the model in step with it.
+// --Jared Bechthold
+//----------------------------------------------------
+class Ship : public ShipBody {
+public:
+	// Ship Constructor
+	Ship(string src, ModelCache & cache);
+
+	// Fields
+	ModelInstance shipModel;			// Holds the ship's model, shared through the cache
+	bool shipSelected;					// Whether or not the ship is selected
+	bool shipLoaded = false;			// Whether or not the ship is loaded
+
+	// Functions
+	void integrate();						// Movement of ship and its model
+	void integrateTurn();					// Turning of ship and its model
+	void setPosition(glm::vec3 newPos);		// Set position of the ship
+	void setRotation();						// Set rotation of the ship
+	bool getShipSelected();					// Returns whether or not the ship is selected
+	bool getShipLoaded();					// Returns whether or not the ship is loaded
+	ModelInstance & getShipModel();			// Returns ship's model
+};
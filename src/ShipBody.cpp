@@ -0,0 +1,76 @@
+#include "ShipBody.h"
+
+// Applies forces to the ship and changes position appropriately
+// This gives the ship physics movement
+// --Jared Bechthold
+//----------------------------------------------------
+void ShipBody::integrate()
+{
+	// update position from velocity and time
+	this->setPosition(this->getPosition() + this->velocity * 1.0 / 60.0);
+	// adds forces
+	addForces();
+	ofVec3f accel = acceleration + forces;
+	// update velocity (from acceleration)
+	this->velocity = this->velocity + accel * (1.0 / 60.0);
+	// multiply velocity by damping factor
+	this->velocity = this->velocity * this->damping;
+	impulseForce.set(0, 0, 0);
+	forces.set(0, 0, 0);
+}
+
+// Applies thrust force to the ship's rotation
+// --Jared Bechthold
+//----------------------------------------------------
+void ShipBody::integrateTurn()
+{
+	// update rotation from velocity and time
+	this->rotation = this->rotation + this->turnVelocity * 1.0 / 60.0;
+	// update velocity (from acceleration)
+	this->turnVelocity = this->turnVelocity + this->turnAcceleration * (1.0 / 60.0);
+	// multiply velocity by damping factor
+	this->turnVelocity = this->turnVelocity * this->damping;
+}
+
+// Stores the ship's position
+// --Jared Bechthold
+//----------------------------------------------------
+void ShipBody::setPosition(glm::vec3 newPos)
+{
+	position = newPos;
+}
+
+// Returns the ship's current position
+// --Jared Bechthold
+//----------------------------------------------------
+glm::vec3 ShipBody::getPosition()
+{
+	return position;
+}
+
+// Returns the ship's bounding box
+// --Jared Bechthold
+//----------------------------------------------------
+Box ShipBody::getLanderBounds()
+{
+	return shipBBox;
+}
+
+// Adds all of the force vectors to the forces vector
+// --Jared Bechthold
+//----------------------------------------------------
+void ShipBody::addForces()
+{
+	forces = gravity + appliedThrust + impulseForce;
+}
+
+// Updates the position of the ship's bounding box
+// --Jared Bechthold
+//----------------------------------------------------
+void ShipBody::updateBoundingBox()
+{
+	// model bounds offset by the ship's position, straight into the box
+	glm::vec3 min = boundsMin + position;
+	glm::vec3 max = boundsMax + position;
+	shipBBox = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
+}
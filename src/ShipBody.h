@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ofMain.h"
+#include "box.h"
+
+// ShipBody Class
+// The lander's physics without its model: the forces on it, their
+// integration at 60 steps a second and its bounding box. Ship puts
+// the model on top of it; the headless simulator flies a ShipBody
+// on its own.
+//----------------------------------------------------
+class ShipBody {
+public:
+	// Fields
+	Box shipBBox;						// Holds bounding box of ship
+	glm::vec3 boundsMin = glm::vec3(0, 0, 0);	// Model bounds the bounding box is built from,
+	glm::vec3 boundsMax = glm::vec3(0, 0, 0);	// relative to the ship's position
+	glm::vec3 position = glm::vec3(0, 0, 0);	// Holds position of ship
+	glm::vec3 velocity = glm::vec3(0, 0, 0);	// Holds ship's velocity
+	glm::vec3 acceleration = glm::vec3(0, 0, 0);	// Holds ship's acceleration
+	float rotation = 0.0;				// Holds rotation of ship
+	float turnVelocity = 0;				// Holds turn velocity of ship
+	float turnAcceleration = 0;			// Holds turn acceleration of ship
+	float thrust = 0;					// Holds the thrust force of ship
+	ofVec3f appliedThrust;				// Thurst force in 3D 
+	ofVec3f gravity;					// Gravity force in 3D
+	ofVec3f impulseForce;				// Impulse force in 3D
+	ofVec3f forces = ofVec3f(0, 0, 0);	// Combination of all forces
+	float damping = 1;					// Decreases force values
+	bool landed = false;				// Whether or not the ship has landed
+	float fuel = 0;
+
+	// Functions
+	void integrate();						// Movement of ship in direction
+	void integrateTurn();					// Turning of ship
+	void setPosition(glm::vec3 newPos);		// Set position of the ship
+	glm::vec3 getPosition();				// Returns ship's position
+	Box getLanderBounds();					// Gets boundaries of lander bounding box
+	void addForces();						// adds up all forces
+	void updateBoundingBox();
+};
@@ -0,0 +1,88 @@
+
+#include "SyntheticTerrain.h"
+
+// hash of a lattice point to [0, 1)
+//
+static float lattice(int x, int z, unsigned seed) {
+	uint32_t h = (uint32_t)x * 0x8da6b343u ^ (uint32_t)z * 0xd8163841u ^ seed * 0xcb1ab31fu;
+	h ^= h >> 13;
+	h *= 0x5bd1e995u;
+	h ^= h >> 15;
+	return (h & 0xffffff) / (float)0x1000000;
+}
+
+// smoothly interpolated lattice values, in [0, 1)
+//
+static float valueNoise(float x, float z, unsigned seed) {
+	int x0 = (int)floorf(x), z0 = (int)floorf(z);
+	float fx = x - x0, fz = z - z0;
+	fx = fx * fx * (3 - 2 * fx);
+	fz = fz * fz * (3 - 2 * fz);
+	float a = ofLerp(lattice(x0, z0, seed), lattice(x0 + 1, z0, seed), fx);
+	float b = ofLerp(lattice(x0, z0 + 1, seed), lattice(x0 + 1, z0 + 1, seed), fx);
+	return ofLerp(a, b, fz);
+}
+
+// four octaves, the first with features about a quarter of the terrain
+// wide
+//
+static float hills(float x, float z, float size, unsigned seed) {
+	float frequency = 4 / size, amplitude = 1, sum = 0, total = 0;
+	for (int octave = 0; octave < 4; octave++) {
+		sum += amplitude * valueNoise(x * frequency, z * frequency, seed + octave);
+		total += amplitude;
+		frequency *= 2;
+		amplitude *= .5f;
+	}
+	return sum / total;
+}
+
+float SyntheticTerrain::heightAt(float x, float z) const {
+	float h = height * hills(x, z, size, seed);
+	float padHeight = height * hills(padCenter.x, padCenter.z, size, seed);
+	float d = sqrtf((x - padCenter.x) * (x - padCenter.x) + (z - padCenter.z) * (z - padCenter.z));
+
+	// flat inside the pad, blending back into the hills over another
+	// radius around it
+	//
+	float t = ofClamp((d - padRadius) / padRadius, 0, 1);
+	t = t * t * (3 - 2 * t);
+	return ofLerp(padHeight, h, t);
+}
+
+void SyntheticTerrain::create(ofMesh & meshRtn) const {
+	meshRtn.clear();
+	meshRtn.setMode(OF_PRIMITIVE_TRIANGLES);
+	if (res < 2) return;
+	float step = size / (res - 1);
+	float origin = -size / 2;
+	for (int k = 0; k < res; k++) {
+		for (int i = 0; i < res; i++) {
+			float x = origin + i * step, z = origin + k * step;
+			meshRtn.addVertex(glm::vec3(x, heightAt(x, z), z));
+		}
+	}
+
+	// normals from central differences of the heights
+	//
+	for (int k = 0; k < res; k++) {
+		for (int i = 0; i < res; i++) {
+			const vector<glm::vec3> & v = meshRtn.getVertices();
+			int i0 = MAX(i - 1, 0), i1 = MIN(i + 1, res - 1);
+			int k0 = MAX(k - 1, 0), k1 = MIN(k + 1, res - 1);
+			float dx = (v[k * res + i1].y - v[k * res + i0].y) / ((i1 - i0) * step);
+			float dz = (v[k1 * res + i].y - v[k0 * res + i].y) / ((k1 - k0) * step);
+			meshRtn.addNormal(glm::normalize(glm::vec3(-dx, 1, -dz)));
+		}
+	}
+
+	// two triangles per cell, wound counter clockwise seen from above
+	//
+	for (int k = 0; k < res - 1; k++) {
+		for (int i = 0; i < res - 1; i++) {
+			ofIndexType a = k * res + i, b = a + 1, c = a + res, d = c + 1;
+			meshRtn.addIndex(a); meshRtn.addIndex(c); meshRtn.addIndex(b);
+			meshRtn.addIndex(b); meshRtn.addIndex(c); meshRtn.addIndex(d);
+		}
+	}
+}
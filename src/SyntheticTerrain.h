@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ofMain.h"
+
+//  A generated terrain mesh, for flying, testing and benchmarking the
+//  simulation without the game's models.
+//
+//  A res x res grid of vertices "size" wide, centered on the origin in
+//  x/z, raised into rolling hills up to "height" by a few octaves of
+//  value noise from "seed".  A round pad of "padRadius" around padCenter
+//  is left flat at the height of its center, so there is always a place
+//  to land.  Triangles are indexed and every vertex has a normal, like
+//  the compiled terrain the game loads.
+//
+class SyntheticTerrain {
+public:
+	int res = 129;
+	float size = 200;
+	float height = 12;
+	unsigned seed = 1;
+	glm::vec3 padCenter = glm::vec3(0, 0, 0);	// only x and z are used
+	float padRadius = 10;
+
+	void create(ofMesh & meshRtn) const;
+	float heightAt(float x, float z) const;		// the surface before it's cut into triangles
+};
@@ -0,0 +1,214 @@
+
+#include "Telemetry.h"
+#include "Profiler.h"
+
+static const float TelemetryScale = 1024;		// fields kept to about a thousandth of a unit
+
+bool TelemetryRing::push(const TelemetryRecord & r) {
+	uint64_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= Capacity) return false;
+	records[h & (Capacity - 1)] = r;
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+// move every record pushed so far into recordsRtn
+//
+int TelemetryRing::pop(vector<TelemetryRecord> & recordsRtn) {
+	uint64_t t = tail.load(std::memory_order_relaxed);
+	uint64_t h = head.load(std::memory_order_acquire);
+	recordsRtn.clear();
+	for (uint64_t i = t; i < h; i++)
+		recordsRtn.push_back(records[i & (Capacity - 1)]);
+	tail.store(h, std::memory_order_release);
+	return recordsRtn.size();
+}
+
+static int64_t fixed(float v, float scale) {
+	return isfinite(v) ? llround((double)v * scale) : 0;
+}
+
+// a record as fixed point integers, in file order
+//
+static void quantize(const TelemetryRecord & r, float scale, int64_t *f) {
+	int n = 0;
+	f[n++] = r.frame;
+	f[n++] = llround(r.time * 1000.0);		// ms
+	for (int k = 0; k < 3; k++) f[n++] = fixed(r.position[k], scale);
+	for (int k = 0; k < 3; k++) f[n++] = fixed(r.velocity[k], scale);
+	for (int k = 0; k < 3; k++) f[n++] = fixed(r.impulse[k], scale);
+	f[n++] = fixed(r.fuel, scale);
+	f[n++] = fixed(r.altitude, scale);
+	f[n++] = r.particles;
+	f[n++] = r.flight;
+	f[n++] = r.flags;
+}
+
+static void dequantize(const int64_t *f, float scale, TelemetryRecord & r) {
+	int n = 0;
+	r.frame = f[n++];
+	r.time = f[n++] / 1000.0;
+	for (int k = 0; k < 3; k++) r.position[k] = f[n++] / scale;
+	for (int k = 0; k < 3; k++) r.velocity[k] = f[n++] / scale;
+	for (int k = 0; k < 3; k++) r.impulse[k] = f[n++] / scale;
+	r.fuel = f[n++] / scale;
+	r.altitude = f[n++] / scale;
+	r.particles = f[n++];
+	r.flight = f[n++];
+	r.flags = f[n++];
+}
+
+// zigzag then LEB128, so small deltas of either sign take one byte
+//
+static void putVarint(vector<uint8_t> & out, int64_t v) {
+	uint64_t u = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+	while (u >= 0x80) {
+		out.push_back((u & 0x7f) | 0x80);
+		u >>= 7;
+	}
+	out.push_back(u);
+}
+
+static bool getVarint(const uint8_t *& p, const uint8_t *end, int64_t & v) {
+	uint64_t u = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (p == end) return false;
+		uint8_t c = *p++;
+		u |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Start a recording at path (under the data folder) and the thread that
+// writes it
+//
+bool Telemetry::open(const string & path) {
+	close();
+	file.open(ofToDataPath(path, true), ios::binary);
+	if (!file.is_open()) {
+		cout << "can't write telemetry to " << path << endl;
+		return false;
+	}
+	TelemetryHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "LTEL", 4);
+	h.version = TELEMETRY_VERSION;
+	h.fields = TELEMETRY_FIELDS;
+	h.scale = TelemetryScale;
+	file.write((const char *)&h, sizeof(h));
+	bytesWritten = sizeof(h);
+	memset(previous, 0, sizeof(previous));
+	ring.head = 0;
+	ring.tail = 0;
+	bOpen = true;
+	startThread();
+	return true;
+}
+
+// stop the writer and write whatever it hadn't got to yet
+//
+void Telemetry::close() {
+	if (!bOpen) return;
+	bOpen = false;
+	waitForThread(true);
+	drain();
+	file.close();
+	cout << "telemetry: " << written << " records, " << dropped << " dropped, " << bytesWritten << " bytes (" <<
+		written * sizeof(TelemetryRecord) << " raw), record() " << (records ? totalCost / records : 0) <<
+		"ns average, " << maxCost << "ns max" << endl;
+}
+
+// Simulation thread.  Bounded: a copy and two atomics, never a wait
+//
+void Telemetry::record(const TelemetryRecord & r) {
+	if (!bOpen) return;
+	auto start = std::chrono::steady_clock::now();
+	if (!ring.push(r)) dropped++;
+	records++;
+	lastCost = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count();
+	maxCost = MAX(maxCost, lastCost);
+	totalCost += lastCost;
+}
+
+void Telemetry::threadedFunction() {
+	Profiler::get().setThreadName("telemetry");
+	while (isThreadRunning()) {
+		drain();
+		sleep(writeInterval);
+	}
+}
+
+void Telemetry::drain() {
+	if (ring.pop(batch) == 0) return;
+	PROFILE_SCOPE("telemetry/write");
+	encoded.clear();
+	int64_t f[TELEMETRY_FIELDS];
+	for (int i = 0; i < batch.size(); i++) {
+		quantize(batch[i], TelemetryScale, f);
+		for (int n = 0; n < TELEMETRY_FIELDS; n++) {
+			putVarint(encoded, f[n] - previous[n]);
+			previous[n] = f[n];
+		}
+	}
+	file.write((const char *)encoded.data(), encoded.size());
+	file.flush();
+	written += batch.size();
+	bytesWritten += encoded.size();
+}
+
+// The reader tool: decode the recording at inPath and write it to
+// outPath as CSV, one row per record.  Paths are as given, not under
+// the data folder
+//
+bool Telemetry::dumpCsv(const string & inPath, const string & outPath) {
+	ifstream in(inPath, ios::binary);
+	vector<uint8_t> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	TelemetryHeader h;
+	if (data.size() < sizeof(h)) {
+		cout << "can't read telemetry " << inPath << endl;
+		return false;
+	}
+	memcpy(&h, data.data(), sizeof(h));
+	if (strncmp(h.magic, "LTEL", 4) != 0 || h.version != TELEMETRY_VERSION || h.fields != TELEMETRY_FIELDS) {
+		cout << inPath << ": not a telemetry recording, or an old version" << endl;
+		return false;
+	}
+
+	ofstream out(outPath);
+	if (!out) {
+		cout << "can't write " << outPath << endl;
+		return false;
+	}
+	out << "frame,time,x,y,z,vx,vy,vz,impulse_x,impulse_y,impulse_z,fuel,altitude,particles,flight,landed,exploded,game_over" << endl;
+
+	const uint8_t *p = data.data() + sizeof(h);
+	const uint8_t *end = data.data() + data.size();
+	int64_t f[TELEMETRY_FIELDS] = { 0 };
+	int count = 0;
+	while (p < end) {
+		for (int n = 0; n < TELEMETRY_FIELDS; n++) {
+			int64_t delta;
+			if (!getVarint(p, end, delta)) {
+				cout << inPath << ": truncated after " << count << " records" << endl;
+				return false;
+			}
+			f[n] += delta;
+		}
+		TelemetryRecord r;
+		dequantize(f, h.scale, r);
+		out << r.frame << "," << r.time;
+		for (int k = 0; k < 3; k++) out << "," << r.position[k];
+		for (int k = 0; k < 3; k++) out << "," << r.velocity[k];
+		for (int k = 0; k < 3; k++) out << "," << r.impulse[k];
+		out << "," << r.fuel << "," << r.altitude << "," << r.particles << "," << r.flight << "," <<
+			((r.flags & TelemetryRecord::Landed) ? 1 : 0) << "," << ((r.flags & TelemetryRecord::Exploded) ? 1 : 0) << "," <<
+			((r.flags & TelemetryRecord::GameOver) ? 1 : 0) << "\n";
+		count++;
+	}
+	cout << "telemetry: " << count << " records from " << inPath << " written to " << outPath << endl;
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+
+//  Flight recorder: one fixed size record per simulation step, written
+//  to disk on a background thread.
+//
+//  record() is all the simulation pays: it copies the record into a
+//  single producer, single consumer ring and publishes it with one
+//  atomic store.  It never allocates, locks or touches the file, and if
+//  the writer falls a whole ring behind the record is dropped (and
+//  counted) rather than waiting, so its cost is bounded no matter what
+//  the disk does.  The cost of each call is measured.
+//
+//  The writer thread drains the ring every few ms.  Each field is
+//  quantized to a fixed point integer (see quantize()), subtracted
+//  from the same field of the record before, and written as a zigzag
+//  varint.  Most fields change little from one step to the next, so most
+//  of them take a byte.  The file is:
+//
+//    TelemetryHeader
+//    per record: TELEMETRY_FIELDS varints, deltas from the record before
+//
+//  dumpCsv() decodes a file back to CSV.  It's run from the command line
+//  as the reader tool:
+//
+//    3DLandingGame --telemetry-csv flight.tlm flight.csv
+//
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FIELDS 16
+
+class TelemetryRecord {
+public:
+	uint32_t frame = 0;
+	float time = 0;				// seconds since the app started
+	float position[3] = { 0 };
+	float velocity[3] = { 0 };
+	float impulse[3] = { 0 };	// impulse force from the last ground contact
+	float fuel = 0;
+	float altitude = 0;
+	uint32_t particles = 0;		// live exhaust and explosion particles
+	uint16_t flight = 0;		// counts up on each reset
+	uint8_t flags = 0;			// Landed, Exploded, GameOver
+
+	enum { Landed = 1, Exploded = 2, GameOver = 4 };
+};
+
+struct TelemetryHeader {
+	char magic[4];				// "LTEL"
+	uint32_t version;
+	uint32_t fields;			// TELEMETRY_FIELDS
+	float scale;				// fixed point steps per unit
+};
+
+// lock free, one thread pushes and one pops
+//
+class TelemetryRing {
+public:
+	static const int Capacity = 1 << 12;		// over a minute at 60 steps per second
+
+	bool push(const TelemetryRecord & r);
+	int pop(vector<TelemetryRecord> & recordsRtn);
+
+	TelemetryRecord records[Capacity];
+	std::atomic<uint64_t> head { 0 };		// records ever pushed
+	std::atomic<uint64_t> tail { 0 };		// records ever popped
+};
+
+class Telemetry : public ofThread {
+public:
+	~Telemetry() { close(); }
+	bool open(const string & path);
+	void close();
+	bool isOpen() const { return bOpen; }
+	void record(const TelemetryRecord & r);
+	void threadedFunction();
+
+	static bool dumpCsv(const string & inPath, const string & outPath);
+
+	int writeInterval = 20;			// ms between drains
+
+	// stats
+	//
+	uint64_t records = 0;			// recorded by the simulation
+	uint64_t dropped = 0;			// ring was full
+	std::atomic<uint64_t> written { 0 };		// records encoded to the file
+	std::atomic<uint64_t> bytesWritten { 0 };
+	float lastCost = 0;				// ns in the last record()
+	float maxCost = 0;
+	double totalCost = 0;
+
+private:
+	void drain();
+
+	TelemetryRing ring;
+	std::atomic<bool> bOpen { false };
+	ofstream file;
+	vector<TelemetryRecord> batch;	// writer thread only from here down
+	vector<uint8_t> encoded;
+	int64_t previous[TELEMETRY_FIELDS];
+};
@@ -0,0 +1,379 @@
+
+#include "TerrainChunks.h"
+
+// build the chunks from the octree's copy of the terrain mesh, along
+// with "levels" levels of detail per chunk (1 is full resolution only)
+//
+void TerrainChunks::create(const Octree & octree, int chunkLevel, int levels) {
+	const ofMesh & mesh = octree.mesh;
+	numLods = ofClamp(levels, 1, TERRAIN_LODS);
+	nodes.clear();
+	chunks.clear();
+	indices.clear();
+
+	// assign every vertex to the chunk whose octree node holds it
+	//
+	vector<int> vertexChunk(mesh.getNumVertices(), -1);
+	buildNode(octree.root, 0, chunkLevel, vertexChunk);
+
+	// bin triangles by the chunk of their first binned vertex.  Stray
+	// vertices the octree dropped fall back to chunk 0; bounds are refit
+	// from the triangles below so culling stays conservative either way.
+	//
+	bool indexed = mesh.getNumIndices() > 0;
+	int numTris = (indexed ? mesh.getNumIndices() : mesh.getNumVertices()) / 3;
+	numTriangles = numTris;
+	vector<int> triChunk(numTris, 0);
+	vector<int> counts(chunks.size() + 1, 0);
+	for (int t = 0; t < numTris; t++) {
+		for (int k = 0; k < 3; k++) {
+			int v = indexed ? mesh.getIndex(t * 3 + k) : t * 3 + k;
+			if (vertexChunk[v] >= 0) {
+				triChunk[t] = vertexChunk[v];
+				break;
+			}
+		}
+		counts[triChunk[t] + 1] += 3;
+	}
+
+	// counting sort the triangles into one index buffer
+	//
+	for (int c = 0; c < chunks.size(); c++) {
+		counts[c + 1] += counts[c];
+		chunks[c].first = counts[c];
+		chunks[c].count = counts[c + 1] - counts[c];
+	}
+	indices.resize(numTris * 3);
+	vector<bool> hasBounds(chunks.size(), false);
+	for (int t = 0; t < numTris; t++) {
+		int c = triChunk[t];
+		for (int k = 0; k < 3; k++) {
+			int v = indexed ? mesh.getIndex(t * 3 + k) : t * 3 + k;
+			indices[counts[c]++] = v;
+
+			ofVec3f p = mesh.getVertex(v);
+			Vector3 & min = chunks[c].bounds.parameters[0];
+			Vector3 & max = chunks[c].bounds.parameters[1];
+			if (!hasBounds[c]) {
+				min = max = Vector3(p.x, p.y, p.z);
+				hasBounds[c] = true;
+			}
+			else {
+				min = Vector3(MIN(min.x(), p.x), MIN(min.y(), p.y), MIN(min.z(), p.z));
+				max = Vector3(MAX(max.x(), p.x), MAX(max.y(), p.y), MAX(max.z(), p.z));
+			}
+		}
+	}
+	if (!nodes.empty()) refit(0);
+
+	for (int c = 0; c < chunks.size(); c++) {
+		chunks[c].lodFirst[0] = chunks[c].first;
+		chunks[c].lodCount[0] = chunks[c].count;
+		chunks[c].lodError[0] = 0;
+	}
+	if (numLods == 1 || numTris == 0) return;
+
+	// lock every vertex position used by more than one chunk.  Matching
+	// is on position rather than index since the mesh may duplicate
+	// border vertices.
+	//
+	map<tuple<float, float, float>, int> positionChunk;
+	vector<bool> locked(mesh.getNumVertices(), false);
+	for (int c = 0; c < chunks.size(); c++) {
+		for (int i = chunks[c].first; i < chunks[c].first + chunks[c].count; i++) {
+			ofVec3f p = mesh.getVertex(indices[i]);
+			auto it = positionChunk.insert(make_pair(make_tuple(p.x, p.y, p.z), c)).first;
+			if (it->second != c) it->second = -1;
+		}
+	}
+	float edgeSum = 0;
+	for (int i = 0; i < indices.size(); i++) {
+		ofVec3f p = mesh.getVertex(indices[i]);
+		if (positionChunk[make_tuple(p.x, p.y, p.z)] < 0) locked[indices[i]] = true;
+
+		// accumulate edge lengths for the base clustering cell size
+		//
+		int next = (i % 3 == 2) ? i - 2 : i + 1;
+		edgeSum += p.distance(mesh.getVertex(indices[next]));
+	}
+
+	// level 1 clusters over roughly two edge lengths, then double per level
+	//
+	float cellSize = 2 * edgeSum / indices.size();
+	for (int level = 1; level < numLods; level++) {
+		buildLod(mesh, level, cellSize, locked);
+		cellSize *= 2;
+	}
+}
+
+// simplify every chunk by vertex clustering on a grid of "cellSize",
+// appending the result to indices as level "level".  Each cluster of
+// unlocked vertices collapses to the member nearest its centroid.
+//
+void TerrainChunks::buildLod(const ofMesh & mesh, int level, float cellSize, const vector<bool> & locked) {
+	int n = mesh.getNumVertices();
+	vector<int> cluster(n, -1);
+	vector<int> rep(n, -1);
+
+	for (int c = 0; c < chunks.size(); c++) {
+		TerrainChunk & chunk = chunks[c];
+		int first = chunk.first;
+		int end = chunk.first + chunk.count;
+
+		// bin this chunk's unlocked vertices into grid cells
+		//
+		map<tuple<int, int, int>, int> cellCluster;
+		vector<ofVec3f> sum;
+		vector<int> num;
+		vector<int> members;
+		for (int i = first; i < end; i++) {
+			int v = indices[i];
+			if (locked[v] || cluster[v] >= 0) continue;
+			ofVec3f p = mesh.getVertex(v);
+			auto key = make_tuple((int)floor(p.x / cellSize), (int)floor(p.y / cellSize), (int)floor(p.z / cellSize));
+			auto it = cellCluster.find(key);
+			int id;
+			if (it == cellCluster.end()) {
+				id = sum.size();
+				cellCluster[key] = id;
+				sum.push_back(ofVec3f(0, 0, 0));
+				num.push_back(0);
+			}
+			else id = it->second;
+			cluster[v] = id;
+			sum[id] += p;
+			num[id]++;
+			members.push_back(v);
+		}
+
+		// pick each cluster's representative and measure the error
+		//
+		vector<int> best(sum.size(), -1);
+		vector<float> bestDist(sum.size(), 0);
+		for (int i = 0; i < members.size(); i++) {
+			int v = members[i];
+			int id = cluster[v];
+			float d = ofVec3f(mesh.getVertex(v)).distance(sum[id] / num[id]);
+			if (best[id] < 0 || d < bestDist[id]) {
+				best[id] = v;
+				bestDist[id] = d;
+			}
+		}
+		float error = 0;
+		for (int i = 0; i < members.size(); i++) {
+			int v = members[i];
+			rep[v] = best[cluster[v]];
+			error = MAX(error, ofVec3f(mesh.getVertex(v)).distance(mesh.getVertex(rep[v])));
+		}
+
+		// remap the full resolution triangles, dropping collapsed ones
+		//
+		chunk.lodFirst[level] = indices.size();
+		for (int i = first; i < end; i += 3) {
+			int t[3];
+			for (int k = 0; k < 3; k++) {
+				int v = indices[i + k];
+				t[k] = locked[v] ? v : rep[v];
+			}
+			if (t[0] == t[1] || t[1] == t[2] || t[0] == t[2]) continue;
+			indices.push_back(t[0]);
+			indices.push_back(t[1]);
+			indices.push_back(t[2]);
+		}
+		chunk.lodCount[level] = indices.size() - chunk.lodFirst[level];
+		chunk.lodError[level] = MAX(error, chunk.lodError[level - 1]);
+
+		for (int i = 0; i < members.size(); i++) {
+			cluster[members[i]] = -1;
+			rep[members[i]] = -1;
+		}
+	}
+}
+
+// mirror the octree down to chunkLevel; return index of the new node
+//
+int TerrainChunks::buildNode(const TreeNode & node, int level, int chunkLevel, vector<int> & vertexChunk) {
+	int id = nodes.size();
+	nodes.push_back(ChunkNode());
+	if (level >= chunkLevel || node.children.empty()) {
+		int c = chunks.size();
+		chunks.push_back(TerrainChunk());
+		nodes[id].chunk = c;
+		for (int i = 0; i < node.points.size(); i++) {
+			if (vertexChunk[node.points[i]] < 0) vertexChunk[node.points[i]] = c;
+		}
+		return id;
+	}
+	for (int i = 0; i < node.children.size(); i++) {
+		int child = buildNode(node.children[i], level + 1, chunkLevel, vertexChunk);
+		nodes[id].children.push_back(child);
+	}
+	return id;
+}
+
+// recompute node bounds bottom up from the chunk triangle bounds
+//
+void TerrainChunks::refit(int id) {
+	ChunkNode & node = nodes[id];
+	if (node.chunk >= 0) {
+		node.empty = chunks[node.chunk].count == 0;
+		node.bounds = chunks[node.chunk].bounds;
+		return;
+	}
+	node.empty = true;
+	for (int i = 0; i < node.children.size(); i++) {
+		int c = node.children[i];
+		refit(c);
+		const ChunkNode & child = nodes[c];
+		if (child.empty) continue;
+		if (node.empty) {
+			node.bounds = child.bounds;
+			node.empty = false;
+			continue;
+		}
+		Vector3 & min = node.bounds.parameters[0];
+		Vector3 & max = node.bounds.parameters[1];
+		const Vector3 & cmin = child.bounds.parameters[0];
+		const Vector3 & cmax = child.bounds.parameters[1];
+		min = Vector3(MIN(min.x(), cmin.x()), MIN(min.y(), cmin.y()), MIN(min.z(), cmin.z()));
+		max = Vector3(MAX(max.x(), cmax.x()), MAX(max.y(), cmax.y()), MAX(max.z(), cmax.z()));
+	}
+}
+
+// collect the chunks inside or crossing the frustum.  Subtrees fully
+// inside are accepted without further tests.  Return visible triangles.
+//
+int TerrainChunks::cull(const Frustum & frustum, vector<int> & visibleRtn) const {
+	visibleRtn.clear();
+	if (!nodes.empty()) cullNode(frustum, 0, false, visibleRtn);
+
+	visibleChunks = visibleRtn.size();
+	visibleTriangles = 0;
+	for (int i = 0; i < visibleRtn.size(); i++)
+		visibleTriangles += chunks[visibleRtn[i]].count / 3;
+	lodTriangles = visibleTriangles;
+	return visibleTriangles;
+}
+
+// pick a level of detail for each visible chunk: the coarsest level whose
+// error, projected at the chunk's distance from "eye", stays under
+// maxPixelError.  pixelsPerUnit is viewport height / (2 tan(fov / 2)).
+// Return triangles at the selected levels.
+//
+int TerrainChunks::selectLods(const vector<int> & visible, const glm::vec3 & eye, float pixelsPerUnit,
+	float maxPixelError, vector<int> & lodsRtn) const
+{
+	lodsRtn.resize(visible.size());
+	lodTriangles = 0;
+	for (int i = 0; i < visible.size(); i++) {
+		const TerrainChunk & chunk = chunks[visible[i]];
+
+		// distance from the eye to the nearest point of the chunk bounds
+		//
+		const Vector3 & min = chunk.bounds.parameters[0];
+		const Vector3 & max = chunk.bounds.parameters[1];
+		float dx = MAX(MAX(min.x() - eye.x, 0.0f), eye.x - max.x());
+		float dy = MAX(MAX(min.y() - eye.y, 0.0f), eye.y - max.y());
+		float dz = MAX(MAX(min.z() - eye.z, 0.0f), eye.z - max.z());
+		float dist = MAX(sqrt(dx * dx + dy * dy + dz * dz), 0.0001f);
+
+		int lod = 0;
+		for (int l = numLods - 1; l > 0; l--) {
+			if (chunk.lodError[l] * pixelsPerUnit / dist <= maxPixelError) {
+				lod = l;
+				break;
+			}
+		}
+		lodsRtn[i] = lod;
+		lodTriangles += chunk.lodCount[lod] / 3;
+	}
+	return lodTriangles;
+}
+
+void TerrainChunks::cullNode(const Frustum & frustum, int id, bool inside, vector<int> & visibleRtn) const {
+	const ChunkNode & node = nodes[id];
+	if (node.empty) return;
+	if (!inside) {
+		int result = frustum.classify(node.bounds);
+		if (result == Frustum::Outside) return;
+		inside = (result == Frustum::Inside);
+	}
+	if (node.chunk >= 0) {
+		visibleRtn.push_back(node.chunk);
+		return;
+	}
+	for (int i = 0; i < node.children.size(); i++)
+		cullNode(frustum, node.children[i], inside, visibleRtn);
+}
+
+// upload the terrain with the chunk ordered index buffer
+//
+void TerrainChunks::setupVbo(const ofMesh & mesh) {
+	vbo.setMesh(mesh, GL_STATIC_DRAW);
+	if (!indices.empty())
+		vbo.setIndexData(&indices[0], indices.size(), GL_STATIC_DRAW);
+}
+
+// Upload vertices first to last of the mesh again after they moved, and
+// grow the bounds of the chunks over "region" down to its bottom so
+// culling stays conservative.  The LODs index the same vertices, so they
+// follow without rebuilding, but a vertex and the one it's clustered to
+// may have moved by different amounts: vertices only sink, by at most
+// "displacement", so each coarse level's error grows by that much
+//
+void TerrainChunks::update(const ofMesh & mesh, const Box & region, int first, int last, float displacement) {
+	if (first <= last && vbo.getIsAllocated()) {
+		vbo.getVertexBuffer().updateData(first * sizeof(glm::vec3), (last - first + 1) * sizeof(glm::vec3),
+			&mesh.getVertices()[first]);
+		if (mesh.getNumNormals() == mesh.getNumVertices())
+			vbo.getNormalBuffer().updateData(first * sizeof(glm::vec3), (last - first + 1) * sizeof(glm::vec3),
+				&mesh.getNormals()[first]);
+	}
+	const Vector3 & rmin = region.parameters[0];
+	const Vector3 & rmax = region.parameters[1];
+	for (int c = 0; c < chunks.size(); c++) {
+		Box & b = chunks[c].bounds;
+		if (rmax.x() < b.parameters[0].x() || rmin.x() > b.parameters[1].x() ||
+			rmax.z() < b.parameters[0].z() || rmin.z() > b.parameters[1].z())
+			continue;
+		const Vector3 & min = b.parameters[0];
+		b.parameters[0] = Vector3(min.x(), MIN(min.y(), rmin.y()), min.z());
+		for (int l = 1; l < numLods; l++)
+			chunks[c].lodError[l] += displacement;
+	}
+	if (!nodes.empty()) refit(0);
+}
+
+// draw the visible chunks at full resolution
+//
+void TerrainChunks::draw(const vector<int> & visible) {
+	draw(visible, vector<int>());
+}
+
+// draw the visible chunks at the levels from selectLods().  Ranges that
+// are neighbors in the index buffer are merged into a single draw.
+//
+void TerrainChunks::draw(const vector<int> & visible, const vector<int> & lods) {
+	ranges.clear();
+	for (int i = 0; i < visible.size(); i++) {
+		const TerrainChunk & chunk = chunks[visible[i]];
+		int lod = lods.empty() ? 0 : lods[i];
+		if (chunk.lodCount[lod] > 0)
+			ranges.push_back(make_pair(chunk.lodFirst[lod], chunk.lodCount[lod]));
+	}
+	sort(ranges.begin(), ranges.end());
+
+	drawCalls = 0;
+	int i = 0;
+	while (i < ranges.size()) {
+		int first = ranges[i].first;
+		int end = first + ranges[i].second;
+		i++;
+		while (i < ranges.size() && ranges[i].first == end) {
+			end += ranges[i].second;
+			i++;
+		}
+		vbo.drawElements(GL_TRIANGLES, end - first, first);
+		drawCalls++;
+	}
+}
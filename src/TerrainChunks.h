@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+#include "Frustum.h"
+
+//  Terrain mesh split into chunks along the upper levels of the Octree,
+//  for view frustum culling.
+//
+//  Each octree node at "chunkLevel" (or a leaf above it) becomes a chunk.
+//  Triangles are binned by chunk and the index buffer is reordered so each
+//  chunk is one contiguous draw range.  A small tree mirroring the octree
+//  levels above the chunks, refit to the triangles' actual bounds, is what
+//  the frustum is tested against.  create() and cull() don't touch GL.
+//
+//  Each chunk also gets coarser levels of detail, built at startup by
+//  vertex clustering on a grid that doubles in size per level.  Vertices
+//  shared with a neighboring chunk are never clustered, so every level
+//  keeps the exact full resolution chunk border and any mix of levels
+//  stitches without cracks.  selectLods() picks the coarsest level whose
+//  geometric error projects to under maxPixelError on screen.  LODs are
+//  only for drawing; the Octree and collisions keep the full mesh.
+//
+#define TERRAIN_LODS 4
+
+class TerrainChunk {
+public:
+	Box bounds;
+	int first = 0;		// offset into indices, full resolution
+	int count = 0;		// number of indices, full resolution
+
+	// per level of detail; level 0 is the full resolution range above
+	//
+	int lodFirst[TERRAIN_LODS] = { 0 };
+	int lodCount[TERRAIN_LODS] = { 0 };
+	float lodError[TERRAIN_LODS] = { 0 };	// max vertex displacement
+};
+
+//  What one viewport draws of the terrain: the chunks in its camera's
+//  frustum and the level of detail picked for each from that camera
+//
+class TerrainView {
+public:
+	vector<int> chunks;
+	vector<int> lods;
+	int triangles = 0;			// full resolution
+	int lodTriangles = 0;		// at the selected levels
+};
+
+class ChunkNode {
+public:
+	Box bounds;
+	bool empty = true;
+	int chunk = -1;			// chunk index if this node is a chunk
+	vector<int> children;	// node indices otherwise
+};
+
+class TerrainChunks {
+public:
+	void create(const Octree & octree, int chunkLevel, int numLods = 1);
+	int cull(const Frustum & frustum, vector<int> & visibleRtn) const;
+	int selectLods(const vector<int> & visible, const glm::vec3 & eye, float pixelsPerUnit,
+		float maxPixelError, vector<int> & lodsRtn) const;
+	void setupVbo(const ofMesh & mesh);
+	void update(const ofMesh & mesh, const Box & region, int first, int last, float displacement);
+	void draw(const vector<int> & visible);
+	void draw(const vector<int> & visible, const vector<int> & lods);
+
+	vector<TerrainChunk> chunks;
+	vector<ChunkNode> nodes;		// nodes[0] is the root
+	vector<ofIndexType> indices;	// triangles grouped by level, then chunk
+	int numLods = 1;
+	int numTriangles = 0;			// full resolution
+	ofVbo vbo;
+
+	// stats from the last cull() / draw()
+	//
+	mutable int visibleChunks = 0;
+	mutable int visibleTriangles = 0;	// full resolution
+	mutable int lodTriangles = 0;		// after selectLods()
+	int drawCalls = 0;
+
+private:
+	int buildNode(const TreeNode & node, int level, int chunkLevel, vector<int> & vertexChunk);
+	void refit(int id);
+	void cullNode(const Frustum & frustum, int id, bool inside, vector<int> & visibleRtn) const;
+	void buildLod(const ofMesh & mesh, int level, float cellSize, const vector<bool> & locked);
+	vector<pair<int, int>> ranges;		// scratch for draw()
+};
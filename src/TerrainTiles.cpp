@@ -0,0 +1,391 @@
+
+#include "TerrainTiles.h"
+#include "CompiledMesh.h"
+#include "Util.h"
+#include "Profiler.h"
+
+// rough memory held by a loaded tile: the mesh, the octree's nodes and
+// point lists, and the height field
+//
+static size_t tileBytes(const TileData & data) {
+	const ofMesh & mesh = data.octree.mesh;
+	const HeightField & field = data.heightField;
+	size_t bytes = sizeof(TileData);
+	bytes += mesh.getNumVertices() * sizeof(glm::vec3);
+	bytes += mesh.getNumNormals() * sizeof(glm::vec3);
+	bytes += mesh.getNumTexCoords() * sizeof(glm::vec2);
+	bytes += mesh.getNumIndices() * sizeof(ofIndexType);
+	bytes += data.octree.nodeBytes();
+	bytes += (field.heights.size() + field.minHeights.size() + field.maxHeights.size()) * sizeof(float);
+	bytes += field.normals.size() * sizeof(ofVec3f);
+	bytes += (field.cellStart.size() + field.cellTris.size()) * sizeof(int);
+	bytes += field.triVerts.size() * sizeof(glm::vec3);
+	bytes += field.overhang.size() / 8;
+	return bytes;
+}
+
+// Loader thread: read each requested tile's mesh and octree, building
+// the octree only if the tile doesn't store one, and build its height
+// field.  Nothing here touches GL.
+//
+void TileLoader::threadedFunction() {
+	Profiler::get().setThreadName("tile loader");
+	pair<int, string> request;
+	while (requests.receive(request)) {
+		PROFILE_SCOPE("tiles/load");
+		TileData *data = new TileData();
+		Octree & octree = data->octree;
+		if (ofFilePath::getFileExt(request.second) == "mesh") {
+			CompiledMesh compiled;
+			compiled.load(request.second, octree);
+		}
+		else octree.mesh.load(request.second);
+		if (octree.mesh.getNumVertices() > 0) {
+			if (octree.isCompact())
+				data->heightField.create(octree, fieldRes);
+			else {
+				octree.build(octreeLevels);
+				data->heightField.create(octree, fieldRes);
+				octree.compact();
+			}
+		}
+		else cout << "tiles: can't load " << request.second << endl;
+		data->bytes = tileBytes(*data);
+		results.send(make_pair(request.first, data));
+	}
+}
+
+// Read the tile index of the map in "dir" and start the loader.
+// No tile is loaded until update() asks for it.
+//
+bool TerrainTiles::load(const string & dir) {
+	string indexPath = ofFilePath::join(dir, "index.json");
+	if (!ofFile::doesFileExist(indexPath)) return false;
+	ofJson j = ofLoadJson(indexPath);
+	if (j.is_null() || !j.count("tiles") || !j.count("origin")) {
+		cout << "tiles: can't read " << indexPath << endl;
+		return false;
+	}
+	origin = ofVec2f(j["origin"][0].get<float>(), j["origin"][1].get<float>());
+	tileSize = j.value("tileSize", 0.0f);
+	tilesX = j.value("tilesX", 0);
+	tilesZ = j.value("tilesZ", 0);
+	if (tileSize <= 0 || tilesX <= 0 || tilesZ <= 0) {
+		cout << "tiles: bad tile grid in " << indexPath << endl;
+		tilesX = tilesZ = 0;
+		return false;
+	}
+
+	tiles.assign(tilesX * tilesZ, TerrainTile());
+	for (auto & t : j["tiles"]) {
+		int i = t.value("i", -1);
+		int k = t.value("k", -1);
+		if (i < 0 || i >= tilesX || k < 0 || k >= tilesZ) continue;
+		TerrainTile & tile = tiles[k * tilesX + i];
+		tile.i = i;
+		tile.k = k;
+		tile.file = ofToDataPath(ofFilePath::join(dir, t.value("file", string(""))), true);
+		tile.bounds = Box(Vector3(t["min"][0].get<float>(), t["min"][1].get<float>(), t["min"][2].get<float>()),
+			Vector3(t["max"][0].get<float>(), t["max"][1].get<float>(), t["max"][2].get<float>()));
+	}
+	loader.startThread();
+	return true;
+}
+
+// stop the loader and free every tile
+//
+void TerrainTiles::close() {
+	if (loader.isThreadRunning()) {
+		loader.requests.close();
+		loader.waitForThread(true);
+	}
+	pair<int, TileData *> done;
+	while (loader.results.tryReceive(done))
+		delete done.second;
+	for (int t = 0; t < tiles.size(); t++)
+		if (tiles[t].state == TerrainTile::Resident) evict(t);
+	tiles.clear();
+	tilesX = tilesZ = 0;
+}
+
+// Page tiles in and out around p, once a frame.  Must be called from
+// the main (GL) thread
+//
+void TerrainTiles::update(const glm::vec3 & p) {
+	if (!isLoaded()) return;
+	frame++;
+
+	// take the tiles the loader has finished
+	//
+	pair<int, TileData *> done;
+	while (loader.results.tryReceive(done)) {
+		TerrainTile & tile = tiles[done.first];
+		tile.data = done.second;
+		tile.state = TerrainTile::Resident;
+		if (tile.data->octree.mesh.getNumVertices() > 0)
+			tile.vbo.setMesh(tile.data->octree.mesh, GL_STATIC_DRAW);
+		numResident++;
+		residentBytes += tile.data->bytes;
+		loads++;
+	}
+
+	// request every tile within loadRadius of p
+	//
+	int i0 = ofClamp(floor((p.x - loadRadius - origin.x) / tileSize), 0, tilesX - 1);
+	int i1 = ofClamp(floor((p.x + loadRadius - origin.x) / tileSize), 0, tilesX - 1);
+	int k0 = ofClamp(floor((p.z - loadRadius - origin.y) / tileSize), 0, tilesZ - 1);
+	int k1 = ofClamp(floor((p.z + loadRadius - origin.y) / tileSize), 0, tilesZ - 1);
+	for (int k = k0; k <= k1; k++) {
+		for (int i = i0; i <= i1; i++) {
+			int t = k * tilesX + i;
+			TerrainTile & tile = tiles[t];
+			tile.lastUsed = frame;
+			if (tile.state == TerrainTile::Unloaded) {
+				tile.state = TerrainTile::Requested;
+				loader.requests.send(make_pair(t, tile.file));
+			}
+		}
+	}
+	peakBytes = MAX(peakBytes, residentBytes);
+
+	// over budget: free the least recently used tiles that weren't
+	// wanted this frame.  Tiles around p are never evicted, even if
+	// they alone are over budget
+	//
+	if (residentBytes > memoryBudget) {
+		vector<pair<uint64_t, int>> lru;
+		for (int t = 0; t < tiles.size(); t++) {
+			if (tiles[t].state == TerrainTile::Resident && tiles[t].lastUsed < frame)
+				lru.push_back(make_pair(tiles[t].lastUsed, t));
+		}
+		sort(lru.begin(), lru.end());
+		for (int n = 0; n < lru.size() && residentBytes > memoryBudget; n++)
+			evict(lru[n].second);
+	}
+}
+
+void TerrainTiles::evict(int t) {
+	TerrainTile & tile = tiles[t];
+	residentBytes -= tile.data->bytes;
+	delete tile.data;
+	tile.data = NULL;
+	tile.vbo.clear();
+	tile.state = TerrainTile::Unloaded;
+	numResident--;
+	evictions++;
+}
+
+// draw the resident tiles
+//
+void TerrainTiles::draw() {
+	for (int t = 0; t < tiles.size(); t++) {
+		TerrainTile & tile = tiles[t];
+		if (tile.state != TerrainTile::Resident || !tile.vbo.getIsAllocated()) continue;
+		if (tile.vbo.getUsingIndices())
+			tile.vbo.drawElements(GL_TRIANGLES, tile.vbo.getNumIndices());
+		else
+			tile.vbo.draw(GL_TRIANGLES, 0, tile.vbo.getNumVertices());
+	}
+}
+
+// index of the tile under x/z, or -1 off the map
+//
+int TerrainTiles::tileAt(float x, float z) const {
+	if (!isLoaded()) return -1;
+	int i = floor((x - origin.x) / tileSize);
+	int k = floor((z - origin.y) / tileSize);
+	if (i < 0 || i >= tilesX || k < 0 || k >= tilesZ) return -1;
+	return k * tilesX + i;
+}
+
+// the data of tile t if it's resident, counting a miss if it isn't
+//
+TileData * TerrainTiles::resident(int t) {
+	if (t < 0) return NULL;
+	TerrainTile & tile = tiles[t];
+	if (tile.state != TerrainTile::Resident) {
+		misses++;
+		return NULL;
+	}
+	tile.lastUsed = frame;
+	return tile.data;
+}
+
+// Ground height and normal at x/z from the resident tile under it,
+// through the tile's height field, or its octree over overhangs
+//
+bool TerrainTiles::getGround(float x, float z, float & heightRtn, ofVec3f & normalRtn) const {
+	int t = tileAt(x, z);
+	if (t < 0 || tiles[t].state != TerrainTile::Resident || !tiles[t].data->heightField.isCreated())
+		return false;
+	const TileData *data = tiles[t].data;
+	const HeightField & field = data->heightField;
+	if (!field.isOverhang(x, z) && field.getGround(x, z, heightRtn, normalRtn))
+		return true;
+
+	const Octree & octree = data->octree;
+	float top = octree.root.box.parameters[1].y() + 1;
+	Ray ray = Ray(Vector3(x, top, z), Vector3(0, -1, 0));
+	int point;
+	if (!octree.intersect(ray, point)) return false;
+	heightRtn = octree.mesh.getVertex(point).y;
+	normalRtn = field.getNormal(x, z);
+	return true;
+}
+
+// Ground contact for a box against every resident tile under it.  A
+// tile's height field can only rule contact out (see maxHeightIn); the
+// rest goes to its octree, and the octree boxes touched are returned in
+// boxListRtn
+//
+bool TerrainTiles::intersect(const Box & box, vector<Box> & boxListRtn) {
+	const Vector3 & min = box.parameters[0];
+	const Vector3 & max = box.parameters[1];
+	bool hit = false;
+	for (int t = 0; t < tiles.size(); t++) {
+		const Box & b = tiles[t].bounds;
+		if (max.x() < b.parameters[0].x() || min.x() > b.parameters[1].x() ||
+			max.z() < b.parameters[0].z() || min.z() > b.parameters[1].z())
+			continue;
+		TileData *data = resident(t);
+		if (data == NULL || !data->heightField.isCreated()) continue;
+		float top;
+		if (data->heightField.maxHeightIn(box, top) && min.y() > top)
+			continue;
+		if (data->octree.intersect(box, boxListRtn))
+			hit = true;
+	}
+	return hit;
+}
+
+// The terrain point a ray hits, searching the octree of every resident
+// tile the ray passes through.  The hit nearest the ray's origin wins
+//
+bool TerrainTiles::intersect(const Ray & ray, ofVec3f & pointRtn) {
+	bool hit = false;
+	float nearest = FLT_MAX;
+	for (int t = 0; t < tiles.size(); t++) {
+		if (tiles[t].state != TerrainTile::Resident || !tiles[t].bounds.intersect(ray, 0, FLT_MAX))
+			continue;
+		TileData *data = resident(t);
+		int point;
+		if (!data->octree.intersect(ray, point)) continue;
+		glm::vec3 p = data->octree.mesh.getVertex(point);
+		Vector3 d = Vector3(p.x, p.y, p.z) - ray.origin;
+		if (d * d < nearest) {
+			nearest = d * d;
+			pointRtn = p;
+			hit = true;
+		}
+	}
+	return hit;
+}
+
+// the height field of the resident tile under x/z, or NULL off the map
+// or where the tile isn't in
+//
+const HeightField * TerrainTiles::residentField(float x, float z) const {
+	int t = tileAt(x, z);
+	if (t < 0 || tiles[t].state != TerrainTile::Resident || !tiles[t].data->heightField.isCreated())
+		return NULL;
+	return &tiles[t].data->heightField;
+}
+
+bool TerrainTiles::inBounds(float x, float z) const {
+	const HeightField *field = residentField(x, z);
+	return field != NULL && field->inBounds(x, z);
+}
+
+// below anything, off the resident tiles, so nothing collides there
+//
+float TerrainTiles::getHeight(float x, float z) const {
+	const HeightField *field = residentField(x, z);
+	return field != NULL ? field->getHeight(x, z) : -FLT_MAX;
+}
+
+ofVec3f TerrainTiles::getNormal(float x, float z) const {
+	const HeightField *field = residentField(x, z);
+	return field != NULL ? field->getNormal(x, z) : ofVec3f(0, 1, 0);
+}
+
+float TerrainTiles::maxHeight(float x, float z) const {
+	const HeightField *field = residentField(x, z);
+	return field != NULL ? field->maxHeight(x, z) : -FLT_MAX;
+}
+
+// height of the synthetic terrain, a few octaves of noise
+//
+static float syntheticHeight(float x, float z) {
+	return 40 * ofNoise(x * .002, z * .002) + 8 * ofNoise(x * .02, z * .02) + ofNoise(x * .2, z * .2);
+}
+
+// A size x size square of synthetic terrain with its corner at x0, z0,
+// a grid of quads x quads squares
+//
+ofMesh TerrainTiles::syntheticMesh(float x0, float z0, float size, int quads) {
+	ofMesh mesh;
+	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+	float step = size / quads;
+	for (int r = 0; r <= quads; r++) {
+		for (int c = 0; c <= quads; c++) {
+			float x = x0 + c * step;
+			float z = z0 + r * step;
+			mesh.addVertex(glm::vec3(x, syntheticHeight(x, z), z));
+			float dx = syntheticHeight(x + step, z) - syntheticHeight(x - step, z);
+			float dz = syntheticHeight(x, z + step) - syntheticHeight(x, z - step);
+			mesh.addNormal(glm::normalize(glm::vec3(-dx, 2 * step, -dz)));
+		}
+	}
+	for (int r = 0; r < quads; r++) {
+		for (int c = 0; c < quads; c++) {
+			ofIndexType v = r * (quads + 1) + c;
+			mesh.addTriangle(v, v + quads + 1, v + 1);
+			mesh.addTriangle(v + 1, v + quads + 1, v + quads + 2);
+		}
+	}
+	return mesh;
+}
+
+// Write a synthetic tilesX x tilesZ map to "dir", centered on the
+// origin, each tile a grid of quads x quads squares compiled with its
+// octree of octreeLevels levels.  Border vertices are shared exactly
+// between neighboring tiles
+//
+bool TerrainTiles::generate(const string & dir, int tilesX, int tilesZ, float tileSize, int quads, int octreeLevels) {
+	ofDirectory::createDirectory(dir, true, true);
+	ofJson index;
+	float ox = -tilesX * tileSize / 2;
+	float oz = -tilesZ * tileSize / 2;
+	index["origin"] = { ox, oz };
+	index["tileSize"] = tileSize;
+	index["tilesX"] = tilesX;
+	index["tilesZ"] = tilesZ;
+	index["tiles"] = ofJson::array();
+
+	for (int k = 0; k < tilesZ; k++) {
+		for (int i = 0; i < tilesX; i++) {
+			Octree octree;
+			octree.create(syntheticMesh(ox + i * tileSize, oz + k * tileSize, tileSize, quads), octreeLevels);
+			octree.compact();
+			const ofMesh & mesh = octree.mesh;
+			float ymin = FLT_MAX, ymax = -FLT_MAX;
+			for (auto & v : mesh.getVertices()) {
+				ymin = MIN(ymin, v.y);
+				ymax = MAX(ymax, v.y);
+			}
+
+			string file = "tile_" + ofToString(i) + "_" + ofToString(k) + ".mesh";
+			if (!CompiledMesh::save(mesh, glm::mat4(1), ofFilePath::join(dir, file), &octree))
+				return false;
+
+			ofJson tile;
+			tile["i"] = i;
+			tile["k"] = k;
+			tile["file"] = file;
+			tile["min"] = { ox + i * tileSize, ymin, oz + k * tileSize };
+			tile["max"] = { ox + (i + 1) * tileSize, ymax, oz + (k + 1) * tileSize };
+			index["tiles"].push_back(tile);
+		}
+	}
+	return ofSavePrettyJson(ofFilePath::join(dir, "index.json"), index);
+}
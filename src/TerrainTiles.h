@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Octree.h"
+#include "HeightField.h"
+
+//  Terrain split into square tiles on disk and streamed in and out
+//  around the lander, for landing sites larger than memory.
+//
+//  A tiled map is a directory in the data folder holding one mesh per
+//  tile and an index.json with the tile grid and each tile's bounds:
+//
+//    { "origin": [x, z], "tileSize": 100, "tilesX": 16, "tilesZ": 16,
+//      "tiles": [ { "i": 0, "k": 0, "file": "tile_0_0.mesh",
+//                   "min": [x, y, z], "max": [x, y, z] }, ... ] }
+//
+//  Tiles are compiled meshes (CompiledMesh) carrying their compacted
+//  Octree, so loading one doesn't rebuild its tree; a .ply tile (or a
+//  compiled one without nodes) has its octree built on load instead.
+//
+//  update() requests every tile within loadRadius of the lander from a
+//  loader thread, which reads the mesh and octree and builds the tile's
+//  HeightField.  Finished tiles are uploaded to GL in update(), on the
+//  main thread.  When the resident tiles go over memoryBudget the least
+//  recently used ones outside loadRadius are freed.  Queries only look
+//  at resident tiles; a query over a tile that isn't in yet is a miss.
+//  The resident tiles' height fields are also a HeightSource, the ground
+//  for particles.
+//
+
+// everything the loader thread builds for a tile
+//
+class TileData {
+public:
+	Octree octree;				// octree.mesh is the tile's mesh
+	HeightField heightField;
+	size_t bytes = 0;			// estimated memory used
+};
+
+class TerrainTile {
+public:
+	enum State { Unloaded = 0, Requested, Resident };
+
+	int i = 0, k = 0;
+	string file;
+	Box bounds;
+	State state = Unloaded;
+	TileData *data = NULL;		// when Resident
+	ofVbo vbo;
+	uint64_t lastUsed = 0;		// frame the tile was last wanted or queried
+};
+
+class TileLoader : public ofThread {
+public:
+	void threadedFunction();
+
+	ofThreadChannel<pair<int, string>> requests;	// tile index, mesh path
+	ofThreadChannel<pair<int, TileData *>> results;
+	int octreeLevels = 10;
+	int fieldRes = 64;
+};
+
+class TerrainTiles : public HeightSource {
+public:
+	~TerrainTiles() { close(); }
+	bool load(const string & dir);
+	void close();
+	void update(const glm::vec3 & p);
+	void draw();
+	bool isLoaded() const { return tilesX > 0; }
+
+	int tileAt(float x, float z) const;
+	bool getGround(float x, float z, float & heightRtn, ofVec3f & normalRtn) const;
+	bool intersect(const Box & box, vector<Box> & boxListRtn);
+	bool intersect(const Ray & ray, ofVec3f & pointRtn);
+
+	// HeightSource, over the resident tiles.  Off the resident tiles the
+	// ground is out of bounds, without counting misses
+	//
+	bool isCreated() const { return isLoaded(); }
+	bool inBounds(float x, float z) const;
+	float getHeight(float x, float z) const;
+	ofVec3f getNormal(float x, float z) const;
+	float maxHeight(float x, float z) const;
+	float stepSize() const { return tileSize / loader.fieldRes; }
+
+	static bool generate(const string & dir, int tilesX, int tilesZ, float tileSize, int quads, int octreeLevels = 10);
+	static ofMesh syntheticMesh(float x0, float z0, float size, int quads);
+
+	vector<TerrainTile> tiles;		// tiles[k * tilesX + i]
+	ofVec2f origin;					// x/z of the corner of tile 0, 0
+	float tileSize = 0;
+	int tilesX = 0, tilesZ = 0;
+	TileLoader loader;
+
+	float loadRadius = 150;					// x/z distance tiles are kept in around the lander
+	size_t memoryBudget = 256 * 1024 * 1024;
+
+	// stats
+	//
+	uint64_t frame = 0;
+	int numResident = 0;
+	size_t residentBytes = 0;
+	size_t peakBytes = 0;
+	int loads = 0;
+	int evictions = 0;
+	int misses = 0;					// queries over a tile that wasn't resident
+
+private:
+	void evict(int t);
+	TileData * resident(int t);
+	const HeightField * residentField(float x, float z) const;
+};
@@ -1,12 +1,45 @@
 #pragma once
 //  Kevin M. Smith - CS 134 SJSU
 
-#include "ofMain.h"
+#include <cmath>
+#include <cstddef>
 
-bool rayIntersectPlane(const ofVec3f &rayPoint, const ofVec3f &raydir, ofVec3f const &planePoint,
-	const ofVec3f &planeNorm, ofVec3f &point);
+//  No openFrameworks here, so this builds into the core library.  The
+//  vector functions are templates over any vector type with dot(), so
+//  they take ofVec3f (or Vector3) as they are.
+//
 
-ofVec3f reflectVector(const ofVec3f &v, const ofVec3f &normal);
+//---------------------------------------------------------------
+// test if a ray intersects a plane.  If there is an intersection, 
+// return true and put point of intersection in "point"
+//
+template <class V>
+bool rayIntersectPlane(const V &rayPoint, const V &raydir, V const &planePoint,
+	const V &planeNorm, V &point)
+{
+	// if d1 is 0, then the ray is on the plane or there is no intersection
+	//
+	const float eps = .000000001;
+	float d1 = (planePoint - rayPoint).dot(planeNorm);
+	if (std::abs(d1) < eps) return false;
 
+	//  if d2 is 0, then the ray is parallel to the plane
+	//
+	float d2 = raydir.dot(planeNorm);
+	if (std::abs(d2) < eps) return false;
 
+	//  compute the intersection point and return it in "point"
+	//
+	point = raydir * (d1 / d2) + rayPoint;
+	return true;
+}
 
+// Compute the reflection of a vector incident on a surface at the normal.
+// 
+//
+template <class V>
+V reflectVector(const V &v, const V &n) {
+	return (v - n * (2 * v.dot(n)));
+}
+
+size_t peakRss();
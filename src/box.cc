@@ -13,25 +13,22 @@
  */
 
 bool Box::intersect(const Ray &r, float t0, float t1) const {
-	float tmin, tmax, tymin, tymax, tzmin, tzmax;
-
-	tmin = (parameters[r.sign[0]].x() - r.origin.x()) * r.inv_direction.x();
-	tmax = (parameters[1 - r.sign[0]].x() - r.origin.x()) * r.inv_direction.x();
-	tymin = (parameters[r.sign[1]].y() - r.origin.y()) * r.inv_direction.y();
-	tymax = (parameters[1 - r.sign[1]].y() - r.origin.y()) * r.inv_direction.y();
-	if ((tmin > tymax) || (tymin > tmax))
-		return false;
-	if (tymin > tmin)
-		tmin = tymin;
-	if (tymax < tmax)
-		tmax = tymax;
-	tzmin = (parameters[r.sign[2]].z() - r.origin.z()) * r.inv_direction.z();
-	tzmax = (parameters[1 - r.sign[2]].z() - r.origin.z()) * r.inv_direction.z();
-	if ((tmin > tzmax) || (tzmin > tmax))
-		return false;
-	if (tzmin > tmin)
-		tmin = tzmin;
-	if (tzmax < tmax)
-		tmax = tzmax;
-	return ((tmin < t1) && (tmax > t0));
+	// all three slabs at once, in float4 lanes: distances along the ray to
+	// the planes of both corners.  The nearer of each pair is where the
+	// ray enters that slab and the farther where it leaves, and it's in
+	// the box between the last entry and the first exit.  A ray lying in
+	// a slab's plane gives 0 * inf = NaN there; the max/min with -inf and
+	// inf turn that into "in the slab the whole way" (min/max return their
+	// second operand for NaN), so grazing rays hit, as grazing points are
+	// inside()
+	//
+	const float4::f4 inf = float4::splat(INFINITY);
+	const float4::f4 ninf = float4::splat(-INFINITY);
+	float4::f4 o = r.origin.simd();
+	float4::f4 inv = r.inv_direction.simd();
+	float4::f4 ta = float4::mul(float4::sub(parameters[0].simd(), o), inv);
+	float4::f4 tb = float4::mul(float4::sub(parameters[1].simd(), o), inv);
+	float tmin = float4::max3(float4::min(float4::max(ta, ninf), float4::max(tb, ninf)));
+	float tmax = float4::min3(float4::max(float4::min(ta, inf), float4::min(tb, inf)));
+	return (tmin <= tmax) & (tmin < t1) & (tmax > t0);
 }
@@ -19,10 +19,8 @@
 class Box {
 public:
 	Box() { }
-	Box(const Vector3 &min, const Vector3 &max) {
+	constexpr Box(const Vector3 &min, const Vector3 &max) : parameters{ min, max } {
 		//     assert(min < max);
-		parameters[0] = min;
-		parameters[1] = max;
 	}
 	// (t0, t1) is the interval for valid hits
 	bool intersect(const Ray &, float t0, float t1) const;
@@ -30,14 +28,23 @@ public:
 	// corners
 	Vector3 parameters[2];
 
-	Vector3 min() { return parameters[0]; }
-	Vector3 max() { return parameters[1]; }
-	const bool inside(const Vector3 &p) {
-		return ((p.x() >= parameters[0].x() && p.x() <= parameters[1].x()) &&
-			(p.y() >= parameters[0].y() && p.y() <= parameters[1].y()) &&
-			(p.z() >= parameters[0].z() && p.z() <= parameters[1].z()));
+	const Vector3 & min() const { return parameters[0]; }
+	const Vector3 & max() const { return parameters[1]; }
+
+	// the point is compared with both corners in float4 lanes, x, y and
+	// z at once.  p points at three packed floats, e.g. a vertex in a
+	// mesh's vertex array, so points can be tested where they are
+	//
+	bool inside(float4::f4 v) const {
+		return (float4::lessEqual(parameters[0].simd(), v) & float4::lessEqual(v, parameters[1].simd())) == 7;
+	}
+	bool inside(const Vector3 &p) const {
+		return inside(p.simd());
 	}
-	const bool inside(Vector3 *points, int size) {
+	bool inside(const float *p) const {
+		return inside(float4::load3(p));
+	}
+	bool inside(const Vector3 *points, int size) const {
 		bool allInside = true;
 		for (int i = 0; i < size; i++) {
 			if (!inside(points[i])) allInside = false;
@@ -47,27 +54,56 @@ public:
 	}
 
 	// implement for Homework Project
+	// both pairs of corners compared at once, without branching, since
+	// most tests against the lander come out false
+	//
+	bool overlap(const Box &box) const {
+		return (float4::lessEqual(parameters[0].simd(), box.parameters[1].simd()) &
+			float4::lessEqual(box.parameters[0].simd(), parameters[1].simd())) == 7;
+	}
+
+	// the smallest box holding every point.  Four running corners, so
+	// each min/max doesn't wait on the one before
 	//
-	bool overlap(const Box &box) {
-		// Holds box2 instance
-		Box box2 = box;
-		// Box 1 min and max vertices
-		Vector3 box1min = Vector3(min());
-		Vector3 box1max = Vector3(max());
-		// Box 2 min and max vertices
-		Vector3 box2min = Vector3(box2.min());
-		Vector3 box2max = Vector3(box2.max());
-		// Checks if boxes overlap
-		if ((box1min.x() <= box2max.x() && box1max.x() >= box2min.x()) &&
-			(box1min.y() <= box2max.y() && box1max.y() >= box2min.y()) &&
-			(box1min.z() <= box2max.z() && box1max.z() >= box2min.z()))
-			return true;
-		return false;
+	static Box bounds(const Vector3View &points) {
+		if (points.empty()) return Box(Vector3(0, 0, 0), Vector3(0, 0, 0));
+		float4::f4 lo[4], hi[4];
+		for (int k = 0; k < 4; k++)
+			lo[k] = hi[k] = points[0].simd();
+		size_t n = points.size(), i = 1;
+		for (; i + 4 <= n; i += 4) {
+			for (int k = 0; k < 4; k++) {
+				float4::f4 v = float4::load3(points.point(i + k));
+				lo[k] = float4::min(lo[k], v);
+				hi[k] = float4::max(hi[k], v);
+			}
+		}
+		for (; i < n; i++) {
+			float4::f4 v = float4::load3(points.point(i));
+			lo[0] = float4::min(lo[0], v);
+			hi[0] = float4::max(hi[0], v);
+		}
+		return Box(Vector3(float4::min(float4::min(lo[0], lo[1]), float4::min(lo[2], lo[3]))),
+			Vector3(float4::max(float4::max(hi[0], hi[1]), float4::max(hi[2], hi[3]))));
 	}
 
-	Vector3 center() {
+	Vector3 center() const {
 		return ((max() - min()) / 2 + min());
 	}
+
+	// one of the eight equal boxes the box splits into: octants 0-3 on
+	// the ground floor going around x/z, then 4-7 the story above.  The
+	// octree's nodes are these boxes (Octree::octantBox)
+	//
+	Box octant(int o) const {
+		static const Vector3 step[8] = {
+			Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 0, 1), Vector3(0, 0, 1),
+			Vector3(0, 1, 0), Vector3(1, 1, 0), Vector3(1, 1, 1), Vector3(0, 1, 1)
+		};
+		Vector3 half = (max() - min()) / 2;
+		Vector3 offset(float4::mul(half.simd(), step[o].simd()));
+		return Box(min() + offset, half + min() + offset);
+	}
 };
 
 #endif // _BOX_H_
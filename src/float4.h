@@ -0,0 +1,101 @@
+#ifndef _FLOAT4_H_
+#define _FLOAT4_H_
+
+/*
+ * Four float lanes for Vector3 and Box: SSE registers where the target
+ * has SSE2 (every x86-64), plain arrays elsewhere or when VECTOR3_NO_SIMD
+ * is defined.  Only the fourth lane differs between the two; callers
+ * look at x, y and z (the masks below are masked to those three) and
+ * keep w at 0.
+ *
+ */
+
+#if !defined(VECTOR3_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define VECTOR3_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace float4 {
+
+#ifdef VECTOR3_SSE
+
+typedef __m128 f4;
+
+// p must be 16 byte aligned
+inline f4 load(const float *p) { return _mm_load_ps(p); }
+inline void store(float *p, f4 a) { _mm_store_ps(p, a); }
+
+// three packed floats, e.g. a mesh vertex; w is 0.  Reads exactly 12
+// bytes, so it's safe on the last vertex of an array
+inline f4 load3(const float *p) {
+	return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)p)), _mm_load_ss(p + 2));
+}
+inline f4 splat(float s) { return _mm_set1_ps(s); }
+
+inline f4 add(f4 a, f4 b) { return _mm_add_ps(a, b); }
+inline f4 sub(f4 a, f4 b) { return _mm_sub_ps(a, b); }
+inline f4 mul(f4 a, f4 b) { return _mm_mul_ps(a, b); }
+inline f4 div(f4 a, f4 b) { return _mm_div_ps(a, b); }
+inline f4 min(f4 a, f4 b) { return _mm_min_ps(a, b); }
+inline f4 max(f4 a, f4 b) { return _mm_max_ps(a, b); }
+
+// bit i set where lane i of a <= b, for x, y and z
+inline int lessEqual(f4 a, f4 b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)) & 7; }
+inline int equal(f4 a, f4 b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) & 7; }
+
+// sum, smallest and largest of x, y and z
+inline float sum3(f4 a) {
+	f4 s = _mm_add_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehl_ps(a, a)));
+}
+inline float min3(f4 a) {
+	f4 m = _mm_min_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(_mm_min_ss(m, _mm_movehl_ps(a, a)));
+}
+inline float max3(f4 a) {
+	f4 m = _mm_max_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(_mm_max_ss(m, _mm_movehl_ps(a, a)));
+}
+
+#else
+
+struct f4 {
+	float v[4];
+};
+
+inline f4 load(const float *p) { return f4{ { p[0], p[1], p[2], p[3] } }; }
+inline void store(float *p, f4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline f4 load3(const float *p) { return f4{ { p[0], p[1], p[2], 0 } }; }
+inline f4 splat(float s) { return f4{ { s, s, s, s } }; }
+
+#define FLOAT4_LANES(expr) f4 r; for (int i = 0; i < 4; i++) r.v[i] = expr; return r;
+inline f4 add(f4 a, f4 b) { FLOAT4_LANES(a.v[i] + b.v[i]) }
+inline f4 sub(f4 a, f4 b) { FLOAT4_LANES(a.v[i] - b.v[i]) }
+inline f4 mul(f4 a, f4 b) { FLOAT4_LANES(a.v[i] * b.v[i]) }
+inline f4 div(f4 a, f4 b) { FLOAT4_LANES(a.v[i] / b.v[i]) }
+inline f4 min(f4 a, f4 b) { FLOAT4_LANES(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+inline f4 max(f4 a, f4 b) { FLOAT4_LANES(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+#undef FLOAT4_LANES
+
+inline int lessEqual(f4 a, f4 b) {
+	return (a.v[0] <= b.v[0]) | (a.v[1] <= b.v[1]) << 1 | (a.v[2] <= b.v[2]) << 2;
+}
+inline int equal(f4 a, f4 b) {
+	return (a.v[0] == b.v[0]) | (a.v[1] == b.v[1]) << 1 | (a.v[2] == b.v[2]) << 2;
+}
+
+inline float sum3(f4 a) { return a.v[0] + a.v[1] + a.v[2]; }
+inline float min3(f4 a) {
+	float m = a.v[0] < a.v[1] ? a.v[0] : a.v[1];
+	return m < a.v[2] ? m : a.v[2];
+}
+inline float max3(f4 a) {
+	float m = a.v[0] > a.v[1] ? a.v[0] : a.v[1];
+	return m > a.v[2] ? m : a.v[2];
+}
+
+#endif
+
+}
+
+#endif // _FLOAT4_H_
@@ -1,8 +1,13 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "Telemetry.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char *argv[]){
+	// telemetry reader: 3DLandingGame --telemetry-csv flight.tlm flight.csv
+	if (argc == 4 && string(argv[1]) == "--telemetry-csv")
+		return Telemetry::dumpCsv(argv[2], argv[3]) ? 0 : 1;
+
 	ofSetupOpenGL(1280, 1024,OF_WINDOW);			// <-------- setup the GL context
 
 	// this kicks off the running of my app
@@ -17,24 +17,42 @@ damaging the ship.
 // loads font, and sets initial fields of lights
 //
 void ofApp::setup() {
+	Profiler::get().setThreadName("main");
+
 	// texture loading
 	//
 	ofDisableArbTex();	// disable rectangular textures
 
+	// Loads the font first, the loading screen needs it
+	text.loadFont("arial.ttf", 15);
+
+	// The slow loads run as jobs on the asset loader: files are read
+	// and decoded on worker threads and uploaded to GL on this thread
+	// from update(), while draw() shows the loading screen
+	//
+
 	// load textures
 	//
-	if (!ofLoadImage(particleTex, "images/dot.png")) {
-		cout << "Particle Texture File: images/dot.png not found" << endl;
-		ofExit();
-	}
+	shared_ptr<ofPixels> particlePixels = make_shared<ofPixels>();
+	loader.add("particle texture", [particlePixels]() {
+		ofLoadImage(*particlePixels, "images/dot.png");
+	}, [this, particlePixels]() {
+		if (!particlePixels->isAllocated()) {
+			cout << "Particle Texture File: images/dot.png not found" << endl;
+			ofExit();
+		}
+		else particleTex.loadData(*particlePixels);
+	});
 
 	// load the shader
 	//
+	loader.add("shaders", nullptr, [this]() {
 #ifdef TARGET_OPENGLES
-	shader.load("shaders_gles/shader");
+		shader.load("shaders_gles/shader");
 #else
-	shader.load("shaders/shader");
+		shader.load("shaders/shader");
 #endif
+	});
 
 	// Sets up gui sliders to control octree levels displayed
 	// and to control positioning of the lights
@@ -48,8 +66,10 @@ void ofApp::setup() {
 
 	// Loads sound effects used for exhaust from ship
 	// and ship explosion
-	boom.load("sounds/boom.mp3");
-	exhaust.load("sounds/exhaust.mp3");
+	loader.add("sounds", nullptr, [this]() {
+		boom.load("sounds/boom.mp3");
+		exhaust.load("sounds/exhaust.mp3");
+	});
 
 	// Sets boolean values for terrain and display features
 	bWireframe = false;
@@ -117,28 +137,81 @@ void ofApp::setup() {
 	// Setup rudimentary lighting 
 	initLightingAndMaterials();
 
+	// Compiles the terrain to a binary mesh the first time (and when the
+	// source changes, or the compiled file is of another version); after
+	// that it's mapped in with no parsing.  Compiling goes through
+	// Assimp, which uploads to GL, so it can't be a job.  The lander
+	// isn't compiled: it draws from the cached Assimp model, which
+	// carries its materials and textures
+	//
+	if (CompiledMesh::isStale("geo/moon-houdini.obj", "geo/moon-houdini.mesh"))
+		CompiledMesh::compile("geo/moon-houdini.obj", "geo/moon-houdini.mesh");
+
 	// Loads the terrain
-	terrain.loadModel("geo/moon-houdini.obj");
-	terrain.setScaleNormalization(false);
-	boundingBox = meshBounds(terrain.getMesh(0));
+	// a tiled map in geo/tiles takes the place of the single mesh and
+	// is streamed in around the lander (see TerrainTiles)
+	bTiledTerrain = tiles.load("geo/tiles");
+	if (!bTiledTerrain) {
+		// the compiled terrain is handed to the octree as the only copy
+		loader.add("terrain", [this]() {
+			ofMesh terrainMesh;
+			CompiledMesh compiled;
+			if (!compiled.load("geo/moon-houdini.mesh", terrainMesh)) {
+				cout << "can't load terrain geo/moon-houdini.mesh" << endl;
+				return;
+			}
+			boundingBox = compiled.bounds;
+
+			// Create Octree
+			// the Z-order build also sorts the terrain's vertices so each
+			// node's points are together in memory
+			if (bMortonOctree)
+				octree.createMorton(std::move(terrainMesh), 20);
+			else
+				octree.create(std::move(terrainMesh), 20);
+
+			// Bakes coarse height field from the octree for particle collisions
+			heightField.create(octree, 256);
+
+			// Scores the terrain for landing on every core, or reads the
+			// scores cached by an earlier run
+			if (!landingMap.load("geo/moon-houdini.landing", octree, landingMapRes)) {
+				landingMap.create(octree, landingMapRes, std::thread::hardware_concurrency());
+				landingMap.save("geo/moon-houdini.landing");
+				cout << "landing map: " << landingMapRes << "x" << landingMapRes << " cells scored in " << landingMap.buildTime << "ms" << endl;
+			}
 
-	// Create Octree
-	octree.create(terrain.getMesh(0), 20);
+			// Splits the terrain into chunks along the upper octree levels
+			// so only the chunks in view are drawn, each with coarser LODs
+			terrainChunks.create(octree, 3, TERRAIN_LODS);
+
+			// Everything that walks the tree is built, so queries can
+			// run on the compact nodes from here on.  Compacted nodes
+			// can't be edited, so with craters on the tree is kept
+			// instead: about five times the node memory (lander_bench's
+			// tree_ and compact_ layout cases) and no faster queries,
+			// for a crash that reshapes the ground it hit.  Turn
+			// bCraters off to get the compact nodes
+			size_t treeBytes = octree.nodeBytes();
+			if (bCompactOctree && !bCraters) {
+				octree.compact();
+				cout << "octree: " << treeBytes / 1024 << " KB of nodes compacted to " << octree.nodeBytes() / 1024 << " KB" << endl;
+			}
+		}, [this]() {
+			if (octree.mesh.getNumVertices() == 0) {
+				ofExit();
+				return;
+			}
+			terrainChunks.setupVbo(octree.mesh);
+			cout << "terrain: peak RSS " << peakRss() / (1024 * 1024) << " MB" << endl;
+		});
+	}
+	terrainMaterial.setDiffuseColor(ofFloatColor(0.76, 0.78, 0.76));
 
-	// Sets the initial fields of the Ship instance lander
-	//
-	lander = new Ship("geo/lander.obj");			// Loads lander model
-	lander->thrust = 25.0;							// Sets thurst of lander
-	lander->gravity = ofVec3f(0, -8.0, 0);			// Sets gravity force applied to lander
-	lander->damping = 0.99;							// Sets damping of lander
-	lander->acceleration = glm::vec3(0, 0, 0);		// Sets initial acceleration of lander
-	lander->turnVelocity = 0;						// Sets the initial turn acceleration of lander
-	lander->velocity = glm::vec3(0, 0, 0);			// Sets initial velocity of lander
-	lander->turnVelocity = 0;						// Sets initial turn velocity of lander
-	lander->rotation = 0;							// Sets initial rotation angle of lander
-	lander->setPosition(ofVec3f(-50, 30, -50));		// Sets initial position of lander
-	lander->fuel = 200;								// Sets fuel of lander
-	lander->shipSelected = false;					// Lander begins not being selected
+	// Loads the lander (Assimp uploads to GL as it loads)
+	loader.add("lander", nullptr, [this]() {
+		setupLander();
+	});
 
 	// Fields for follow camera
 	// Shows perspective from side view of lander
@@ -147,8 +220,7 @@ void ofApp::setup() {
 
 	// Fields for top view camera
 	// Shows perspective from looking right below lander
-	top.setPosition(lander->getPosition());
-	top.lookAt(ofVec3f(lander->getPosition().x, 1, lander->getPosition().z));
+	// (placed over the lander in setupLander())
 	top.setNearClip(.1);
 	top.setFov(65.5);
 
@@ -165,28 +237,38 @@ void ofApp::setup() {
 	front.setNearClip(.1);
 	front.setFov(65.5);
 
-	// Sets up Emitter for lander exhaust effect
-	emitter.setRate(2.5);
-	emitter.setLifespan(0.25);
-	emitter.setParticleRadius(0.05);
-	emitter.setEmitterType(DiscEmitter);
-	emitter.setGroupSize(250);
+	// Registers the cameras with the rig that places them lazily
+	rig.add(CameraRig::Default, &cam);
+	rig.add(CameraRig::Top, &top);
+	rig.add(CameraRig::Follow, &follow);
+	rig.add(CameraRig::Front, &front);
+	rig.add(CameraRig::Ground, &ground);
+
+	// Sets up Emitters for lander exhaust and explosion effects
+	// from the effect definitions (hot reloaded in update())
+	if (!effects.load("effects.json")) {
+		ofExit();
+	}
+	effects.apply("exhaust", emitter);
+	effects.apply("explosion", explosion);
 
-	// Sets up Explosion Emitter
-	explosion.setRate(2.5);
-	explosion.setLifespan(1.0);
-	explosion.setParticleRadius(0.05);
-	explosion.setEmitterType(RadialEmitter);
-	explosion.setGroupSize(1000);
+	// Exhaust and explosion particles bounce off the terrain, the
+	// resident tiles' height fields on a tiled map
+	HeightSource *groundSource = bTiledTerrain ? (HeightSource *)&tiles : &heightField;
+	emitter.sys->terrain = groundSource;
+	explosion.sys->terrain = groundSource;
 
 	// Sets landing area
 	validLandingArea = Box(Vector3(-24.8, -1.6, -18.6), Vector3(21.7, 16.1, 27.5));
 
 	// Loads background image
-	background.load("images/space.png");
-
-	// Loads the font
-	text.loadFont("arial.ttf", 15);
+	shared_ptr<ofPixels> backgroundPixels = make_shared<ofPixels>();
+	loader.add("background", [backgroundPixels]() {
+		ofLoadImage(*backgroundPixels, "images/space.png");
+	}, [this, backgroundPixels]() {
+		if (backgroundPixels->isAllocated())
+			background.setFromPixels(*backgroundPixels);
+	});
 
 	// Sets initial boolean values for game logic
 	standBy = true;
@@ -194,12 +276,103 @@ void ofApp::setup() {
 	inBounds = false;
 	showNearest = false;
 	exploded = false;
+
+	loader.start(loadThreads);
+
+	// Records every step of the flights to disk (see Telemetry)
+	if (bTelemetry) {
+		ofDirectory::createDirectory("telemetry", true, true);
+		telemetry.open("telemetry/flight_" + ofGetTimestampString() + ".tlm");
+	}
+}
+
+// Stops the telemetry writer, after it writes out what's left
+//
+void ofApp::exit() {
+	telemetry.close();
+}
+
+// Sets the initial fields of the Ship instance lander
+// Runs on the asset loader once the other setup is done
+//
+void ofApp::setupLander() {
+	lander = new Ship("geo/lander.obj", models);	// Loads lander model
+	lander->thrust = 25.0;							// Sets thurst of lander
+	lander->gravity = ofVec3f(0, -8.0, 0);			// Sets gravity force applied to lander
+	lander->damping = 0.99;							// Sets damping of lander
+	lander->acceleration = glm::vec3(0, 0, 0);		// Sets initial acceleration of lander
+	lander->turnVelocity = 0;						// Sets the initial turn acceleration of lander
+	lander->velocity = glm::vec3(0, 0, 0);			// Sets initial velocity of lander
+	lander->turnVelocity = 0;						// Sets initial turn velocity of lander
+	lander->rotation = 0;							// Sets initial rotation angle of lander
+	lander->setPosition(ofVec3f(-50, 30, -50));		// Sets initial position of lander
+	lander->fuel = 200;								// Sets fuel of lander
+	lander->shipSelected = false;					// Lander begins not being selected
+
+	// Bounds of each of the lander's meshes for the debug overlay
+	bboxList = lander->getShipModel().getMeshBounds();
+
+	// Top view camera looks right below the lander
+	top.setPosition(lander->getPosition());
+	top.lookAt(ofVec3f(lander->getPosition().x, 1, lander->getPosition().z));
+}
+
+// Draws the loading screen while the asset loader runs
+//
+void ofApp::drawLoading() {
+	ofBackground(ofColor::black);
+	ofDisableLighting();
+	ofSetColor(ofColor::green);
+	string loadText = "Loading... " + std::to_string((int)(loader.getProgress() * 100)) + "%";
+	if (loader.lastFinished != "") loadText += " (" + loader.lastFinished + ")";
+	text.drawString(loadText, ofGetWindowWidth() / 2 - text.stringWidth(loadText) / 2, ofGetWindowHeight() / 2 - 20);
+	float w = ofGetWindowWidth() / 3;
+	ofNoFill();
+	ofDrawRectangle(ofGetWindowWidth() / 2 - w / 2, ofGetWindowHeight() / 2, w, 10);
+	ofFill();
+	ofDrawRectangle(ofGetWindowWidth() / 2 - w / 2, ofGetWindowHeight() / 2, w * loader.getProgress(), 10);
 }
 
 //--------------------------------------------------------------
 // incrementally update scene (animation)
 //
 void ofApp::update() {
+	// Finishes loading assets before anything else runs
+	if (!loader.isDone()) {
+		if (loader.update()) {
+			cout << "assets: first frame at " << firstFrameTime << "ms, loaded in " << loader.totalTime << "ms with " <<
+				loadThreads << " loader threads (" << loader.serialTime << "ms loading one at a time)" << endl;
+		}
+		return;
+	}
+
+	// Picks up edits to the effect definitions
+	if (effects.update()) {
+		effects.apply("exhaust", emitter);
+		effects.apply("explosion", explosion);
+	}
+
+	// Closes the profiler's previous frame, update is the first thing
+	// every frame runs
+	Profiler::get().endFrame();
+	PROFILE_SCOPE("update");
+
+	// Advances the tile streaming benchmark if it's running
+	if (tileBench != NULL)
+		stepTileBenchmark();
+
+	// Saves the geometry benchmarks once their thread is done
+	if (benchThread.finished())
+		saveBenchmarks();
+
+	// Pages terrain tiles in and out around the lander every frame, also
+	// while standing by or after a crash, so the tiles under it are in
+	// before the game starts and queued loads are always taken
+	if (bTiledTerrain) {
+		PROFILE_SCOPE("update/tiles");
+		tiles.update(lander->getPosition());
+	}
+
 	if (!gameOver && !standBy) {
 		// Update positioning of lights
 		keyLight.setPosition(keyLightPos);
@@ -218,79 +391,375 @@ void ofApp::update() {
 		}
 
 		// Adds Impulse Force for ground collision
-		this->checkCollisions();
-
-		// Handles physics movement of ship
-		lander->integrate();
+		{
+			PROFILE_SCOPE("update/collision");
+			this->checkCollisions();
+		}
+		contactImpulse = lander->impulseForce;	// integrate() clears it
 
-		// Handles physics rotation of ship
-		lander->integrateTurn();
+		// Handles physics movement and rotation of ship
+		{
+			PROFILE_SCOPE("update/integrate");
+			lander->integrate();
+			lander->integrateTurn();
+		}
 
-		// Update cameras relative to current position of lander
+		// Update camera target to current position of lander
+		// cameras are only placed when drawn (see CameraRig)
 		if (lander->getShipLoaded()) {
-			top.setPosition(lander->getPosition());
-			front.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y + 5, lander->getPosition().z - 5));
-			follow.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y, lander->getPosition().z + 40));
-			follow.lookAt(ofVec3f(lander->getPosition().x, lander->getPosition().y, lander->getPosition().z));
-			ground.lookAt(ofVec3f(lander->getPosition().x, lander->getPosition().y, lander->getPosition().z));
+			PROFILE_SCOPE("update/camera");
+			rig.setTarget(lander->getPosition());
 		}
 
 		// Updates the altitude variable
-		ofVec3f p;
-		raySelectLine(p);
-		altitude = lander->getPosition().y - p.y;
-
-		// Calls update on emitter for exhaust
-		emitter.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y + 2.5, lander->getPosition().z));
-		emitter.setOneShot(true);
-		emitter.setVelocity(ofVec3f(0, -25, 0));
-		emitter.update();
-
-		// Calls update on explosion emitter
-		explosion.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y + 2.5, lander->getPosition().z));
-		explosion.setOneShot(true);
-		explosion.setVelocity(ofVec3f(0, -25, 0));
-		explosion.update();
+		probeAltitude();
+		probeProximity();
+
+		// Calls update on the exhaust and explosion emitters
+		{
+			PROFILE_SCOPE("update/emitters");
+			emitter.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y + 2.5, lander->getPosition().z));
+			emitter.update();
+			explosion.setPosition(ofVec3f(lander->getPosition().x, lander->getPosition().y + 2.5, lander->getPosition().z));
+			explosion.update();
+		}
 
 		// Checks and Sets variables for game logic
 		if (lander->landed)
 			gameOver = true;
 		if (exploded)
 			lander->thrust = 0;		// Lander cannot move if it exploded
+
+		recordTelemetry();
 	}
 }
 
-// load vertex buffer in preparation for rendering
+// Hands this step's state to the flight recorder
 //
-void ofApp::loadVbo() {
-	if (emitter.sys->particles.size() < 1) return;
+void ofApp::recordTelemetry() {
+	if (!telemetry.isOpen()) return;
+	TelemetryRecord r;
+	r.frame = ofGetFrameNum();
+	r.time = ofGetElapsedTimef();
+	glm::vec3 p = lander->getPosition();
+	for (int k = 0; k < 3; k++) {
+		r.position[k] = p[k];
+		r.velocity[k] = lander->velocity[k];
+		r.impulse[k] = contactImpulse[k];
+	}
+	r.fuel = lander->fuel;
+	r.altitude = altitude;
+	r.particles = emitter.sys->particles.size() + explosion.sys->particles.size();
+	r.flight = flight;
+	r.flags = (lander->landed ? TelemetryRecord::Landed : 0) | (exploded ? TelemetryRecord::Exploded : 0) |
+		(gameOver ? TelemetryRecord::GameOver : 0);
+	telemetry.record(r);
+}
 
-	vector<ofVec3f> sizes;
-	vector<ofVec3f> points;
-	for (int i = 0; i < emitter.sys->particles.size(); i++) {
-		points.push_back(emitter.sys->particles[i].position);
-		sizes.push_back(ofVec3f(5));
+// Updates the altitude variable from the ground under the lander
+// the height field answers in constant time; the octree ray is
+// only needed over overhangs or off the edge of the terrain
+//
+void ofApp::probeAltitude() {
+	PROFILE_SCOPE("update/probe");
+	uint64_t probeStart = ofGetElapsedTimeMicros();
+	glm::vec3 landerPos = lander->getPosition();
+	float groundHeight;
+	ofVec3f groundNormal;
+	if (bTiledTerrain) {
+		// only the resident tiles can answer
+		bGroundPoint = tiles.getGround(landerPos.x, landerPos.z, groundHeight, groundNormal);
+		groundPoint = ofVec3f(landerPos.x, groundHeight, landerPos.z);
+		if (bGroundPoint)
+			groundSlope = ofRadToDeg(acos(ofClamp(groundNormal.y, -1, 1)));
 	}
-	// upload the data to the vbo
-	//
-	int total = (int)points.size();
-	vbo.clear();
-	vbo.setVertexData(&points[0], total, GL_STATIC_DRAW);
-	vbo.setNormalData(&sizes[0], total, GL_STATIC_DRAW);
+	else if (!heightField.isOverhang(landerPos.x, landerPos.z) &&
+		heightField.getGround(landerPos.x, landerPos.z, groundHeight, groundNormal)) {
+		groundPoint = ofVec3f(landerPos.x, groundHeight, landerPos.z);
+		groundSlope = ofRadToDeg(acos(ofClamp(groundNormal.y, -1, 1)));
+		bGroundPoint = true;
+	}
+	else {
+		bGroundPoint = raySelectLine(groundPoint);
+		groundSlope = heightField.getSlope(landerPos.x, landerPos.z);
+	}
+	if (bGroundPoint)
+		altitude = landerPos.y - groundPoint.y;
+	probeTime = (ofGetElapsedTimeMicros() - probeStart) / 1000.0;
 }
 
-//--------------------------------------------------------------
-void ofApp::draw() {
-	glDepthMask(false);
-	// Sets default color
-	ofSetColor(255, 255, 255);
-	// Draws background image
-	background.draw(0, 0);
-	// Draws gui
-	if (!bHide) gui.draw();
-	glDepthMask(true);
+// Terrain proximity sensor: the terrain points nearest the lander, how
+// many are within proximityRadius, and the clearance under the landing
+// legs, whose feet are taken as the bottom corners of the lander's box.
+// Unlike the altitude probe this sees terrain to the side as well as
+// below, such as crater walls
+//
+void ofApp::probeProximity() {
+	PROFILE_SCOPE("update/proximity");
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	nearestPoints.clear();
+	nearestDist = -1;
+	proximityPoints = 0;
+	legClearance = -1;
+	if (!bTiledTerrain && lander->getShipLoaded()) {
+		glm::vec3 pos = lander->getPosition();
+		Vector3 p(&pos.x);
+		Vector3View verts = octree.vertices();
+		if (octree.nearest(p, nearestCount, nearestPoints, sensorRange) > 0)
+			nearestDist = (verts[nearestPoints[0]] - p).length();
+		proximityPoints = octree.pointsInRadius(p, proximityRadius, proximityScratch);
+
+		Box bounds = lander->getLanderBounds();
+		const Vector3 & min = bounds.min();
+		const Vector3 & max = bounds.max();
+		for (int i = 0; i < 4; i++) {
+			Vector3 foot((i & 1) ? max.x() : min.x(), min.y(), (i & 2) ? max.z() : min.z());
+			int n = octree.nearest(foot, sensorRange);
+			if (n < 0) continue;
+			float d = (verts[n] - foot).length();
+			if (legClearance < 0 || d < legClearance) legClearance = d;
+		}
+	}
+	proximityTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+}
+
+// Carves a crater into the terrain where the lander crashed.  Only the
+// octree nodes, height field cells and vertices under the crater are
+// updated
+//
+void ofApp::carveCrater(const glm::vec3 & p) {
+	if (bTiledTerrain) return;
+	PROFILE_SCOPE("terrain/crater");
+	uint64_t startTime = ofGetElapsedTimeMicros();
+
+	// the compiled terrain is in world space, like the lander
+	vector<int> moved;
+	Box region;
+	if (octree.carve(Vector3(&p.x), craterRadius, craterDepth, moved, region) == 0) return;
+
+	const Vector3 & min = region.min();
+	const Vector3 & max = region.max();
+	heightField.update(octree.mesh, min.x(), min.z(), max.x(), max.z());
+
+	// moved vertices take the ground's new normal
+	int first = moved[0], last = moved[0];
+	bool normals = octree.mesh.getNumNormals() == octree.mesh.getNumVertices();
+	for (int i = 0; i < moved.size(); i++) {
+		first = MIN(first, moved[i]);
+		last = MAX(last, moved[i]);
+		if (normals) {
+			const glm::vec3 & v = octree.mesh.getVertex(moved[i]);
+			octree.mesh.setNormal(moved[i], heightField.getNormal(v.x, v.z));
+		}
+	}
+	terrainChunks.update(octree.mesh, region, first, last, craterDepth);
+	landingMap.update(octree, region);
+
+	craterTime = (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+	cout << "crater: " << moved.size() << " vertices moved, " << last - first + 1 << " uploaded, " << craterTime << "ms" << endl;
+}
+
+// Draws every particle system as point sprites
+// Each system packs its particles (color faded by age) into its own
+// streaming vbo and draws them in a single call
+//
+void ofApp::drawParticles() {
+	PROFILE_SCOPE("draw/particles");
+	glDepthMask(GL_FALSE);
+	ofSetColor(ofColor::white);
+	// makes everything look glowy
+	ofEnableBlendMode(OF_BLENDMODE_ADD);
+	ofEnablePointSprites();
+	// begin shader
+	shader.begin();
+	particleTex.bind();
+	// draw exhaust and explosion particle systems
+	emitter.sys->draw();
+	explosion.sys->draw();
+	particleDrawCalls += emitter.sys->drawCalls + explosion.sys->drawCalls;
+	particleTex.unbind();
+	// end drawing
+	shader.end();
+	ofDisablePointSprites();
+	ofDisableBlendMode();
+	glDepthMask(GL_TRUE);
+}
+
+// Builds one viewport's terrain draw list: the chunks inside its
+// camera's view frustum, each at the coarsest level of detail that stays
+// under terrainPixelError for that camera and viewport.  Every viewport
+// goes through the same chunk tree; only the lists are its own
+//
+void ofApp::cullTerrain(ofCamera *camera, const ofRectangle & viewport, TerrainView & viewRtn) {
+	if (bTiledTerrain) return;		// tiles are drawn whole
+	PROFILE_SCOPE("draw/cull");
+	uint64_t startTime = ofGetElapsedTimeMicros();
+	Frustum frustum(camera->getModelViewProjectionMatrix(viewport));
+	matrixTime += (ofGetElapsedTimeMicros() - startTime) / 1000.0;
+	viewRtn.triangles = terrainChunks.cull(frustum, viewRtn.chunks);
+	viewRtn.lodTriangles = terrainChunks.selectLods(viewRtn.chunks, camera->getGlobalPosition(),
+		pixelsPerUnit(camera, viewport.height), terrainPixelError, viewRtn.lods);
+}
+
+// Draws a viewport's terrain chunks, picked by cullTerrain()
+//
+void ofApp::drawTerrain(const TerrainView & view) {
+	PROFILE_SCOPE("draw/terrain");
+	if (bTiledTerrain) {
+		tiles.draw();
+		return;
+	}
+	terrainChunks.draw(view.chunks, view.lods);
+}
+
+// Screen pixels covered by one world unit at distance one from the camera,
+// in a viewport viewportHeight pixels high
+//
+float ofApp::pixelsPerUnit(ofCamera *camera, float viewportHeight) {
+	return viewportHeight / (2 * tan(ofDegToRad(camera->getFov()) / 2));
+}
+
+// Prints visible terrain chunks and triangles for every camera,
+// at full resolution and at the selected levels of detail
+//
+void ofApp::reportTerrainCulling() {
+	if (bTiledTerrain) return;
+	string names[CameraRig::NumViews] = { "default", "top", "follow", "front", "ground" };
+	TerrainView view;
+	for (int i = 0; i < CameraRig::NumViews; i++) {
+		cullTerrain(rig.get((CameraRig::View)i), ofGetCurrentViewport(), view);
+		cout << names[i] << " cam: " << view.chunks.size() << "/" << terrainChunks.chunks.size() << " chunks, "
+			<< view.triangles << "/" << terrainChunks.numTriangles << " triangles, " << view.lodTriangles << " at LOD" << endl;
+	}
+}
+
+// Starts the geometry and spatial query benchmarks against the terrain
+// and synthetic meshes on benchThread; the game keeps running and
+// update() saves the results when they're in
+//
+void ofApp::runBenchmarks() {
+	if (bTiledTerrain) return;
+	if (benchThread.start(octree.mesh))
+		cout << "benchmarks running" << endl;
+	else
+		cout << "benchmarks already running" << endl;
+}
+
+// Prints the finished benchmarks and, for the full suite, writes them
+// to data/bench for comparing against other commits
+//
+void ofApp::saveBenchmarks() {
+	Benchmarks & bench = benchThread.bench;
+	bench.print();
+	if (benchThread.suite != BenchmarkThread::All) return;
+	string path = "bench/bench_" + ofGetTimestampString() + ".json";
+	ofDirectory::createDirectory("bench", true, true);
+	if (bench.save(path))
+		cout << "benchmarks written to " << path << endl;
+}
+
+// Starts timing the Box primitives the octree is built and searched
+// with on benchThread: box overlap, ray-box and point-in-box (over the
+// terrain's vertex array, as getMeshPointsInBox does).  A quick check
+// on this machine; the full suite is runBenchmarks() and the headless
+// one lander_bench
+//
+void ofApp::benchmarkMathPrimitives() {
+	if (bTiledTerrain || octree.mesh.getNumVertices() == 0) return;
+	if (benchThread.start(octree.mesh, BenchmarkThread::Primitives))
+		cout << "primitive benchmarks running" << endl;
+	else
+		cout << "benchmarks already running" << endl;
+}
+
+// Starts timing random ground height queries through the height field
+// and through a downward octree ray on benchThread
+//
+void ofApp::benchmarkGroundQueries() {
+	if (bTiledTerrain || octree.mesh.getNumVertices() == 0) return;
+	if (benchThread.start(octree.mesh, BenchmarkThread::GroundQueries))
+		cout << "ground query benchmarks running" << endl;
+	else
+		cout << "benchmarks already running" << endl;
+}
+
+// Starts flying a scripted path across a synthetic 16x16 tile map
+// (written to geo/synthetic the first time), streaming the tiles in
+// with a small memory budget.  stepTileBenchmark() advances it one
+// frame at a time from update() so the loader runs at the real pace
+//
+void ofApp::startTileBenchmark() {
+	if (tileBench != NULL) return;
+	string dir = "geo/synthetic";
+	if (!ofFile::doesFileExist(dir + "/index.json")) {
+		cout << "tiles: writing synthetic map to " << dir << endl;
+		TerrainTiles::generate(dir, 16, 16, 100, 64);
+	}
+	tileBench = new TerrainTiles();
+	if (!tileBench->load(dir)) {
+		delete tileBench;
+		tileBench = NULL;
+		return;
+	}
+	tileBench->memoryBudget = 32 * 1024 * 1024;
+	tileBenchFrame = 0;
+	tileBenchStalls = 0;
+	tileBenchStallTime = 0;
+	tileBenchLongestStall = 0;
+	tileBenchStallRun = 0;
+}
+
+// One frame of the tile benchmark: a diagonal across the map and a
+// lap around its edge at 200 units a second.  A frame where the tile
+// under the path isn't resident yet is a stall
+//
+void ofApp::stepTileBenchmark() {
+	TerrainTiles & bench = *tileBench;
+	float half = bench.tilesX * bench.tileSize / 2 - 10;
+	const int legs = 5;
+	ofVec2f path[legs + 1] = { ofVec2f(-half, -half), ofVec2f(half, half), ofVec2f(half, -half),
+		ofVec2f(-half, -half), ofVec2f(-half, half), ofVec2f(half, half) };
+	float speed = 200;
+
+	// where along the path this frame is
+	//
+	float dist = tileBenchFrame * speed / 60;
+	int leg = 0;
+	while (leg < legs && dist > path[leg].distance(path[leg + 1])) {
+		dist -= path[leg].distance(path[leg + 1]);
+		leg++;
+	}
+	if (leg == legs) {
+		cout << "tile benchmark: " << tileBenchFrame << " frames, " << bench.loads << " loads, " << bench.evictions << " evictions" << endl;
+		cout << "  stalls: " << tileBenchStalls << " frames, " << tileBenchStallTime << " ms total, longest " << tileBenchLongestStall << " ms" << endl;
+		cout << "  peak resident tiles: " << bench.peakBytes / (1024 * 1024) << " MB (budget " << bench.memoryBudget / (1024 * 1024) <<
+			" MB), peak RSS: " << peakRss() / (1024 * 1024) << " MB" << endl;
+		delete tileBench;
+		tileBench = NULL;
+		return;
+	}
+	ofVec2f p = path[leg] + (path[leg + 1] - path[leg]).getNormalized() * dist;
+
+	bench.update(glm::vec3(p.x, 0, p.y));
+	float h;
+	ofVec3f n;
+	float frameTime = ofGetLastFrameTime() * 1000;
+	if (bench.getGround(p.x, p.y, h, n)) {
+		tileBenchStallRun = 0;
+	}
+	else {
+		tileBenchStalls++;
+		tileBenchStallTime += frameTime;
+		tileBenchStallRun += frameTime;
+		tileBenchLongestStall = MAX(tileBenchLongestStall, tileBenchStallRun);
+	}
+	tileBenchFrame++;
+}
 
-	theCam->begin();
+// Draws the 3D scene through whichever camera has begun, with the
+// terrain culled for that camera's viewport
+//
+void ofApp::drawScene(const TerrainView & terrain) {
 	ofPushMatrix();
 
 	// Draw all the lights 
@@ -308,7 +777,9 @@ void ofApp::draw() {
 	if (bWireframe) {	// wireframe mode  (include axis)
 		ofDisableLighting();
 		ofSetColor(ofColor::slateGray);
-		terrain.drawWireframe();
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		drawTerrain(terrain);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 		if (lander->getShipLoaded()) {
 			lander->getShipModel().drawWireframe();
 			if (!bTerrainSelected) drawAxis(lander->getPosition());
@@ -317,20 +788,22 @@ void ofApp::draw() {
 	}
 	else {
 		ofEnableLighting();		// shaded mode
-		terrain.drawFaces();
+		terrainMaterial.begin();
+		drawTerrain(terrain);
+		terrainMaterial.end();
 		ofMesh mesh;
 		if (lander->getShipLoaded()) {
 			lander->getShipModel().drawFaces();
 			if (!bTerrainSelected) drawAxis(lander->getPosition());
-			if (bDisplayBBoxes) {
+			if (bDisplayBBoxes) {	// bounds of each submesh, in model space
 				ofNoFill();
 				ofSetColor(ofColor::white);
-				for (int i = 0; i < lander->getShipModel().getNumMeshes(); i++) {
-					ofPushMatrix();
-					ofMultMatrix(lander->getShipModel().getModelMatrix());
-					ofRotate(-90, 1, 0, 0);
+				ofPushMatrix();
+				ofMultMatrix(lander->getShipModel().getModelMatrix());
+				for (int i = 0; i < bboxList.size(); i++) {
 					Octree::drawBox(bboxList[i]);
 				}
+				ofPopMatrix();
 			}
 
 			if (lander->getShipSelected()) {
@@ -355,7 +828,7 @@ void ofApp::draw() {
 		if (bDisplayPoints) {                // display points as an option    
 			glPointSize(3);
 			ofSetColor(ofColor::green);
-			terrain.drawVertices();
+			octree.mesh.drawVertices();
 		}
 
 		// highlight selected point (draw sphere around selected point)
@@ -379,54 +852,98 @@ void ofApp::draw() {
 		else if (bDisplayOctree) {
 			ofNoFill();
 			ofSetColor(ofColor::white);
-			octree.draw(octree.root, numLevels, 0);
+			octree.draw(numLevels, 0);
 		}
 
-		// if point selected, draw a sphere
+		// nearest terrain points to the lander, from the proximity
+		// sensor; the line turns red inside proximityRadius
 		//
-		if (pointSelected && showNearest) {
-			ofVec3f p = octree.mesh.getVertex(selectedNode.points[0]);
+		if (showNearest && !nearestPoints.empty()) {
+			ofVec3f p = octree.mesh.getVertex(nearestPoints[0]);
 			ofVec3f d = p - cam.getPosition();
 			ofSetColor(ofColor::lightGreen);
 			ofDrawSphere(p, .02 * d.length());
+			for (int i = 1; i < nearestPoints.size(); i++)
+				ofDrawSphere(octree.mesh.getVertex(nearestPoints[i]), .01 * d.length());
 
-			if (showNearest)
-				ofSetColor(ofColor::green);
+			ofSetColor(proximityPoints > 0 ? ofColor::red : ofColor::green);
 			ofDrawLine(lander->getPosition(), p);
+		}
 
-
+		// ground under the lander, from the altitude probe
+		//
+		if (showNearest && bGroundPoint) {
+			ofSetColor(ofColor::green);
+			ofDrawLine(lander->getPosition(), groundPoint);
 		}
 
 	}
 
-	// Draws Emitter for exhaust
-	//emitter.draw();
-	loadVbo();
-	glDepthMask(GL_FALSE);
-	ofSetColor(ofColor::red);
-	// makes everything look glowy
-	ofEnableBlendMode(OF_BLENDMODE_ADD);
-	ofEnablePointSprites();
-	// begin shader
-	shader.begin();
-	// draw exhaust particle emitter
-	particleTex.bind();
-	vbo.draw(GL_POINTS, 0, (int)emitter.sys->particles.size());
-	particleTex.unbind();
-	// end drawing
-	shader.end();
-	ofDisablePointSprites();
-	ofDisableBlendMode();
-	glDepthMask(GL_TRUE);
+	// Highlights the terrain safe to land on
+	if (bShowLandingMap) {
+		ofEnableAlphaBlending();
+		landingMap.draw(safeScore);
+	}
 
-	// Draws Emitter for explosion
-	explosion.draw();
+	// Draws exhaust and explosion particles
+	drawParticles();
 
 
 	ofPopMatrix();
-	theCam->end();
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+	if (firstFrameTime < 0)
+		firstFrameTime = ofGetElapsedTimeMillis();
+	if (!loader.isDone()) {
+		drawLoading();
+		return;
+	}
+	PROFILE_SCOPE("draw");
+
+	glDepthMask(false);
+	// Sets default color
+	ofSetColor(255, 255, 255);
+	// Draws background image
+	background.draw(0, 0);
+	// Draws gui
+	if (!bHide) gui.draw();
+	glDepthMask(true);
+
+	// Places the cameras drawn this frame; each viewport culls the
+	// terrain and picks its levels of detail for its own camera
+	rig.resetStats();
+	matrixTime = 0;
+	particleDrawCalls = 0;
+	theCam = rig.get(activeView);
+
+	{
+		PROFILE_SCOPE("draw/scene");
+		cullTerrain(theCam, ofGetCurrentViewport(), mainTerrain);
+		theCam->begin();
+		drawScene(mainTerrain);
+		theCam->end();
+	}
+
+	// Draws picture-in-picture view in the lower left corner
+	if (bShowPip) {
+		PROFILE_SCOPE("draw/pip");
+		ofCamera *pipCam = rig.get(activeView == CameraRig::Ground ? CameraRig::Top : CameraRig::Ground);
+		ofRectangle pipRect(10, ofGetWindowHeight() * 3 / 4 - 10, ofGetWindowWidth() / 4, ofGetWindowHeight() / 4);
+		cullTerrain(pipCam, pipRect, pipTerrain);
+		ofDisableLighting();
+		ofNoFill();
+		ofSetColor(ofColor::white);
+		ofDrawRectangle(pipRect);
+		ofFill();
+		pipCam->begin(pipRect);
+		drawScene(pipTerrain);
+		pipCam->end();
+	}
 
 	// Set text color to white
+	PROFILE_SCOPE("draw/hud");
 	ofSetColor(ofColor::green);
 
 	if (gameOver) {	// Messages for game over conditions
@@ -439,6 +956,8 @@ void ofApp::draw() {
 		}
 		else if (inBounds) {
 			goText = "You landed!";
+			if (touchdownScore >= 0)
+				goText += " Site score: " + std::to_string((int)(touchdownScore * 100)) + "%";
 			text.drawString(goText, ofGetWindowWidth() / 2 - text.stringWidth(goText) / 2, ofGetWindowHeight() / 2 - 20);
 			goText2 = "Push R to try again";
 			text.drawString(goText2, ofGetWindowWidth() / 2 - text.stringWidth(goText2) / 2, ofGetWindowHeight() / 2 + 20);
@@ -474,6 +993,77 @@ void ofApp::draw() {
 	string altitudeText;
 	altitudeText += "Altitude: " + std::to_string(altitude);
 	text.drawString(altitudeText, ofGetWindowWidth() - 190, 75);
+	// Displays per-frame particle collision cost on screen
+	string collisionText;
+	collisionText += "Particle Collision: " + std::to_string(emitter.sys->collisionTime + explosion.sys->collisionTime) + "ms";
+	text.drawString(collisionText, ofGetWindowWidth() - 300, 100);
+	// Displays per-frame particle upload cost on screen
+	string uploadText;
+	uploadText += "Particle Upload: " + std::to_string(emitter.sys->stream.bytesCopied + explosion.sys->stream.bytesCopied) + " bytes, " +
+		std::to_string(emitter.sys->stream.allocations + explosion.sys->stream.allocations) + " allocs";
+	text.drawString(uploadText, ofGetWindowWidth() - 300, 125);
+	// Displays particle draw calls on screen
+	string drawCallText;
+	drawCallText += "Particle Draw Calls: " + std::to_string(particleDrawCalls);
+	text.drawString(drawCallText, ofGetWindowWidth() - 300, 150);
+	// Displays terrain chunks and triangles visible from the current camera
+	string terrainText;
+	if (bTiledTerrain)
+		terrainText += "Terrain: " + std::to_string(tiles.numResident) + "/" + std::to_string(tiles.tiles.size()) +
+			" tiles, " + std::to_string(tiles.residentBytes / (1024 * 1024)) + " MB";
+	else
+		terrainText += "Terrain: " + std::to_string(mainTerrain.chunks.size()) + "/" + std::to_string(terrainChunks.chunks.size()) +
+			" chunks, " + std::to_string(mainTerrain.lodTriangles) + "/" + std::to_string(mainTerrain.triangles) + " tris";
+	text.drawString(terrainText, ofGetWindowWidth() - 300, 175);
+	// Displays time spent placing cameras, building matrices and probing altitude
+	string cameraText;
+	cameraText += "Camera: " + std::to_string(rig.cameraTime + matrixTime) + "ms, Probe: " + std::to_string(probeTime) + "ms";
+	text.drawString(cameraText, ofGetWindowWidth() - 300, 200);
+	// Displays slope of the ground under the lander
+	string slopeText;
+	slopeText += "Ground Slope: " + std::to_string(groundSlope) + " deg";
+	text.drawString(slopeText, ofGetWindowWidth() - 300, 225);
+	// Displays lander draw calls against its number of meshes
+	if (lander->getShipModel().merged) {
+		string landerText;
+		landerText += "Lander Draw Calls: " + std::to_string(lander->getShipModel().merged->drawCalls) + " (" +
+			std::to_string(lander->getShipModel().merged->numMeshes) + " meshes)";
+		text.drawString(landerText, ofGetWindowWidth() - 300, 250);
+	}
+	// Displays distance to the nearest terrain and under the landing legs
+	string nearestText;
+	nearestText += "Nearest Terrain: " + (nearestDist < 0 ? string("-") : std::to_string(nearestDist)) +
+		", Legs: " + (legClearance < 0 ? string("-") : std::to_string(legClearance)) +
+		" (" + std::to_string(proximityTime) + "ms)";
+	text.drawString(nearestText, ofGetWindowWidth() - 300, 275);
+	// Displays landing map score of the terrain under the lander
+	if (landingMap.isCreated()) {
+		string siteText;
+		siteText += "Landing Site: " + std::to_string((int)(landingMap.getScore(lander->getPosition().x, lander->getPosition().z) * 100)) + "%";
+		text.drawString(siteText, ofGetWindowWidth() - 300, 300);
+	}
+	// Displays records written by the flight recorder and what recording costs a step
+	if (telemetry.isOpen()) {
+		string telemetryText;
+		telemetryText += "Telemetry: " + std::to_string(telemetry.written.load()) + " recs, " + std::to_string(telemetry.bytesWritten.load() / 1024) +
+			" KB, " + std::to_string((int)telemetry.lastCost) + "ns (max " + std::to_string((int)telemetry.maxCost) + ")";
+		text.drawString(telemetryText, ofGetWindowWidth() - 300, 325);
+	}
+	// Warns when terrain is close, or a leg is about to touch down
+	if (!gameOver && !standBy) {
+		string warningText;
+		if (legClearance >= 0 && legClearance < minLegClearance)
+			warningText = "LEG CLEARANCE";
+		else if (proximityPoints > 0)
+			warningText = "TERRAIN PROXIMITY";
+		if (!warningText.empty()) {
+			ofSetColor(ofColor::red);
+			text.drawString(warningText, ofGetWindowWidth() / 2 - text.stringWidth(warningText) / 2, 100);
+			ofSetColor(ofColor::white);
+		}
+	}
+	// Displays profiler sections if turned on
+	Profiler::get().draw(ofGetWindowWidth() / 2 - 260, 20);
 }
 
 // Draw an XYZ axis in RGB at world (0,0,0) for reference.
@@ -505,9 +1095,40 @@ void ofApp::drawAxis(ofVec3f location) {
 void ofApp::keyPressed(int key) {
 
 	keymap[key] = true;
+	if (!loader.isDone()) return;
+	if (key == 'H' || key == 'h') {	// Prints ground query speed, height field vs octree
+		benchmarkGroundQueries();
+	}
+	if (key == 'N' || key == 'n') {	// Runs the geometry benchmarks, results go in data/bench
+		runBenchmarks();
+	}
+	if (key == 'I' || key == 'i') {	// Prints the speed of the box, ray and overlap tests
+		benchmarkMathPrimitives();
+	}
+	if (key == 'M' || key == 'm') {	// Flies a scripted path over a synthetic tiled map
+		startTileBenchmark();
+	}
+	if (key == 'X' || key == 'x') {	// Toggles the landing map highlight
+		bShowLandingMap = !bShowLandingMap;
+	}
+	if (key == 'U' || key == 'u') {	// Toggles the profiler overlay
+		Profiler::get().bShow = !Profiler::get().bShow;
+	}
+	if (key == 'Y' || key == 'y') {	// Writes the profiler's samples as CSV and as a Chrome trace
+		if (Profiler::get().exportCsv("profile.csv") && Profiler::get().exportTrace("profile.json"))
+			cout << "profile written to profile.csv and profile.json" << endl;
+		else
+			cout << "can't write profile" << endl;
+	}
 	if (keymap['J'] | keymap['j']) {	// Toggles display of gui
 		bHide = !bHide;
 	}
+	if (key == 'G' || key == 'g') {	// Toggles picture-in-picture view
+		bShowPip = !bShowPip;
+	}
+	if (key == 'K' || key == 'k') {	// Prints terrain culling stats per camera
+		reportTerrainCulling();
+	}
 	if (keymap['L'] | keymap['l']) {	// Toggles display of lights
 		hideLights = !hideLights;
 	}
@@ -531,12 +1152,12 @@ void ofApp::keyPressed(int key) {
 	}
 	if (keymap['R'] | keymap['r']) {	// Resets lander and game logic fields
 		if (gameOver) {
+			uint64_t resetStart = ofGetElapsedTimeMicros();
 			exploded = false;
 			gameOver = false;
 			inBounds = false;
 			showNearest = false;
-			lander->shipModel.loadModel("geo/lander.obj");
-			lander->shipModel.setScaleNormalization(false);
+			lander->shipModel.visible = true;	// shows it again if it exploded
 			lander->thrust = 25.0;
 			lander->acceleration = glm::vec3(0, 0, 0);
 			lander->turnVelocity = 0;
@@ -547,6 +1168,10 @@ void ofApp::keyPressed(int key) {
 			lander->fuel = 200;
 			lander->landed = false;
 			lander->shipSelected = false;
+			touchdownScore = -1;
+			flight++;
+			resetTime = (ofGetElapsedTimeMicros() - resetStart) / 1000.0;
+			cout << "reset: " << resetTime << "ms (" << models.loads << " model loads, " << models.hits << " cache hits)" << endl;
 		}
 	}
 	if (keymap['P'] | keymap['p']) {
@@ -565,19 +1190,19 @@ void ofApp::keyPressed(int key) {
 		bCtrlKeyDown = true;
 	}
 	if (keymap[OF_KEY_F1]) {	// switches to default easyCam
-		theCam = &cam;
+		activeView = CameraRig::Default;
 	}
 	if (keymap[OF_KEY_F2]) {	// switches camera to top cam
-		theCam = &top;
+		activeView = CameraRig::Top;
 	}
 	if (keymap[OF_KEY_F3]) {	// switches camera to following cam
-		theCam = &follow;
+		activeView = CameraRig::Follow;
 	}
 	if (keymap[OF_KEY_F4]) {	// switches camera to front cam
-		theCam = &front;
+		activeView = CameraRig::Front;
 	}
 	if (keymap[OF_KEY_F5]) {	// switches camera to ground cam
-		theCam = &ground;
+		activeView = CameraRig::Ground;
 	}
 	if (keymap[' ']) {					// Move forward relative to Y-Axis
 		// Only move if lander has fuel and lander has not exploded
@@ -624,6 +1249,7 @@ void ofApp::keyPressed(int key) {
 
 void ofApp::keyReleased(int key) {
 	keymap[key] = false;
+	if (!loader.isDone()) return;
 	if (!keymap[OF_KEY_CONTROL]) {
 		bCtrlKeyDown = false;
 	}
@@ -680,6 +1306,7 @@ void ofApp::mouseMoved(int x, int y) {
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button) {
+	if (!loader.isDone()) return;
 
 	// if moving camera, don't allow mouse interaction
 	//
@@ -725,39 +1352,42 @@ bool ofApp::raySelectWithOctree(ofVec3f & pointRet)
 	Ray ray = Ray(Vector3(rayPoint.x, rayPoint.y, rayPoint.z),
 		Vector3(rayDir.x, rayDir.y, rayDir.z));
 
-	pointSelected = octree.intersect(ray, octree.root, selectedNode);
+	PROFILE_SCOPE("octree/ray");
+	if (bTiledTerrain) {
+		// tiles have a mesh each, there's no one mesh to index into
+		selectedIndex = -1;
+		pointSelected = tiles.intersect(ray, pointRet);
+		return pointSelected;
+	}
+	pointSelected = octree.intersect(ray, selectedIndex);
 
 	//printf("In Box: %d \n", pointSelected);
 
 	if (pointSelected) {
-		pointRet = octree.mesh.getVertex(selectedNode.points[0]);
+		pointRet = octree.mesh.getVertex(selectedIndex);
 	}
 	return pointSelected;
 }
 
 
-// Shoots ray from top cam of lander to the moon terrain
+// Shoots ray straight down from the lander to the moon terrain
 // Uses octree to find the nearest valid point on terrain
-// from top cam of lander
+// below the lander
 // --Jared Bechthold
 bool ofApp::raySelectLine(ofVec3f & pointRet)
 {
-	ofVec3f landerScreenPos(ofGetWindowWidth() / 2, ofGetWindowHeight() / 2);
-	ofVec3f rayPoint = top.screenToWorld(landerScreenPos);
-	ofVec3f rayDir = rayPoint - top.getPosition();
-	rayDir.normalize();
-	Ray ray = Ray(Vector3(rayPoint.x, rayPoint.y, rayPoint.z),
-		Vector3(rayDir.x, rayDir.y, rayDir.z));
+	// the top cam looks straight down from the lander, so the probe
+	// is just a vertical ray from the lander's position
+	glm::vec3 landerPos = lander->getPosition();
+	Ray ray = Ray(Vector3(landerPos.x, landerPos.y, landerPos.z), Vector3(0, -1, 0));
 
-	pointSelected = octree.intersect(ray, octree.root, selectedNode);
+	PROFILE_SCOPE("octree/ray");
+	pointSelected = octree.intersect(ray, selectedIndex);
 
 	//printf("In Box: %d \n", pointSelected);
 
-	if (pointSelected) {
-		pointRet = octree.mesh.getVertex(selectedNode.points[0]);
-		ofSetColor(ofColor::green);
-		ofDrawLine(lander->getPosition(), pointRet);
-	}
+	if (pointSelected)
+		pointRet = octree.mesh.getVertex(selectedIndex);
 	return pointSelected;
 }
 
@@ -779,27 +1409,12 @@ void ofApp::drawBox(const Box &box) {
 // return a Mesh Bounding Box for the entire Mesh
 //
 Box ofApp::meshBounds(const ofMesh & mesh) {
-	int n = mesh.getNumVertices();
-	ofVec3f v = mesh.getVertex(0);
-	ofVec3f max = v;
-	ofVec3f min = v;
-	for (int i = 1; i < n; i++) {
-		ofVec3f v = mesh.getVertex(i);
-
-		if (v.x > max.x) max.x = v.x;
-		else if (v.x < min.x) min.x = v.x;
-
-		if (v.y > max.y) max.y = v.y;
-		else if (v.y < min.y) min.y = v.y;
-
-		if (v.z > max.z) max.z = v.z;
-		else if (v.z < min.z) min.z = v.z;
-	}
-	return Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
+	return Box::bounds(Vector3View(mesh.getVertices()));
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseDragged(int x, int y, int button) {
+	if (!loader.isDone()) return;
 	// if moving camera, don't allow mouse interaction
 	//
 	if (cam.getMouseInputEnabled()) return;
@@ -821,7 +1436,11 @@ void ofApp::mouseDragged(int x, int y, int button) {
 		Box bounds = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
 
 		colBoxList.clear();
-		octree.intersect(lander->shipBBox, octree.root, colBoxList);
+		PROFILE_SCOPE("octree/box");
+		if (bTiledTerrain)
+			tiles.intersect(lander->shipBBox, colBoxList);
+		else
+			octree.intersect(lander->shipBBox, colBoxList);
 
 		//printf("Intersects? %d\n", octree.intersect(lander->shipBBox, octree.root, colBoxList));
 		//printf("boxes: %d \n", colBoxList.size());
@@ -839,10 +1458,7 @@ void ofApp::mouseDragged(int x, int y, int button) {
 	}
 	else {
 		ofVec3f p;
-		float startTime = ofGetElapsedTimeMillis();
-		raySelectWithOctree(p);
-		float raySelectTime = ofGetElapsedTimeMillis() - startTime;
-		printf("Time to search tree with ray intersection: %fms\n", raySelectTime);
+		raySelectWithOctree(p);		// timed as octree/ray
 	}
 }
 
@@ -971,8 +1587,22 @@ glm::vec3 ofApp::getMousePointOnPlane(glm::vec3 planePt, glm::vec3 planeNorm) {
 void ofApp::checkCollisions()
 {
 	// Checks if lander collides with ground and is falling
+	// the height field gives the highest the ground can be under the
+	// lander, which only rules contact out: anything lower is clear, and
+	// the octree decides the rest (and fills colBoxList for the overlay)
 	colBoxList.clear();
-	if (octree.intersect(lander->shipBBox, octree.root, colBoxList) && lander->velocity.y < 0) {
+	bool contact;
+	float groundTop;
+	if (bTiledTerrain)
+		contact = tiles.intersect(lander->shipBBox, colBoxList);
+	else if (heightField.maxHeightIn(lander->shipBBox, groundTop) &&
+		lander->shipBBox.parameters[0].y() > groundTop)
+		contact = false;
+	else {
+		PROFILE_SCOPE("octree/box");
+		contact = octree.intersect(lander->shipBBox, colBoxList);
+	}
+	if (contact && lander->velocity.y < 0) {
 		ofVec3f norm = ofVec3f(0, 1, 0);
 		ofVec3f vel = lander->velocity;
 
@@ -984,151 +1614,20 @@ void ofApp::checkCollisions()
 			if (gameOver == false) {
 				lander->thrust = 0;
 				lander->landed = true;
+				touchdownScore = landingMap.scoreArea(lander->shipBBox);
 			}
 		}
 		// Checks if lander's impulse force is above specific value
 		else if (lander->impulseForce.y > 800) {
 			// Triggers explosion
 			if (!explosion.started) {
-				lander->shipModel.clear();
+				lander->shipModel.visible = false;	// hidden, the model stays cached
 				boom.play();
 				explosion.start();
 				exploded = true;
+				if (bCraters)
+					carveCrater(lander->getPosition());
 			}
 		}
 	}
 }
-
-// Constructor for Ship instance
-// --Jared Bechthold
-//----------------------------------------------------
-Ship::Ship(string src)
-{
-	// loads ship model from given source
-	if (shipModel.loadModel(src))
-		shipLoaded = true;
-	shipModel.setScaleNormalization(false);
-
-	// sets up bounding box of ship
-	ofVec3f min = getShipModel().getSceneMin() + getPosition();
-	ofVec3f max = getShipModel().getSceneMax() + getPosition();
-	shipBBox = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
-}
-
-// Applies forces to Ship instance and changes position appropriately
-// This gives the Ship instance physics movement
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::integrate()
-{
-	// update position from velocity and time
-	this->setPosition(this->getPosition() + this->velocity * 1.0 / 60.0);
-	// adds forces
-	addForces();
-	ofVec3f accel = acceleration + forces;
-	//printf("%f, %f, %f\n", forces.x, forces.y, forces.z);
-	// update velocity (from acceleration)
-	this->velocity = this->velocity + accel * (1.0 / 60.0);
-	// multiply velocity by damping factor
-	this->velocity = this->velocity * this->damping;
-	//printf("%f, %f, %f\n", velocity.x, velocity.y, velocity.z);
-	impulseForce.set(0, 0, 0);
-	forces.set(0, 0, 0);
-}
-
-// Applies thrust force to Ship instances rotation
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::integrateTurn()
-{
-	// update rotation from velocity and time
-	this->rotation = this->rotation + this->turnVelocity * 1.0 / 60.0;
-	this->setRotation();
-	// update velocity (from acceleration)
-	this->turnVelocity = this->turnVelocity + this->turnAcceleration * (1.0 / 60.0);
-	// multiply velocity by damping factor
-	this->turnVelocity = this->turnVelocity * this->damping;
-}
-
-// Sets position of Ship model and stores in Ship position field
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::setPosition(glm::vec3 newPos)
-{
-	if (getShipLoaded()) {
-		position = newPos;
-		shipModel.setPosition(newPos.x, newPos.y, newPos.z);
-	}
-}
-
-// Sets rotation angle of Ship model to current value of rotation variable
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::setRotation()
-{
-	if (getShipLoaded())
-		shipModel.setRotation(0, this->rotation, 0.0, 1.0, 0.0);
-}
-
-// Returns boolean value if ship is selected
-// --Jared Bechthold
-//----------------------------------------------------
-bool Ship::getShipSelected()
-{
-	return shipSelected;
-}
-
-// Returns boolean value if ship is loaded
-// --Jared Bechthold
-//----------------------------------------------------
-bool Ship::getShipLoaded()
-{
-	return shipLoaded;
-}
-
-// Returns the ship model's bounding box
-// --Jared Bechthold
-//----------------------------------------------------
-Box Ship::getLanderBounds()
-{
-	if (getShipLoaded())
-		return shipBBox;
-}
-
-// Returns the ship's model
-// --Jared Bechthold
-//----------------------------------------------------
-ofxAssimpModelLoader Ship::getShipModel()
-{
-	if (getShipLoaded())
-		return shipModel;
-}
-
-// Returns the ship's current position
-// --Jared Bechthold
-//----------------------------------------------------
-glm::vec3 Ship::getPosition()
-{
-	return position;
-}
-
-// Adds all of the force vectors to the forces vector
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::addForces()
-{
-	forces = gravity + appliedThrust + impulseForce;
-}
-
-// Updates the position of the ship model's bounding box
-// --Jared Bechthold
-//----------------------------------------------------
-void Ship::updateBoundingBox()
-{
-	if (getShipLoaded()) {
-		ofVec3f min = getShipModel().getSceneMin() + getPosition();
-		ofVec3f max = getShipModel().getSceneMax() + getPosition();
-
-		shipBBox = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
-	}
-}
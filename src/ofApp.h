@@ -7,51 +7,19 @@
 #include "Octree.h"
 #include "ofxGui.h"
 #include "ParticleEmitter.h"
-
-// Ship Class
-// Consolidates the fields and methods relevant to the
-// Ship Model. Used for updating positioning and physics
-// related movement of the Ship Model.
-// --Jared Bechthold
-//----------------------------------------------------
-class Ship {
-public:
-	// Ship Constructor
-	Ship(string src);
-
-	// Fields
-	ofxAssimpModelLoader shipModel;		// Holds the ship's model
-	Box shipBBox;						// Holds bounding box of ship
-	glm::vec3 position;					// Holds position of ship
-	glm::vec3 velocity;					// Holds ship's velocity
-	glm::vec3 acceleration;				// Holds ship's acceleration
-	float rotation = 0.0;				// Holds rotation of ship
-	float turnVelocity;					// Holds turn velocity of ship
-	float turnAcceleration;				// Holds turn acceleration of ship
-	bool shipSelected;					// Whether or not the ship is selected
-	bool shipLoaded = false;			// Whether or not the ship is loaded
-	float thrust;						// Holds the thrust force of ship
-	ofVec3f appliedThrust;				// Thurst force in 3D 
-	ofVec3f gravity;					// Gravity force in 3D
-	ofVec3f impulseForce;				// Impulse force in 3D
-	ofVec3f forces = ofVec3f(0, 0, 0);	// Combination of all forces
-	float damping;						// Decreases force values
-	bool landed = false;				// Whether or not the ship has landed
-	float fuel;
-
-	// Functions
-	void integrate();						// Movement of ship in direction
-	void integrateTurn();					// Turning of ship
-	void setPosition(glm::vec3 newPos);		// Set position of the ship
-	void setRotation();						// Set rotation of the ship
-	bool getShipSelected();					// Returns whether or not the ship is selected
-	bool getShipLoaded();					// Returns whether or not the ship is loaded
-	Box getLanderBounds();					// Gets boundaries of lander bounding box
-	ofxAssimpModelLoader getShipModel();	// Returns ship's model
-	glm::vec3 getPosition();				// Returns ship's position
-	void addForces();						// adds up all forces
-	void updateBoundingBox();
-};
+#include "HeightField.h"
+#include "LandingMap.h"
+#include "TerrainChunks.h"
+#include "TerrainTiles.h"
+#include "CameraRig.h"
+#include "EffectLibrary.h"
+#include "CompiledMesh.h"
+#include "ModelCache.h"
+#include "Ship.h"
+#include "AssetLoader.h"
+#include "Profiler.h"
+#include "Benchmarks.h"
+#include "Telemetry.h"
 
 class ofApp : public ofBaseApp {
 
@@ -59,6 +27,7 @@ public:
 	void setup();
 	void update();
 	void draw();
+	void exit();
 
 	void keyPressed(int key);
 	void keyReleased(int key);
@@ -78,12 +47,29 @@ public:
 	void toggleSelectTerrain();
 	void setCameraTarget();
 	void drawBox(const Box &box);
-	void loadVbo();
+	void drawParticles();
+	void probeAltitude();
+	void probeProximity();
+	void carveCrater(const glm::vec3 & p);
+	void cullTerrain(ofCamera *camera, const ofRectangle & viewport, TerrainView & viewRtn);
+	void drawTerrain(const TerrainView & view);
+	void drawScene(const TerrainView & terrain);
+	void reportTerrainCulling();
+	void benchmarkGroundQueries();
+	void benchmarkMathPrimitives();
+	void runBenchmarks();
+	void saveBenchmarks();
+	void recordTelemetry();
+	void startTileBenchmark();
+	void setupLander();
+	void drawLoading();
+	void stepTileBenchmark();
+	float pixelsPerUnit(ofCamera *camera, float viewportHeight);
 	Box meshBounds(const ofMesh &);
 	bool mouseIntersectPlane(ofVec3f planePoint, ofVec3f planeNorm, ofVec3f &point);
 	bool raySelectWithOctree(ofVec3f &pointRet);
 	bool raySelectLine(ofVec3f & pointRet);
-	glm::vec3 ofApp::getMousePointOnPlane(glm::vec3 p, glm::vec3 n);
+	glm::vec3 getMousePointOnPlane(glm::vec3 p, glm::vec3 n);
 
 
 	ofEasyCam cam;
@@ -92,10 +78,49 @@ public:
 	ofCamera front;
 	ofCamera ground;
 	ofCamera *theCam;
-	ofxAssimpModelLoader terrain;
+	CameraRig rig;						// places the cameras around the lander
+	CameraRig::View activeView = CameraRig::Default;
+	bool bShowPip = false;				// picture-in-picture view
+	float matrixTime = 0;				// ms building camera matrices this frame
+	float probeTime = 0;				// ms in the altitude probe this frame
+	ofVec3f groundPoint;				// ground under the lander, from the altitude probe
+	bool bGroundPoint = false;
+	float groundSlope = 0;				// degrees, under the lander
+
+	// terrain proximity sensor, from the octree's nearest point queries
+	//
+	vector<int> nearestPoints;			// terrain points nearest the lander, nearest first
+	int nearestCount = 8;
+	float nearestDist = -1;				// to the nearest terrain point, -1 if none in range
+	float sensorRange = 50;				// how far out nearest points are searched
+	float proximityRadius = 5;			// terrain closer than this sets off the warning
+	int proximityPoints = 0;			// terrain points within proximityRadius
+	vector<int> proximityScratch;
+	float legClearance = -1;			// nearest terrain to any landing leg, -1 if none in range
+	float minLegClearance = 0.5;		// legs closer than this are about to touch down
+	float proximityTime = 0;			// ms in the proximity sensor this frame
+	TerrainChunks terrainChunks;		// terrain split for frustum culling
+	TerrainView mainTerrain;			// terrain drawn in the main view
+	TerrainView pipTerrain;				// and in the picture-in-picture view
+	float terrainPixelError = 1.5;		// screen space error allowed for terrain LOD
+	TerrainTiles tiles;					// streamed terrain, if the map is tiled
+	bool bTiledTerrain = false;
+	BenchmarkThread benchThread;		// geometry benchmarks, run off the main thread
+	TerrainTiles *tileBench = NULL;		// tile streaming benchmark, while running
+	int tileBenchFrame = 0;
+	int tileBenchStalls = 0;			// frames the tile under the path wasn't resident
+	float tileBenchStallTime = 0;		// ms
+	float tileBenchLongestStall = 0;	// ms
+	float tileBenchStallRun = 0;		// ms, current run of stalled frames
+	ofMaterial terrainMaterial;
 	ofLight light;
 	Box boundingBox;
-	Ship *lander;
+	Ship *lander = NULL;
+	ModelCache models;					// models loaded once, shared by path
+	AssetLoader loader;					// loads assets while the loading screen draws
+	int loadThreads = 3;				// loader worker threads, 0 loads one at a time
+	float firstFrameTime = -1;			// ms from start to the first frame drawn
+	float resetTime = 0;				// ms for the last reset
 	bool bAltKeyDown;
 	bool bCtrlKeyDown;
 	bool bWireframe;
@@ -118,7 +143,26 @@ public:
 	// Octree Setup
 	vector<Box> colBoxList;
 	Octree octree;
-	TreeNode selectedNode;
+	HeightField heightField;
+	LandingMap landingMap;				// landing suitability of the terrain, per cell
+	int landingMapRes = 128;
+	bool bShowLandingMap = false;		// highlights the cells safe to land on
+	float safeScore = 0.5;				// cells scoring this or more are highlighted
+	float touchdownScore = -1;			// landing map score where the lander touched down
+
+	// flight recorder
+	//
+	Telemetry telemetry;
+	bool bTelemetry = true;				// record every step to data/telemetry
+	int flight = 0;						// counts up on each reset
+	ofVec3f contactImpulse;				// impulse from this step's ground contact
+	int selectedIndex = -1;				// mesh index of the point the last ray hit
+	bool bCompactOctree = true;			// query the compacted octree nodes
+	bool bMortonOctree = true;			// build the octree from Z-order keys
+	bool bCraters = true;				// crashes carve craters; the octree then isn't compacted
+	float craterRadius = 8;
+	float craterDepth = 3;
+	float craterTime = 0;				// ms for the last crater
 	bool bInDrag = false;
 	ofxIntSlider numLevels;
 	ofxPanel gui;
@@ -127,6 +171,7 @@ public:
 	// Particle Emitter Fields
 	ParticleEmitter emitter;
 	ParticleEmitter explosion;
+	EffectLibrary effects;
 
 	// Apply Impulse for hitting ground
 	void checkCollisions();
@@ -164,6 +209,6 @@ public:
 	ofTexture particleTex;
 	// shaders
 	//
-	ofVbo vbo;
 	ofShader shader;
+	int particleDrawCalls = 0;
 };
\ No newline at end of file
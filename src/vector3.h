@@ -2,79 +2,124 @@
 #define _VECTOR3_H_
 
 #include <math.h>
+#include <stddef.h>
+#include <vector>
+#include "float4.h"
 
 class Vector3 {
   public:
-    Vector3() { };
-    Vector3(float x, float y, float z) { d[0] = x; d[1] = y; d[2] = z; }
-    Vector3(const Vector3 &v)
-      { d[0] = v.d[0]; d[1] = v.d[1]; d[2] = v.d[2]; }
+    // 16 byte aligned, with a fourth lane that is always 0, so every
+    // operation is one SSE instruction (see float4.h).  That makes it a
+    // different layout from a mesh's packed vertices; read those through
+    // a Vector3View instead of casting
+    //
+    Vector3() = default;
+    constexpr Vector3(float x, float y, float z) : d{ x, y, z, 0 } { }
+    Vector3(const Vector3 &v) = default;
+    Vector3 & operator=(const Vector3 &v) = default;
 
-    float x() const { return d[0]; }
-    float y() const { return d[1]; }
-    float z() const { return d[2]; }
+    // a copy of the three packed floats at p, e.g. a mesh vertex
+    explicit Vector3(const float *p) { float4::store(d, float4::load3(p)); }
+    explicit Vector3(float4::f4 v) { float4::store(d, v); }
+    float4::f4 simd() const { return float4::load(d); }
+
+    constexpr float x() const { return d[0]; }
+    constexpr float y() const { return d[1]; }
+    constexpr float z() const { return d[2]; }
+
+    constexpr float operator[](int i) const { return d[i]; }
+    const float * data() const { return d; }
 
-    float operator[](int i) const { return d[i]; }
-    
     float length() const
-      { return sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]); }
+      { return sqrt(dot(*this)); }
     void normalize() {
       float temp = length();
       if (temp == 0.0)
         return;	// 0 length vector
       // multiply by 1/magnitude
-      temp = 1 / temp;
-      d[0] *= temp;
-      d[1] *= temp;
-      d[2] *= temp;
+      *this *= 1 / temp;
+    }
+    float dot(const Vector3 &op2) const {
+      return float4::sum3(float4::mul(simd(), op2.simd()));
+    }
+
+    // componentwise smallest and largest of a and b
+    static Vector3 min(const Vector3 &a, const Vector3 &b) {
+      return Vector3(float4::min(a.simd(), b.simd()));
+    }
+    static Vector3 max(const Vector3 &a, const Vector3 &b) {
+      return Vector3(float4::max(a.simd(), b.simd()));
     }
 
     /////////////////////////////////////////////////////////
     // Overloaded operators
     /////////////////////////////////////////////////////////
-  
+
     Vector3 operator+(const Vector3 &op2) const {   // vector addition
-      return Vector3(d[0] + op2.d[0], d[1] + op2.d[1], d[2] + op2.d[2]);
+      return Vector3(float4::add(simd(), op2.simd()));
     }
     Vector3 operator-(const Vector3 &op2) const {   // vector subtraction
-      return Vector3(d[0] - op2.d[0], d[1] - op2.d[1], d[2] - op2.d[2]);
+      return Vector3(float4::sub(simd(), op2.simd()));
     }
     Vector3 operator-() const {                    // unary minus
-      return Vector3(-d[0], -d[1], -d[2]);
+      return Vector3(float4::sub(float4::splat(0), simd()));
     }
     Vector3 operator*(float s) const {            // scalar multiplication
-      return Vector3(d[0] * s, d[1] * s, d[2] * s);
+      return Vector3(float4::mul(simd(), float4::splat(s)));
     }
     void operator*=(float s) {
-      d[0] *= s;
-      d[1] *= s;
-      d[2] *= s;
+      float4::store(d, float4::mul(simd(), float4::splat(s)));
     }
     Vector3 operator/(float s) const {            // scalar division
-      return Vector3(d[0] / s, d[1] / s, d[2] / s);
+      return Vector3(float4::div(simd(), float4::splat(s)));
     }
     float operator*(const Vector3 &op2) const {   // dot product
-      return d[0] * op2.d[0] + d[1] * op2.d[1] + d[2] * op2.d[2];
+      return dot(op2);
     }
-    Vector3 operator^(const Vector3 &op2) const {   // cross product
+    constexpr Vector3 operator^(const Vector3 &op2) const {   // cross product
       return Vector3(d[1] * op2.d[2] - d[2] * op2.d[1], d[2] * op2.d[0] - d[0] * op2.d[2],
                     d[0] * op2.d[1] - d[1] * op2.d[0]);
     }
     bool operator==(const Vector3 &op2) const {
-      return (d[0] == op2.d[0] && d[1] == op2.d[1] && d[2] == op2.d[2]);
+      return float4::equal(simd(), op2.simd()) == 7;
     }
     bool operator!=(const Vector3 &op2) const {
-      return (d[0] != op2.d[0] || d[1] != op2.d[1] || d[2] != op2.d[2]);
+      return float4::equal(simd(), op2.simd()) != 7;
     }
     bool operator<(const Vector3 &op2) const {
-      return (d[0] < op2.d[0] && d[1] < op2.d[1] && d[2] < op2.d[2]);
+      return float4::lessEqual(op2.simd(), simd()) == 0;
     }
     bool operator<=(const Vector3 &op2) const {
-      return (d[0] <= op2.d[0] && d[1] <= op2.d[1] && d[2] <= op2.d[2]);
+      return float4::lessEqual(simd(), op2.simd()) == 7;
+    }
+
+  private:
+    alignas(16) float d[4];
+};
+
+static_assert(sizeof(Vector3) == 16, "Vector3 is one SSE register");
+
+// A view of an array of packed x, y, z floats, e.g. a mesh's vertices
+// (glm::vec3 or ofVec3f), that hands them out as Vector3s.  Nothing is
+// copied; each element is loaded when it's asked for
+//
+class Vector3View {
+  public:
+    Vector3View() = default;
+    Vector3View(const float *p, size_t n) : p(p), n(n) { }
+    template <class V>
+    Vector3View(const std::vector<V> &v) : p(reinterpret_cast<const float *>(v.data())), n(v.size()) {
+      static_assert(sizeof(V) == 3 * sizeof(float), "a Vector3View is over three packed floats");
     }
-  
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    Vector3 operator[](size_t i) const { return Vector3(float4::load3(p + 3 * i)); }
+    const float * point(size_t i) const { return p + 3 * i; }
+
   private:
-    float d[3];
+    const float *p = NULL;
+    size_t n = 0;
 };
 
 #endif // _VECTOR3_H_
@@ -0,0 +1,132 @@
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "Frustum.h"
+#include "SyntheticTerrain.h"
+#include "TerrainChunks.h"
+
+//  Frustum classification and TerrainChunks::cull, with the frustum
+//  built the way the game builds it: projection * view
+//
+
+static Box cube(float x, float y, float z, float half) {
+	return Box(Vector3(x - half, y - half, z - half), Vector3(x + half, y + half, z + half));
+}
+
+// looking down -z from (0, 0, 10), 60 degrees, near 1, far 100
+//
+static Frustum lookingDownZ() {
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 1.0f, 100.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 10), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	return Frustum(projection * view);
+}
+
+TEST(Frustum, ClassifiesBoxesFromPerspectiveLookAt) {
+	Frustum frustum = lookingDownZ();
+
+	EXPECT_EQ(frustum.classify(cube(0, 0, 0, 1)), Frustum::Inside);
+	EXPECT_EQ(frustum.classify(cube(0, 0, -80, 5)), Frustum::Inside);
+
+	EXPECT_EQ(frustum.classify(cube(0, 0, 9, 1)), Frustum::Intersects);		// across the near plane
+	EXPECT_EQ(frustum.classify(cube(0, 0, -90, 5)), Frustum::Intersects);		// across the far plane
+	EXPECT_EQ(frustum.classify(cube(6, 0, 0, 1)), Frustum::Intersects);		// across the right side
+	EXPECT_EQ(frustum.classify(cube(0, 0, 0, 500)), Frustum::Intersects);		// around the whole frustum
+
+	EXPECT_EQ(frustum.classify(cube(0, 0, 20, 1)), Frustum::Outside);			// behind the eye
+	EXPECT_EQ(frustum.classify(cube(0, 0, -200, 5)), Frustum::Outside);		// past the far plane
+	EXPECT_EQ(frustum.classify(cube(50, 0, 0, 1)), Frustum::Outside);
+	EXPECT_EQ(frustum.classify(cube(0, -50, 0, 1)), Frustum::Outside);
+}
+
+TEST(Frustum, NarrowerFieldOfViewCullsMore) {
+	glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 10), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	Frustum wide(glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 100.0f) * view);
+	Frustum narrow(glm::perspective(glm::radians(20.0f), 1.0f, 1.0f, 100.0f) * view);
+	Box box = cube(6, 0, 0, 1);
+	EXPECT_EQ(wide.classify(box), Frustum::Inside);
+	EXPECT_EQ(narrow.classify(box), Frustum::Outside);
+}
+
+//  a 64 x 64 terrain in 4 x 4 chunks
+//
+class TerrainCullTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		SyntheticTerrain terrain;
+		terrain.res = 33;
+		terrain.size = 64;
+		terrain.height = 4;
+		ofMesh mesh;
+		terrain.create(mesh);
+		octree.create(mesh, 5);
+		chunks.create(octree, 2);
+	}
+
+	// chunks the frustum doesn't rule out, one at a time
+	//
+	vector<int> bruteForce(const Frustum & frustum) const {
+		vector<int> visible;
+		for (int i = 0; i < chunks.chunks.size(); i++) {
+			if (chunks.chunks[i].count > 0 && frustum.classify(chunks.chunks[i].bounds) != Frustum::Outside)
+				visible.push_back(i);
+		}
+		return visible;
+	}
+
+	int nonEmptyChunks() const {
+		int n = 0;
+		for (auto & chunk : chunks.chunks)
+			if (chunk.count > 0) n++;
+		return n;
+	}
+
+	static Frustum view(const glm::vec3 & eye, const glm::vec3 & center, float fov, float zFar) {
+		return Frustum(glm::perspective(glm::radians(fov), 1.0f, 0.5f, zFar) *
+			glm::lookAt(eye, center, glm::vec3(0, 0, -1)));
+	}
+
+	Octree octree;
+	TerrainChunks chunks;
+};
+
+TEST_F(TerrainCullTest, WholeTerrainInsideReturnsEveryChunk) {
+	ASSERT_GT(nonEmptyChunks(), 1);
+
+	// high above the middle looking straight down, so the root is inside
+	// and no chunk below it is tested
+	//
+	Frustum frustum = view(glm::vec3(0, 200, 0), glm::vec3(0, 0, 0), 60, 1000);
+	ASSERT_EQ(frustum.classify(chunks.nodes[0].bounds), Frustum::Inside);
+
+	vector<int> visible;
+	int triangles = chunks.cull(frustum, visible);
+	EXPECT_EQ(visible.size(), nonEmptyChunks());
+	EXPECT_EQ(triangles, chunks.numTriangles);
+	EXPECT_EQ(chunks.visibleChunks, nonEmptyChunks());
+}
+
+TEST_F(TerrainCullTest, TerrainBehindTheEyeReturnsNothing) {
+	Frustum frustum = view(glm::vec3(0, 50, 0), glm::vec3(0, 100, 0), 60, 1000);
+	vector<int> visible = { 1, 2, 3 };
+	EXPECT_EQ(chunks.cull(frustum, visible), 0);
+	EXPECT_TRUE(visible.empty());
+	EXPECT_EQ(chunks.visibleChunks, 0);
+
+	// and off the side of the terrain
+	frustum = view(glm::vec3(500, 10, 0), glm::vec3(600, 10, 0), 60, 1000);
+	EXPECT_EQ(chunks.cull(frustum, visible), 0);
+	EXPECT_TRUE(visible.empty());
+}
+
+TEST_F(TerrainCullTest, PartialViewMatchesChunkByChunk) {
+	// low over one corner, looking along the edge
+	Frustum frustum = view(glm::vec3(-30, 10, -30), glm::vec3(-30, 0, 0), 40, 1000);
+	vector<int> visible;
+	chunks.cull(frustum, visible);
+	std::sort(visible.begin(), visible.end());
+
+	vector<int> expected = bruteForce(frustum);
+	EXPECT_EQ(visible, expected);
+	EXPECT_GT(visible.size(), 0u);
+	EXPECT_LT(visible.size(), nonEmptyChunks());
+}
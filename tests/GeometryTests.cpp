@@ -0,0 +1,110 @@
+
+#include <gtest/gtest.h>
+#include <random>
+#include "box.h"
+#include "Before.h"
+
+//  The float4 Vector3, Box and Ray against the scalar classes they
+//  replaced (bench/Before.h)
+//
+
+TEST(Vector3, LanesMatchScalarArithmetic) {
+	Vector3 a(1, -2, 3), b(4, 5, -6);
+	EXPECT_EQ(a + b, Vector3(5, 3, -3));
+	EXPECT_EQ(a - b, Vector3(-3, -7, 9));
+	EXPECT_EQ(a * 2, Vector3(2, -4, 6));
+	EXPECT_EQ(-a, Vector3(-1, 2, -3));
+	EXPECT_FLOAT_EQ(a * b, 4 - 10 - 18);
+	EXPECT_EQ(Vector3::min(a, b), Vector3(1, -2, -6));
+	EXPECT_EQ(Vector3::max(a, b), Vector3(4, 5, 3));
+	EXPECT_TRUE(a <= Vector3(1, -2, 3));
+	EXPECT_FALSE(a < Vector3(1, -1, 4));
+	EXPECT_TRUE(a < Vector3(2, -1, 4));
+}
+
+TEST(Vector3View, ReadsPackedFloatsInPlace) {
+	std::vector<float> packed = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	Vector3View view(packed.data(), 3);
+	ASSERT_EQ(view.size(), 3u);
+	EXPECT_EQ(view[1], Vector3(4, 5, 6));
+	EXPECT_EQ(view[2], Vector3(7, 8, 9));
+	EXPECT_EQ(view.point(2), &packed[6]);
+
+	Box b = Box::bounds(view);
+	EXPECT_EQ(b.min(), Vector3(1, 2, 3));
+	EXPECT_EQ(b.max(), Vector3(7, 8, 9));
+}
+
+TEST(Box, OverlapAndInsideMatchScalar) {
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> u(-10, 10);
+	for (int i = 0; i < 100000; i++) {
+		float c[12];
+		for (int k = 0; k < 12; k++) c[k] = u(rng);
+		Vector3 a(c[0], c[1], c[2]), b(c[3], c[4], c[5]), p(c[6], c[7], c[8]), q(c[9], c[10], c[11]);
+		Box b1(Vector3::min(a, b), Vector3::max(a, b));
+		Box b2(Vector3::min(p, q), Vector3::max(p, q));
+		before::Box o1(before::Vector3(b1.min().x(), b1.min().y(), b1.min().z()), before::Vector3(b1.max().x(), b1.max().y(), b1.max().z()));
+		before::Box o2(before::Vector3(b2.min().x(), b2.min().y(), b2.min().z()), before::Vector3(b2.max().x(), b2.max().y(), b2.max().z()));
+		ASSERT_EQ(b1.overlap(b2), o1.overlap(o2));
+		ASSERT_EQ(b1.inside(p), o1.inside(before::Vector3(c[6], c[7], c[8])));
+		ASSERT_EQ(b1.inside(&c[6]), b1.inside(p));
+	}
+}
+
+TEST(Box, IntersectMatchesScalarOffThePlanes) {
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<float> u(-10, 10);
+	int hits = 0;
+	for (int i = 0; i < 100000; i++) {
+		Vector3 a(u(rng), u(rng), u(rng)), b(u(rng), u(rng), u(rng));
+		Vector3 o(u(rng), u(rng), u(rng)), d(u(rng), u(rng), u(rng));
+		Box box(Vector3::min(a, b), Vector3::max(a, b));
+		before::Box old(before::Vector3(box.min().x(), box.min().y(), box.min().z()),
+			before::Vector3(box.max().x(), box.max().y(), box.max().z()));
+		bool hit = box.intersect(Ray(o, d), 0, 1000);
+		ASSERT_EQ(hit, old.intersect(before::Ray(before::Vector3(o.x(), o.y(), o.z()), before::Vector3(d.x(), d.y(), d.z())), 0, 1000));
+		hits += hit;
+	}
+	EXPECT_GT(hits, 0);
+}
+
+// a ray lying in a face's plane, e.g. straight down through a vertex on
+// an octree boundary, hits the box as a point on the face is inside it
+//
+TEST(Box, GrazingRaysHit) {
+	Box box(Vector3(0, 0, 0), Vector3(1, 1, 1));
+	EXPECT_TRUE(box.intersect(Ray(Vector3(0, 5, .5), Vector3(0, -1, 0)), 0, 1000));
+	EXPECT_TRUE(box.intersect(Ray(Vector3(1, 5, 1), Vector3(0, -1, 0)), 0, 1000));
+	EXPECT_TRUE(box.inside(Vector3(1, 0, 1)));
+	EXPECT_FALSE(box.intersect(Ray(Vector3(1.001f, 5, .5), Vector3(0, -1, 0)), 0, 1000));
+	EXPECT_FALSE(box.intersect(Ray(Vector3(.5, 5, .5), Vector3(0, 1, 0)), 0, 1000));
+}
+
+// octants meet at the center to the bit, so neighbours share their faces
+// exactly.  The far sides are center + half, which can round an ulp off
+// the box's max
+//
+TEST(Box, OctantsTileTheBox) {
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> u(-500, 500);
+	for (int i = 0; i < 1000; i++) {
+		Vector3 a(u(rng), u(rng), u(rng)), b(u(rng), u(rng), u(rng));
+		Box box(Vector3::min(a, b), Vector3::max(a, b));
+		Vector3 c = box.center();
+		for (int o = 0; o < 8; o++) {
+			Box oct = box.octant(o);
+			bool high[3] = { o == 1 || o == 2 || o == 5 || o == 6, o >= 4, (o & 3) >= 2 };
+			for (int k = 0; k < 3; k++) {
+				if (high[k]) {
+					ASSERT_EQ(oct.min()[k], c[k]);
+					ASSERT_NEAR(oct.max()[k], box.max()[k], 1e-4f);
+				}
+				else {
+					ASSERT_EQ(oct.min()[k], box.min()[k]);
+					ASSERT_EQ(oct.max()[k], c[k]);
+				}
+			}
+		}
+	}
+}
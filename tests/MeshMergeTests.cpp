@@ -0,0 +1,133 @@
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "MeshMerge.h"
+
+//  mergeMeshes, the merge MergedModel::build uploads
+//
+
+// a unit triangle in the x/z plane, facing up
+//
+static const float triPositions[] = { 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+static const float triNormals[] = { 0, 1, 0, 0, 1, 0, 0, 1, 0 };
+static const float triTexCoords[] = { 0, 0, 1, 0, 0, 1 };
+static const uint32_t triIndices[] = { 0, 2, 1 };
+
+static MergeMesh triangle(int material, bool indexed = true) {
+	MergeMesh mesh;
+	mesh.positions = triPositions;
+	mesh.normals = triNormals;
+	mesh.texCoords = triTexCoords;
+	mesh.numVertices = 3;
+	if (indexed) {
+		mesh.indices = triIndices;
+		mesh.numIndices = 3;
+	}
+	mesh.material = material;
+	return mesh;
+}
+
+static void translate(MergeMesh & mesh, float x, float y, float z) {
+	mesh.transform[12] = x;
+	mesh.transform[13] = y;
+	mesh.transform[14] = z;
+}
+
+TEST(MeshMerge, IndicesRebasedOntoMergedVertices) {
+	std::vector<MergeMesh> meshes = { triangle(0), triangle(0), triangle(0, false) };
+	MergeResult result;
+	mergeMeshes(meshes, result);
+
+	ASSERT_EQ(result.vertices.size(), 9u);
+	std::vector<uint32_t> expected = { 0, 2, 1, 3, 5, 4, 6, 7, 8 };
+	EXPECT_EQ(result.indices, expected);
+	ASSERT_EQ(result.ranges.size(), 1u);
+	EXPECT_EQ(result.ranges[0].first, 0);
+	EXPECT_EQ(result.ranges[0].count, 9);
+}
+
+// submeshes sharing a key end up in one contiguous range, ranges in key
+// order, whatever order the submeshes came in
+//
+TEST(MeshMerge, SubmeshesGroupedByMaterial) {
+	std::vector<MergeMesh> meshes = { triangle(1), triangle(0), triangle(1) };
+	translate(meshes[0], 10, 0, 0);
+	translate(meshes[1], 20, 0, 0);
+	translate(meshes[2], 30, 0, 0);
+	MergeResult result;
+	mergeMeshes(meshes, result);
+
+	ASSERT_EQ(result.ranges.size(), 2u);
+	EXPECT_EQ(result.ranges[0].material, 0);
+	EXPECT_EQ(result.ranges[0].first, 0);
+	EXPECT_EQ(result.ranges[0].count, 3);
+	EXPECT_EQ(result.ranges[1].material, 1);
+	EXPECT_EQ(result.ranges[1].first, 3);
+	EXPECT_EQ(result.ranges[1].count, 6);
+
+	// each range draws only its own submeshes' vertices
+	//
+	for (const MergeRange & range : result.ranges) {
+		for (int k = range.first; k < range.first + range.count; k++) {
+			float x = result.vertices[result.indices[k]].position[0];
+			if (range.material == 0) EXPECT_TRUE(x >= 20 && x <= 21);
+			else EXPECT_TRUE((x >= 10 && x <= 11) || (x >= 30 && x <= 31));
+		}
+	}
+}
+
+TEST(MeshMerge, TransformsBakedIntoVerticesAndBounds) {
+	// scale x by 2, z by 4, then move by (5, 6, 7)
+	//
+	MergeMesh mesh = triangle(0);
+	mesh.transform[0] = 2;
+	mesh.transform[10] = 4;
+	translate(mesh, 5, 6, 7);
+	MergeMesh other = triangle(0);
+	translate(other, -1, -1, -1);
+	MergeResult result;
+	mergeMeshes({ mesh, other }, result);
+
+	ASSERT_EQ(result.bounds.size(), 2u);
+	EXPECT_EQ(result.bounds[0].min(), Vector3(5, 6, 7));
+	EXPECT_EQ(result.bounds[0].max(), Vector3(7, 6, 11));
+	EXPECT_EQ(result.bounds[1].min(), Vector3(-1, -1, -1));
+	EXPECT_EQ(result.bounds[1].max(), Vector3(0, -1, 0));
+
+	const MergeVertex & v = result.vertices[1];
+	EXPECT_FLOAT_EQ(v.position[0], 7);
+	EXPECT_FLOAT_EQ(v.position[1], 6);
+	EXPECT_FLOAT_EQ(v.position[2], 7);
+	EXPECT_FLOAT_EQ(v.texCoord[0], 1);
+	EXPECT_FLOAT_EQ(v.texCoord[1], 0);
+}
+
+// normals go through the inverse transpose: a shear that tilts the
+// surface has to tilt its normal the other way, and a mirror must not
+// flip it inside out
+//
+TEST(MeshMerge, NormalsUseInverseTranspose) {
+	MergeMesh mesh = triangle(0);
+	mesh.transform[1] = 1;		// x also moves y: the plane y = 0 becomes y = x
+	MergeResult result;
+	mergeMeshes({ mesh }, result);
+	const float *n = result.vertices[0].normal;
+	EXPECT_NEAR(n[0], -sqrtf(.5f), 1e-6);
+	EXPECT_NEAR(n[1], sqrtf(.5f), 1e-6);
+	EXPECT_NEAR(n[2], 0, 1e-6);
+
+	MergeMesh mirrored = triangle(0);
+	mirrored.transform[0] = -1;
+	mergeMeshes({ mirrored }, result);
+	n = result.vertices[0].normal;
+	EXPECT_NEAR(n[0], 0, 1e-6);
+	EXPECT_NEAR(n[1], 1, 1e-6);
+	EXPECT_NEAR(n[2], 0, 1e-6);
+
+	MergeMesh bare = triangle(0);
+	bare.normals = NULL;
+	bare.texCoords = NULL;
+	mergeMeshes({ bare }, result);
+	EXPECT_EQ(result.vertices[2].normal[1], 1);
+	EXPECT_EQ(result.vertices[2].texCoord[1], 0);
+}
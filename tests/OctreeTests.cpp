@@ -0,0 +1,150 @@
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include "Octree.h"
+#include "SyntheticTerrain.h"
+
+//  Octree queries on the tree of TreeNodes against the same tree
+//  compacted.  The terrain gets duplicate vertices, as imported models
+//  have along seams, so some leaves at the deepest level hold more than
+//  one point
+//
+
+class OctreeCompactTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		SyntheticTerrain terrain;
+		terrain.res = 33;
+		terrain.size = 64;
+		terrain.height = 6;
+		ofMesh mesh;
+		terrain.create(mesh);
+		int n = mesh.getNumVertices();
+		for (int i = 0; i < n; i += 7)
+			mesh.addVertex(mesh.getVertex(i));
+
+		tree.createMorton(mesh, 8);
+		compact.createMorton(mesh, 8);
+		compact.compact();
+	}
+
+	float distanceTo(const Octree & octree, int i, const Vector3 & p) const {
+		return (octree.vertices()[i] - p).length();
+	}
+
+	Vector3 randomPoint(std::mt19937 & rng) const {
+		std::uniform_real_distribution<float> xz(-40, 40), y(-5, 15);
+		return Vector3(xz(rng), y(rng), xz(rng));
+	}
+
+	Octree tree;
+	Octree compact;
+};
+
+TEST_F(OctreeCompactTest, LeavesKeepTheirDuplicates) {
+	ASSERT_TRUE(compact.isCompact());
+	EXPECT_EQ(compact.leafPoints.size(), compact.mesh.getNumVertices());
+	int shared = 0;
+	for (auto & node : compact.nodes)
+		if (node.numPoints > 1) shared++;
+	EXPECT_GT(shared, 0);
+}
+
+TEST_F(OctreeCompactTest, NearestMatchesTree) {
+	std::mt19937 rng(1);
+	vector<int> a, b;
+	for (int q = 0; q < 500; q++) {
+		Vector3 p = randomPoint(rng);
+
+		int na = tree.nearest(p), nb = compact.nearest(p);
+		ASSERT_GE(na, 0);
+		ASSERT_GE(nb, 0);
+		EXPECT_EQ(distanceTo(tree, na, p), distanceTo(compact, nb, p));
+
+		// duplicates are equally near, so compare distances, in order
+		ASSERT_EQ(tree.nearest(p, 8, a, 20), compact.nearest(p, 8, b, 20));
+		for (int i = 0; i < a.size(); i++)
+			EXPECT_EQ(distanceTo(tree, a[i], p), distanceTo(compact, b[i], p));
+	}
+}
+
+TEST_F(OctreeCompactTest, PointsInRadiusMatchesTree) {
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<float> r(0.5, 12);
+	vector<int> a, b;
+	for (int q = 0; q < 500; q++) {
+		Vector3 p = randomPoint(rng);
+		float radius = r(rng);
+		tree.pointsInRadius(p, radius, a);
+		compact.pointsInRadius(p, radius, b);
+		std::sort(a.begin(), a.end());
+		std::sort(b.begin(), b.end());
+		EXPECT_EQ(a, b);
+	}
+}
+
+TEST_F(OctreeCompactTest, PointsInBoxMatchesTree) {
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> half(0.5, 12);
+	vector<int> a, b;
+	for (int q = 0; q < 500; q++) {
+		Vector3 c = randomPoint(rng);
+		Vector3 h(half(rng), half(rng), half(rng));
+		Box box(c - h, c + h);
+		tree.pointsInBox(box, a);
+		compact.pointsInBox(box, b);
+		std::sort(a.begin(), a.end());
+		std::sort(b.begin(), b.end());
+		EXPECT_EQ(a, b);
+	}
+}
+
+TEST_F(OctreeCompactTest, BoxIntersectMatchesTree) {
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> half(0.5, 4);
+	vector<Box> a, b;
+	for (int q = 0; q < 500; q++) {
+		Vector3 c = randomPoint(rng);
+		Vector3 h(half(rng), half(rng), half(rng));
+		Box box(c - h, c + h);
+		a.clear();
+		b.clear();
+		ASSERT_EQ(tree.intersect(box, a), compact.intersect(box, b));
+		ASSERT_EQ(a.size(), b.size());
+		for (int i = 0; i < a.size(); i++) {
+			EXPECT_EQ(a[i].min(), b[i].min());
+			EXPECT_EQ(a[i].max(), b[i].max());
+		}
+	}
+}
+
+TEST_F(OctreeCompactTest, ConcurrentQueriesMatchSerial) {
+	std::mt19937 rng(5);
+	vector<Vector3> queries;
+	for (int q = 0; q < 2000; q++) queries.push_back(randomPoint(rng));
+
+	const Octree & octree = compact;
+	auto run = [&](vector<int> & nearRtn, vector<int> & countRtn) {
+		vector<int> points;
+		for (int q = 0; q < queries.size(); q++) {
+			octree.nearest(queries[q], 4, points, 20);
+			nearRtn.insert(nearRtn.end(), points.begin(), points.end());
+			countRtn.push_back(octree.pointsInRadius(queries[q], 3, points));
+		}
+	};
+	vector<int> near, counts;
+	run(near, counts);
+
+	const int numThreads = 4;
+	vector<int> threadNear[numThreads], threadCounts[numThreads];
+	vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++)
+		threads.emplace_back(run, std::ref(threadNear[t]), std::ref(threadCounts[t]));
+	for (auto & t : threads) t.join();
+	for (int t = 0; t < numThreads; t++) {
+		EXPECT_EQ(threadNear[t], near);
+		EXPECT_EQ(threadCounts[t], counts);
+	}
+}
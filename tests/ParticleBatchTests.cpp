@@ -0,0 +1,54 @@
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "ParticleBatch.h"
+
+//  The batch ParticleVertexStream::pack uploads, filled from stand-ins
+//  for Particle, glm::vec3 and ofFloatColor
+//
+
+struct TestVec { float x, y, z; TestVec() { } TestVec(float x, float y, float z) : x(x), y(y), z(z) { } };
+struct TestColor { float r, g, b, a; };
+struct TestParticle {
+	TestVec position;
+	TestColor color;
+	float birthtime;	// ms
+	float lifespan;		// sec
+};
+
+TEST(ParticleBatch, FadeRampsAndClamps) {
+	EXPECT_FLOAT_EQ(particleFade(0, 2), 1);
+	EXPECT_FLOAT_EQ(particleFade(1, 2), (1 + 10 / 255.0f) / 2);
+	EXPECT_FLOAT_EQ(particleFade(2, 2), 10 / 255.0f);
+	EXPECT_FLOAT_EQ(particleFade(5, 2), 10 / 255.0f);
+	EXPECT_FLOAT_EQ(particleFade(-1, 2), 1);
+	EXPECT_FLOAT_EQ(particleFade(100, -1), 1);
+}
+
+TEST(ParticleBatch, PositionsCopiedAndOnlyAlphaFades) {
+	std::vector<TestParticle> particles = {
+		{ TestVec(1, 2, 3), { 1, .5f, .25f, 1 }, 2000, 2 },		// half way through its life
+		{ TestVec(-4, 5, -6), { .2f, .4f, .6f, .8f }, 3000, 2 },	// just born
+		{ TestVec(7, 8, 9), { 1, 1, 1, 1 }, 0, -1 },			// lives forever
+	};
+	std::vector<TestVec> positions(particles.size());
+	std::vector<TestColor> colors(particles.size());
+	fillParticleBatch(particles.data(), (int)particles.size(), 3000, positions.data(), colors.data());
+
+	for (int i = 0; i < particles.size(); i++) {
+		const TestParticle & p = particles[i];
+		EXPECT_EQ(positions[i].x, p.position.x);
+		EXPECT_EQ(positions[i].y, p.position.y);
+		EXPECT_EQ(positions[i].z, p.position.z);
+
+		// blending scales by alpha, so the color itself has to be untouched
+		// for the fade to come out linear
+		//
+		EXPECT_EQ(colors[i].r, p.color.r);
+		EXPECT_EQ(colors[i].g, p.color.g);
+		EXPECT_EQ(colors[i].b, p.color.b);
+	}
+	EXPECT_FLOAT_EQ(colors[0].a, particleFade(1, 2));
+	EXPECT_FLOAT_EQ(colors[1].a, .8f);
+	EXPECT_FLOAT_EQ(colors[2].a, 1);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "ParticleEmitter.h"
+#include "HeightField.h"
+
+//  Particle emitters and systems, on the headless clock
+//
+
+static void setupBurst(ParticleEmitter & emitter, SpawnBudget & budget) {
+	emitter.setEmitterType(RadialEmitter);
+	emitter.setGroupSize(250);
+	emitter.setOneShot(true);
+	emitter.setVelocity(ofVec3f(0, 10, 0));
+	emitter.spawnBudget = &budget;
+}
+
+TEST(SpawnBudget, SharedAcrossEmittersPerFrame) {
+	ofSetTimeModeFixedRate(1000000000 / 60);
+	SpawnBudget budget;
+	budget.maxPerFrame = 300;
+	ParticleEmitter a, b;
+	setupBurst(a, budget);
+	setupBurst(b, budget);
+
+	a.start();
+	b.start();
+	a.update();
+	b.update();
+	EXPECT_EQ(a.sys->particles.size() + b.sys->particles.size(), 300u);
+	EXPECT_EQ(a.sys->particles.size(), 250u);
+
+	// the next frame has a new budget
+	ofHeadlessNextFrame();
+	b.start();
+	b.update();
+	EXPECT_EQ(b.sys->particles.size(), 50u + 250u);
+	ofSetTimeModeSystem();
+}
+
+//  a 16 x 16 grid of quads, 1 apart, with height(x, z) at each vertex
+//
+template<typename F>
+static void makeGround(Octree & octree, HeightField & field, F height) {
+	ofMesh mesh;
+	for (int k = 0; k <= 16; k++)
+		for (int i = 0; i <= 16; i++)
+			mesh.addVertex(glm::vec3(i - 8, height(i - 8, k - 8), k - 8));
+	for (int k = 0; k < 16; k++) {
+		for (int i = 0; i < 16; i++) {
+			int v = k * 17 + i;
+			mesh.addTriangle(v, v + 17, v + 1);
+			mesh.addTriangle(v + 1, v + 17, v + 18);
+		}
+	}
+	octree.create(mesh, 6);
+	field.create(octree, 8);
+}
+
+static Particle falling(const ofVec3f & from, const ofVec3f & to) {
+	Particle p;
+	p.lastPosition = from;
+	p.position = to;
+	p.velocity = (to - from) * 60;
+	return p;
+}
+
+TEST(ParticleTerrain, NoBounceAboveTheGroundUnderTheBlend) {
+	// one spike; the blended cell heights around it stand well above
+	// the real slopes
+	Octree octree;
+	HeightField field;
+	makeGround(octree, field, [](int x, int z) { return (x == 0 && z == 0) ? 8.0f : 0.0f; });
+
+	float x = 0, z = 0, ground = 0, blend = 0;
+	ofVec3f n;
+	bool found = false;
+	for (float tz = -3; tz <= 3 && !found; tz += 0.125) {
+		for (float tx = -3; tx <= 3 && !found; tx += 0.125) {
+			if (!field.getGround(tx, tz, ground, n)) continue;
+			blend = field.getHeight(tx, tz);
+			if (blend - ground > 1) {
+				x = tx;
+				z = tz;
+				found = true;
+			}
+		}
+	}
+	ASSERT_TRUE(found);
+
+	ParticleSystem sys;
+	sys.terrain = &field;
+	float y = (ground + blend) / 2;		// under the blend, over the ground
+	sys.particles.push_back(falling(ofVec3f(x, y + 0.1, z), ofVec3f(x, y, z)));
+	sys.collideTerrain();
+	EXPECT_EQ(sys.numCollisions, 0);
+	EXPECT_FLOAT_EQ(sys.particles[0].position.y, y);
+}
+
+TEST(ParticleTerrain, BouncesOffTheTriangleNormal) {
+	Octree octree;
+	HeightField field;
+	makeGround(octree, field, [](int x, int z) { return x * 0.5f; });
+
+	ParticleSystem sys;
+	sys.terrain = &field;
+	sys.restitution = 1;
+	sys.particles.push_back(falling(ofVec3f(1.3, 0.75, 0.4), ofVec3f(1.3, 0.55, 0.4)));
+	sys.collideTerrain();
+	ASSERT_EQ(sys.numCollisions, 1);
+	const Particle & p = sys.particles[0];
+	EXPECT_NEAR(p.position.y, 0.65, 1e-4);
+
+	// straight down off a 0.5 slope: the tangent part is kept, the
+	// normal part turned around
+	ofVec3f norm = ofVec3f(-0.5, 1, 0).getNormalized();
+	ofVec3f v = ofVec3f(0, -12, 0);
+	ofVec3f expected = v - norm * (2 * v.dot(norm));
+	EXPECT_NEAR(p.velocity.x, expected.x, 1e-3);
+	EXPECT_NEAR(p.velocity.y, expected.y, 1e-3);
+	EXPECT_NEAR(p.velocity.z, expected.z, 1e-3);
+}
+
+TEST(ParticleSystem, ExpiredParticlesRemovedInOrder) {
+	ofSetTimeModeFixedRate(1000000000 / 60);
+	ParticleSystem sys;
+	for (int i = 0; i < 100; i++) {
+		Particle p;
+		p.birthtime = ofGetElapsedTimeMillis();
+		p.lifespan = (i % 3 == 0) ? 0.01 : (i % 3 == 1) ? 100 : -1;
+		p.mass = i;		// tags the particle
+		sys.add(p);
+	}
+	for (int f = 0; f < 3; f++) ofHeadlessNextFrame();
+	sys.update();
+
+	ASSERT_EQ(sys.particles.size(), 66u);
+	int n = 0;
+	for (int i = 0; i < 100; i++)
+		if (i % 3 != 0) EXPECT_EQ(sys.particles[n++].mass, i);
+	ofSetTimeModeSystem();
+}